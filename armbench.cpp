@@ -0,0 +1,132 @@
+#include "armbench.h"
+#include "armcontroller.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+typedef struct {
+	double target;
+	double loc;
+	double last_out;
+	double timestep;
+} Sample;
+
+const double BENCH_TIMESTEP = 0.050;
+const int BENCH_STEPS_PER_TARGET = 40;
+const int BENCH_REPEATS = 5;
+
+/**
+ * Record a trajectory of the intake arm, driven by a ModelController,
+ * through a series of position targets. The plant is a crude model:
+ * output plus a position-dependent external force, with friction,
+ * and a little sensor noise.
+ */
+static void record(std::vector<Sample>& samples) {
+	const double targets[] = { 0.2, 0.8, 0.5, 0.95, 0.1, 0.6 };
+	const int num_targets = sizeof(targets) / sizeof(targets[0]);
+
+	ModelController ctr;
+	ctr.reset(0.5);
+
+	double x = 0.5;
+	double v = 0.0;
+	double out = 0.0;
+	unsigned int noise = 1511;
+	for (int t = 0; t < num_targets; t++) {
+		for (int i = 0; i < BENCH_STEPS_PER_TARGET; i++) {
+			noise = noise * 1103515245 + 12345;
+			double loc = x + ((int) ((noise >> 16) % 1000) - 500) * 0.000004;
+
+			Sample s = { targets[t], loc, out, BENCH_TIMESTEP };
+			samples.push_back(s);
+			out = ctr.step(s.target, s.loc, s.last_out, s.timestep);
+
+			double force = out + 0.12 - 0.2 * x;
+			if (fabs(v) > 0.01 || fabs(force) > 0.2) {
+				force -= (v > 0) ? 0.1 : -0.1;
+				v += force * BENCH_TIMESTEP;
+			} else {
+				v = 0.0;
+			}
+			x += v * BENCH_TIMESTEP;
+			if (x > 1.0 || x < 0.0) {
+				x = (x > 1.0) ? 1.0 : 0.0;
+				v = 0.0;
+			}
+		}
+	}
+}
+
+typedef struct {
+	const char* name;
+	int evals;
+	double seconds;
+	double max_gap;
+	double sum_gap;
+} Tally;
+
+/**
+ * Tally how much worse (or better) a search's optimum
+ * was than the grid search's.
+ */
+static void addGap(Tally* tally, double gap) {
+	tally->sum_gap += gap;
+	if (fabs(gap) > fabs(tally->max_gap)) {
+		tally->max_gap = gap;
+	}
+}
+
+void armbench() {
+	std::vector<Sample> samples;
+	record(samples);
+
+	ModelController ctr;
+	ctr.reset(samples[0].loc);
+
+	const int kSearches = 3;
+	Tally tally[kSearches] = { { "grid", 0, 0.0, 0.0, 0.0 }, { "brent", 0, 0.0,
+			0.0, 0.0 }, { "ternary", 0, 0.0, 0.0, 0.0 } };
+	ModelController::Search searches[kSearches] = {
+			ModelController::kGridSearch, ModelController::kBrentSearch,
+			ModelController::kTernarySearch };
+	ModelController::Cost costs[2] = { ModelController::kForceCost,
+			ModelController::kOutputCost };
+
+	for (size_t i = 0; i < samples.size(); i++) {
+		const Sample& s = samples[i];
+		ctr.step(s.target, s.loc, s.last_out, s.timestep);
+
+		// step() leaves behind the state both of its searches saw
+		for (int c = 0; c < 2; c++) {
+			double grid_cost;
+			ctr.setSearch(ModelController::kGridSearch);
+			ctr.seekAgain(costs[c], &grid_cost);
+
+			for (int k = 0; k < kSearches; k++) {
+				ctr.setSearch(searches[k]);
+				// the fastest of a few runs, to leave out preemption
+				double fastest = 1.0;
+				double cost = 0.0;
+				for (int r = 0; r < BENCH_REPEATS; r++) {
+					double start = Timer::GetPPCTimestamp();
+					ctr.seekAgain(costs[c], &cost);
+					double elapsed = Timer::GetPPCTimestamp() - start;
+					fastest = (elapsed < fastest) ? elapsed : fastest;
+				}
+				tally[k].seconds += fastest;
+				tally[k].evals += ctr.getEvaluations();
+				addGap(&tally[k], cost - grid_cost);
+			}
+		}
+		ctr.setSearch(ModelController::kBrentSearch);
+	}
+
+	int n = samples.size();
+	printf("ModelController search, %d recorded steps\n", n);
+	for (int k = 0; k < kSearches; k++) {
+		printf("  %-8s %5.1f evaluations, %7.1f us per calc;"
+			" cost - grid cost: mean %g, worst %g\n", tally[k].name,
+				(double) tally[k].evals / n, tally[k].seconds * 1e6 / n,
+				tally[k].sum_gap / (2 * n), tally[k].max_gap);
+	}
+}
@@ -0,0 +1,14 @@
+#ifndef ARMBENCH_H_
+#define ARMBENCH_H_
+
+/**
+ * Compare ModelController's searches: the batched grid + Brent
+ * search, Brent alone, and the old 18-generation ternary search,
+ * on a recorded arm trajectory. At every step all of them run on
+ * the same controller state; printf's the cost evaluations and time
+ * per calc(), and how far apart the optimal costs are (callable from
+ * the vxWorks shell).
+ */
+extern "C" void armbench();
+
+#endif
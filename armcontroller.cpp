@@ -46,15 +46,25 @@ DoubleConstant MEH_SPEED_ZONE(0.03, "INTAKE_BOOST_ZONE_MEH");
 DoubleConstant BOOST(2.0, "INTAKE_BOOST_INC");
 DoubleConstant PVALUE(2.0, "INTAKE_BOOST_P");
 DoubleConstant IVALUE(0.2, "INTAKE_BOOST_I");
+// at the lift's 200 Hz, the 50 ms the zones were tuned at; the mean
+// of the per-step speeds is the difference across the window
+const int BUMP_SPEED_SAMPLES = 10;
+
+BumpController::BumpController() :
+	speed(BUMP_SPEED_SAMPLES) {
+	boost = 0.0;
+	stalled = false;
+}
 
 void BumpController::reset(double loc) {
 	diff.reset(loc);
+	speed.reset(0.0);
 	boost = 0.0;
 	stalled = false;
 	integ.reset(0);
 }
 double BumpController::calc(double target, double loc, double) {
-	double spd = diff.calc(loc);
+	double spd = speed.calc(diff.calc(loc));
 	if (fabs(spd) < UNHAPPY_SPEED_ZONE) {
 		stalled = true;
 		boost += BOOST * diff.lastTimeStep();
@@ -134,11 +144,10 @@ double NaiveController::calc(double target, double loc, double) {
 }
 
 const int F_SMOOTH_SAMPLES = 1;
-const int CONVEX_SEEK_GENERATIONS = 18;
-const int MONITOR_HISTORY_LENGTH = 5;
 const int CONTROL_LOOKAHEAD_LENGTH = 3;
 const int OUTPUT_SMOOTH_SAMPLES = 1;
 DoubleConstant PREDICTION_STEP(0.050, "INTAKE_AC_TIMESTEP");
+ProfileScope MODEL_CALC_SCOPE("ModelController::calc");
 DoubleConstant OUT_SCALE(1.0, "INTAKE_AC_OUT_SCALE");
 DoubleConstant STALL_SPEED(0.01, "INTAKE_AC_STALL_SPD");
 DoubleConstant FRIC_STATIC(0.2, "INTAKE_AC_FRIC_STATIC");
@@ -146,36 +155,31 @@ DoubleConstant FRIC_DYNAMIC(0.1, "INTAKE_AC_FRIC_DYNAMIC");
 DoubleConstant K_PROP(2.5, "INTAKE_AC_PROPK");
 DoubleConstant START_F(0.0, "INTAKE_AC_F_START");
 
-double seek_convex(ModelController* inst, double min, double max,
-		double(*thunk)(ModelController*, double)) {
+// about the final bracket of the old 18-generation ternary search
+const double SEEK_TOLERANCE = 0.001;
+
+double ModelController::seek(BatchCostFunction cost) {
 	//
-	// Current cost: 36 calls, eqv. step 0.0012
-	// the best way to speed up the controller is to optimize this
+	// Brent alone takes the fewest evaluations (see armbench);
+	// the grid + Brent search finds slightly better optima,
+	// but costs more on a PowerPC without a vector unit
 	//
-	double score_max = (*thunk)(inst, max);
-	double score_min = (*thunk)(inst, min);
-	for (int gen = 0; gen < CONVEX_SEEK_GENERATIONS; gen++) {
-		double low = (min * 2 + max) * 0.333333333333333333333333;
-		double high = (max * 2 + min) * 0.333333333333333333333333;
-		double score_high = (*thunk)(inst, high);
-		double score_low = (*thunk)(inst, low);
-
-		if (score_high >= score_low) {
-			max = high;
-			score_max = score_high;
-		}
-		if (score_low >= score_high) {
-			min = low;
-			score_min = score_low;
-		}
+	ScalarCost scalar = { cost, this };
+	switch (search) {
+	case kGridSearch:
+		return minimizeGrid(cost, this, -1.0, 1.0, SEEK_TOLERANCE, &evals);
+	case kTernarySearch:
+		return minimizeTernary(scoreOne, &scalar, -1.0, 1.0, 18, &evals);
+	default:
+		return minimize(scoreOne, &scalar, -1.0, 1.0, SEEK_TOLERANCE, &evals);
 	}
-	return (max + min) * 0.5;
 }
 
 ModelController::ModelController() :
-	filtF(F_SMOOTH_SAMPLES), hist_v(MONITOR_HISTORY_LENGTH),
-			hist_x(MONITOR_HISTORY_LENGTH), hist_out(MONITOR_HISTORY_LENGTH),
-			output_smooth(OUTPUT_SMOOTH_SAMPLES) {
+	filtF(F_SMOOTH_SAMPLES), output_smooth(OUTPUT_SMOOTH_SAMPLES) {
+	hist.size = 0;
+	search = kBrentSearch;
+	evals = 0;
 	timer.Start();
 	timer.Reset();
 }
@@ -187,100 +191,157 @@ void ModelController::reset(double loc) {
 	current = s;
 
 	filtF.reset(START_F);
-	hist_v.clear();
-	hist_x.clear();
-	hist_out.clear();
+	hist.size = 0;
 	output_smooth.reset(0);
 }
 
 void ModelController::log_hist(double output) {
-	hist_v.next(current.v);
-	hist_x.next(current.x);
-	hist_out.next(output);
+	if (hist.size == kHistoryLength) {
+		for (int i = 1; i < kHistoryLength; i++) {
+			hist.x[i - 1] = hist.x[i];
+			hist.v[i - 1] = hist.v[i];
+			hist.out[i - 1] = hist.out[i];
+		}
+		hist.size--;
+	}
+	hist.x[hist.size] = current.x;
+	hist.v[hist.size] = current.v;
+	hist.out[hist.size] = output;
+	hist.size++;
 }
 
 double ModelController::calc(double target, double loc, double last_out) {
-	log_hist(last_out);
-
+	Profiler prof(MODEL_CALC_SCOPE);
 	double timestep = timer.Get();
 	timer.Reset();
+
+	double output = step(target, loc, last_out, timestep);
+	printf("x %f v %f ==> out %f; force %f\n", current.x, current.v, output,
+			estF);
+	static int gg = Telemetry::channel("GG", "x,v,output,force");
+	Telemetry::send(gg, current.x, current.v, output, estF);
+
+	return output;
+}
+
+double ModelController::step(double target, double loc, double last_out,
+		double timestep) {
+	log_hist(last_out);
+
 	target_x = target;
 	State s = { loc, (loc - current.x) / timestep };
 	current = s;
 
-	double newF = seek_convex(this, -1.0, 1.0, eval_F);
+	model.out_scale = OUT_SCALE;
+	model.stall_speed = STALL_SPEED;
+	model.fric_static = FRIC_STATIC;
+	model.fric_dynamic = FRIC_DYNAMIC;
+	model.step = PREDICTION_STEP;
+
+	evals = 0;
+	double newF = seek(eval_F);
 	estF = filtF.calc(newF);
 
-	double eout = seek_convex(this, -1.0, 1.0, eval_pow);
-	double output = output_smooth.calc(eout);
-	printf("x %f v %f ==> out %f; force %f\n", current.x, current.v, output,
-			estF);
-	UDPLog::log("GG:%f,%f,%f,%f\n", current.x, current.v, output, estF);
+	double eout = seek(eval_pow);
+	return output_smooth.calc(eout);
+}
 
-	return output;
+int ModelController::getEvaluations() {
+	return evals;
 }
 
-double ModelController::eval_F(ModelController* ctr, double F) {
-	State state = { ctr->hist_x[0], ctr->hist_v[0] };
-	double cost = 0.0;
-	int len = ctr->hist_x.size();
-	for (int i = 0; i < len - 1; i++) {
-		double out = ctr->hist_out[i];
-		state = predict(state, out, F);
-		double err = (state.x - ctr->hist_x[i + 1]);
-		cost += err * err;
+void ModelController::setSearch(Search s) {
+	search = s;
+}
+
+double ModelController::seekAgain(Cost cost, double* optimum_cost) {
+	BatchCostFunction f = (cost == kForceCost) ? eval_F : eval_pow;
+	evals = 0;
+	double x = seek(f);
+	f(this, &x, optimum_cost, 1);
+	return x;
+}
+
+void ModelController::eval_F(void* arg, const double* F, double* cost,
+		int n) {
+	ModelController* ctr = (ModelController*) arg;
+	const History& h = ctr->hist;
+	const Model& m = ctr->model;
+	double x[kMinimizeBatch];
+	double v[kMinimizeBatch];
+	double force[kMinimizeBatch];
+	for (int j = 0; j < n; j++) {
+		x[j] = h.x[0];
+		v[j] = h.v[0];
+		cost[j] = 0.0;
+	}
+	// replay the history, ending at the current position
+	for (int i = 0; i < h.size; i++) {
+		double actual = (i < h.size - 1) ? h.x[i + 1] : ctr->current.x;
+		for (int j = 0; j < n; j++) {
+			force[j] = (h.out[i] + F[j]) * m.out_scale;
+		}
+		predict(m, x, v, force, n);
+		for (int j = 0; j < n; j++) {
+			double err = x[j] - actual;
+			cost[j] += err * err;
+		}
 	}
-	state = predict(state, ctr->hist_out[len - 1], F);
-	double err = (state.x - ctr->current.x);
-	cost += err * err;
-	return cost;
 }
 
-double ModelController::eval_pow(ModelController* ctr, double pow) {
-	double cost = 0;
-	State state = ctr->current;
+void ModelController::eval_pow(void* arg, const double* pow, double* cost,
+		int n) {
+	ModelController* ctr = (ModelController*) arg;
+	const Model& m = ctr->model;
+	double x[kMinimizeBatch];
+	double v[kMinimizeBatch];
+	double force[kMinimizeBatch];
+	for (int j = 0; j < n; j++) {
+		x[j] = ctr->current.x;
+		v[j] = ctr->current.v;
+		force[j] = (pow[j] + ctr->estF) * m.out_scale;
+		cost[j] = 0.0;
+	}
 	for (int i = 0; i < CONTROL_LOOKAHEAD_LENGTH; i++) {
-		state = predict(state, pow, ctr->estF);
-		double err = ctr->target_speed(state.x) - state.v;
-		cost += err * err;
+		predict(m, x, v, force, n);
+		for (int j = 0; j < n; j++) {
+			double err = ctr->target_speed(x[j]) - v[j];
+			cost[j] += err * err;
+		}
 	}
-	return cost;
 }
 
 double ModelController::target_speed(double loc) {
 	return (target_x - loc) * K_PROP;
 }
 
-inline bool within(double x, double radius) {
-	return (x > -radius) && (x < radius);
-}
-
-ModelController::State ModelController::predict(State state, double output,
-		double F) {
-	double force = (output + F) * OUT_SCALE;
-	if (within(state.v, STALL_SPEED) && within(force, FRIC_STATIC)) {
-		State res = { state.x, 0 };
-		return res;
-	}
-
-	double fdyn = state.v > 0 ? FRIC_DYNAMIC : -FRIC_DYNAMIC;
-	double acc = force - fdyn;
-
-	// note: it might improve results to match the prediction step
-	// size to the historical timestep for the measurement phase
-	double v = state.v + acc * PREDICTION_STEP;
-	double x = state.x + v * PREDICTION_STEP;
-
-	if (x > 1.0) {
-		State res = { 1.0, 0.0 };
-		return res;
-	} else if (x < 0.0) {
-		State res = { 0.0, 0.0 };
-		return res;
+/**
+ * Advance each of the `n` states one prediction step. Written
+ * with selects rather than branches, so the loop vectorizes.
+ */
+void ModelController::predict(const Model& m, double* x, double* v,
+		const double* force, int n) {
+	const double stall_speed = m.stall_speed;
+	const double fric_static = m.fric_static;
+	const double fric_dynamic = m.fric_dynamic;
+	const double step = m.step;
+	for (int j = 0; j < n; j++) {
+		double f = force[j];
+		double x0 = x[j];
+		double v0 = v[j];
+		bool stuck = (fabs(v0) < stall_speed) & (fabs(f) < fric_static);
+
+		double fdyn = v0 > 0 ? fric_dynamic : -fric_dynamic;
+		double nv = v0 + (f - fdyn) * step;
+		double nx = x0 + nv * step;
+
+		// stops at either end of travel
+		bool stopped = stuck | (nx > 1.0) | (nx < 0.0);
+		nx = nx > 1.0 ? 1.0 : nx;
+		nx = nx < 0.0 ? 0.0 : nx;
+		x[j] = stuck ? x0 : nx;
+		v[j] = stopped ? 0.0 : nv;
 	}
-
-	State res = { x, v };
-	return res;
 }
 
 DoubleConstant LIMC_RADIUS(0.025, "INTAKE_LIMC_BACKRAD");
@@ -6,10 +6,13 @@
 
 class BumpController {
 public:
+	BumpController();
 	double calc(double target, double loc,double);
 	void reset(double loc);
 private:
 	TimeDifferentiator diff;
+	// the speed over the last 50 ms, as the stall zones were tuned
+	MovingAverageFilter speed;
 	TimeIntegrator integ;
 	double boost;
 	bool stalled;
@@ -42,35 +45,94 @@ private:
  * Offline model based testing implies that the control phase is much more
  * effective than the measurement phase due to noise/scale.
  * 
+ * The costs score a batch of candidates at once (kMinimizeBatch for
+ * the grid search, one at a time for Brent's method, the default):
+ * the model is rolled out for the whole batch in lockstep, over a
+ * history kept as parallel arrays, so the inner loops are
+ * straight-line and vectorizable.
  */
 class ModelController {
 public:
 	ModelController();
 	double calc(double target, double loc, double last_out);
+	/**
+	 * calc() with the time since the last call given, rather
+	 * than timed; used to replay recorded trajectories.
+	 */
+	double step(double target, double loc, double last_out, double timestep);
 	void reset(double loc);
+
+	/**
+	 * Which minimizer the searches use; armbench compares them.
+	 */
+	typedef enum {
+		kGridSearch, kBrentSearch, kTernarySearch
+	} Search;
+	typedef enum {
+		kForceCost, kOutputCost
+	} Cost;
+	void setSearch(Search s);
+	/**
+	 * Search `cost` again over the state the last step() left,
+	 * without changing it; returns the optimum, and its cost in
+	 * `optimum_cost`. getEvaluations() then counts this search.
+	 */
+	double seekAgain(Cost cost, double* optimum_cost);
+
+	/**
+	 * Cost evaluations made by the last calc().
+	 */
+	int getEvaluations();
 private:
+	static const int kHistoryLength = 5;
+
 	typedef struct {
 		double x;
 		double v;
 	} State;
 
+	/**
+	 * The last kHistoryLength states and outputs, oldest first.
+	 */
+	typedef struct {
+		double x[kHistoryLength];
+		double v[kHistoryLength];
+		double out[kHistoryLength];
+		int size;
+	} History;
+
+	/**
+	 * The DoubleConstants of the model, read once per step.
+	 */
+	typedef struct {
+		double out_scale;
+		double stall_speed;
+		double fric_static;
+		double fric_dynamic;
+		double step;
+	} Model;
+
 	void log_hist(double output);
 	double target_speed(double x);
 
-	static double eval_F(ModelController*, double F);
-	static double eval_pow(ModelController*, double spd);
-	static State predict(State s, double out, double F);
+	double seek(BatchCostFunction cost);
+	static void eval_F(void* ctr, const double* F, double* cost, int n);
+	static void eval_pow(void* ctr, const double* pow, double* cost, int n);
+	static void predict(const Model& m, double* x, double* v,
+			const double* force, int n);
 
 	Timer timer;
 	MovingAverageFilter filtF;
-	RingBuffer<double> hist_v;
-	RingBuffer<double> hist_x;
-	RingBuffer<double> hist_out;
+	History hist;
+	Model model;
 	MovingAverageFilter output_smooth;
 	double estF;
 
 	double target_x;
 	State current;
+
+	Search search;
+	int evals;
 };
 
 class LimitController {
@@ -29,8 +29,9 @@ DoubleConstant SHORT_KICK_WAIT(0.5, "AUTO_WAIT_PRE_SHORT");
 DoubleConstant VISION_START(1.0, "AUTO_VISION_START");
 
 Auto::Auto(Drive &d, Intake &i, Kicker &k, Lights &l) :
-	choice(kNone), autoNone(d, i, k, l), autoDouble(d, i, k, l),
-			autoSingle(d, i, k, l), autoTest(d, i, k, l) {
+	choice(kNone), prepared(kNone), autoNone(d, i, k, l),
+			autoDouble(d, i, k, l), autoSingle(d, i, k, l),
+			autoTest(d, i, k, l) {
 }
 Auto::~Auto() {
 }
@@ -54,10 +55,20 @@ void Auto::initialize(AutoRoutine x) {
 	printf("AUTO choice %d\n", x);
 
 	AutoBase &au = getAuto();
+	if (prepared != x) {
+		au.prepare();
+		prepared = x;
+	}
 	au.setup();
 	au.init();
 }
 
+void Auto::prepare(AutoRoutine x) {
+	choice = x;
+	getAuto().prepare();
+	prepared = x;
+}
+
 void Auto::process() {
 	getAuto().process();
 }
@@ -69,8 +80,12 @@ AutoBase::AutoBase(Drive &d, Intake &i, Kicker &k, Lights &l) :
 }
 AutoBase::~AutoBase() {
 }
+void AutoBase::prepare() {
+}
 void AutoBase::setup() {
 	match_timer.Reset();
+	// poses in autonomous are from the starting position
+	drive.resetPose();
 }
 int AutoBase::getState() {
 	return state;
@@ -112,6 +127,10 @@ AutoNearSingleBall::AutoNearSingleBall(Drive &d, Intake &i, Kicker &k,
 		Lights &l) :
 	AutoBase(d, i, k, l) {
 }
+void AutoNearSingleBall::prepare() {
+	Path::Leg legs[] = { { AUTO1_DISTANCE, 0.0 } };
+	drive.planPath(&path, legs, 1, AUTO1_DRIVE_MAX);
+}
 void AutoNearSingleBall::init() {
 	vision_yet = false;
 	nextState(sInit);
@@ -127,7 +146,7 @@ void AutoNearSingleBall::process() {
 	case sInit:
 		printf("AUTO: init\n");
 		intake.goToLocation(Intake::kLocAutoKick);
-		drive.autonDrive(AUTO1_DISTANCE, AUTO1_DRIVE_MAX);//move forward 2 feet
+		drive.followPath(&path, AUTO1_DRIVE_MAX);
 		lights.setCameraLight(true);
 		nextState(sWaitForIntakeUp);
 		break;
@@ -188,6 +207,11 @@ AutoDoubleBall::AutoDoubleBall(Drive &d, Intake &i, Kicker &k, Lights &l) :
 	AutoBase(d, i, k, l) {
 
 }
+void AutoDoubleBall::prepare() {
+	Path::Leg legs[] = { { AUTO2_DRIVE_DISTANCE, 0.0 },
+			{ -AUTO2_DRIVE_BACK, 0.0 }, { AUTO2_FORWARD_AGAIN, 0.0 } };
+	drive.planPath(&path, legs, 3, AUTO2_DRIVE_MAX);
+}
 void AutoDoubleBall::init() {
 	nextState(sInit);
 }
@@ -196,18 +220,13 @@ void AutoDoubleBall::process() {
 	switch (getState()) {
 	case sInit:
 		intake.goToLocation(Intake::kLocAutoKick);
-		drive.autonDrive(AUTO2_DRIVE_DISTANCE, AUTO2_DRIVE_MAX);//move forward 2 feet
-		nextState(sRaiseIntake);
+		drive.followPath(&path, AUTO2_DRIVE_MAX);
+		// no backing up until the first ball is gone
+		drive.holdPathAt(path.getLegEnd(0));
+		nextState(sDriveKick1);
 		break;
-	case sRaiseIntake:
-		printf("AUTO: wait for raise\n");
-		if (intake.isRaised()) {
-			nextState(sDriveForward1);
-		}
-		break;
-	case sDriveForward1:
-		printf("AUTO: wait for drive\n");
-		if (drive.autoDone()) {
+	case sDriveKick1:
+		if (intake.isRaised() && drive.isPathHeld()) {
 			nextState(sPausePreKick1);
 		}
 		break;
@@ -220,43 +239,41 @@ void AutoDoubleBall::process() {
 	case sKick1:
 		if (!kicker.nowKicking()) {
 			intake.goToLocation(Intake::kLocFeed);
-			drive.autonDrive(-AUTO2_DRIVE_BACK, AUTO2_DRIVE_MAX);
 			intake.spin(Intake::kSpinIn);
 			nextState(sWaitDriveIntake);
 		}
 		break;
 	case sWaitDriveIntake:
+		// no backing up onto the ball until the intake is down
 		if (intake.isLowered()) {
-			nextState(sWaitDriveBack);
+			drive.holdPathAt(path.getLegEnd(1));
+			nextState(sDriveBack);
 		}
 		break;
-	case sWaitDriveBack:
-		if (drive.autoDone()) {
+	case sDriveBack:
+		if (drive.isPathHeld()) {
 			nextState(sWaitForPossession);
 		}
 		break;
 	case sWaitForPossession:
 		if (getStateTime() > AUTO2_HOLD_MIN_TIME) {
-			nextState(sRaiseBall);
 			intake.goToLocation(Intake::kLocAutoKick);
+			drive.holdPathAt(path.getLength());
+			nextState(sDriveKick2);
 		}
 		break;
-	case sRaiseBall:
+	case sDriveKick2:
 		if (intake.isRaised()) {
 			intake.spin(Intake::kSpinNot);
-			drive.autonDrive(AUTO2_FORWARD_AGAIN, AUTO2_DRIVE_MAX);
-			nextState(sDriveForward2);
-		}
-		break;
-	case sDriveForward2:
-		if (drive.autoDone()) {
-			nextState(sPausePreKick2);
+			if (drive.isPathHeld()) {
+				nextState(sPausePreKick2);
+			}
 		}
 		break;
 	case sPausePreKick2:
 		if (getStateTime() > AUTO2_WAIT_PRE_KICK) {
-			nextState(sKick2);
 			kicker.startKick(AUTO2_KICKING_POWER);
+			nextState(sKick2);
 		}
 		break;
 	case sKick2:
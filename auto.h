@@ -40,6 +40,11 @@ public:
 	 */
 	virtual void init() = 0;
 	virtual void process() = 0;
+	/**
+	 * Override to precompute what the routine needs (drive paths);
+	 * called while disabled, so init() has nothing heavy left to do.
+	 */
+	virtual void prepare();
 protected:
 	/**
 	 * Get the state machine state
@@ -94,8 +99,10 @@ public:
 	AutoNearSingleBall(Drive &d, Intake &i, Kicker &k, Lights &l);
 	virtual void init();
 	virtual void process();
+	virtual void prepare();
 private:
 	bool vision_yet;
+	Path path;
 	enum {
 		sInit,
 		sWaitForIntakeUp,
@@ -114,6 +121,9 @@ private:
  * it kicks the ball into the high goal (to get enough range).
  * It backs up, pulls in a second ball, and then kicks again.
  * 
+ * The drive is one path, held where the robot has to wait for the
+ * kicker or the intake, rather than a stop after every leg.
+ * 
  * Has not been well tested.
  */
 class AutoDoubleBall: public AutoBase {
@@ -121,18 +131,18 @@ public:
 	AutoDoubleBall(Drive &d, Intake &i, Kicker &k, Lights &l);
 	virtual void init();
 	virtual void process();
+	virtual void prepare();
 private:
+	Path path;
 	enum {
 		sInit,
-		sRaiseIntake,
-		sDriveForward1,
+		sDriveKick1,
 		sPausePreKick1,
 		sKick1,
 		sWaitDriveIntake,
-		sWaitDriveBack,
+		sDriveBack,
 		sWaitForPossession,
-		sRaiseBall,
-		sDriveForward2,
+		sDriveKick2,
 		sPausePreKick2,
 		sKick2,
 		sEndAuto
@@ -181,12 +191,18 @@ public:
 	 * The chosen auto routine is set.
 	 */
 	void initialize(AutoRoutine a);
+	/**
+	 * Precompute for the routine that will probably be chosen;
+	 * call while disabled.
+	 */
+	void prepare(AutoRoutine a);
 	/**
 	 * Update state every cycle.
 	 */
 	void process();
 private:
 	AutoRoutine choice;
+	AutoRoutine prepared;
 	AutoBase& getAuto();
 
 	AutoNone autoNone;
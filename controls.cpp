@@ -121,6 +121,9 @@ void Controls::process(bool enabled) {
 		processDriveSticks();
 		processAuxSide();
 	}
+}
+
+void Controls::processDisplay() {
 	processDebug();
 	processSmartDashboard();
 }
@@ -31,6 +31,12 @@ public:
 	 * read and act on the previous items AND joystick input,
 	 */
 	void process(bool enabled);
+	/**
+	 * Update the driver station LCD (selected by the debug
+	 * buttons) and the SmartDashboard. Needs a far lower
+	 * rate than process().
+	 */
+	void processDisplay();
 
 	/**
 	 * Return the selected autonomous mode,
@@ -4,117 +4,197 @@
 //CONSTANTS
 #define IN_PER_TICK (0.0342727272727273)
 
-DoubleConstant DIST_LEADING_LIFT(0.2, "DRIVE_TRAP_LIFT");
-DoubleConstant DIST_FALL_SLOPE(0.04, "DRIVE_FALL_SLOPE");
-DoubleConstant DIST_RISE_SLOPE(0.08, "DRIVE_RISE_SLOPE");
+// the move profile, and how power follows it
+DoubleConstant DRIVE_FULL_SPEED(150.0, "DRIVE_FULL_SPEED"); // in/s at full power
+DoubleConstant DRIVE_PROFILE_ACCEL(120.0, "DRIVE_PROFILE_ACCEL"); // in/s/s
+DoubleConstant DRIVE_PROFILE_JERK(1200.0, "DRIVE_PROFILE_JERK"); // in/s/s/s
+DoubleConstant DRIVE_PROFILE_KP(0.02, "DRIVE_PROFILE_KP"); // power per inch behind
+DoubleConstant DRIVE_PROFILE_KA(0.0013, "DRIVE_PROFILE_KA"); // power per in/s/s
+DoubleConstant DRIVE_PROFILE_KS(0.05, "DRIVE_PROFILE_KS"); // power while moving
+DoubleConstant DRIVE_SETTLE_TIME(1.0, "DRIVE_SETTLE_TIME"); // s past the profile
 
-DoubleConstant AUTO_CLOSE_ENOUGH(1.0, "DRIVE_CLOSE_ENOUGH");
-
-double getTrapezoidalTarget(double loc, double target, double maxp) {
-	//
-	// To graph the profile:
-	//
-	// XXXXXXXXXX  /=>=>=>=>=>=>=>=\     /=<=<=<=<=<=<=<=<=<
-	// XXXXXXXXXX /                 \   /
-	// XXXXXXXXXX.                   \ /
-	// XXXXXXXXXX|                    .
-	//
-	//         start                target
-	//
-	//      ---------------- position --------------->
-
-	double sign = (target - loc) > 0 ? 1.0 : -1.0;
-
-	double near = fabs(loc);
-	double far = fabs(loc - target);
-	if (near < ((maxp - DIST_LEADING_LIFT) / DIST_RISE_SLOPE)) {
-		return DIST_LEADING_LIFT + near * sign * DIST_RISE_SLOPE;
-	}
-
-	if (far < ((maxp - DIST_LEADING_LIFT) / DIST_FALL_SLOPE)) {
-		return DIST_LEADING_LIFT + far * sign * DIST_FALL_SLOPE;
-	}
+// following paths (with the profile's acceleration and KS)
+DoubleConstant DRIVE_TRACK_WIDTH(24.0, "DRIVE_TRACK_WIDTH"); // inches
+DoubleConstant DRIVE_PATH_LOOKAHEAD(4.0, "DRIVE_PATH_LOOKAHEAD"); // inches
+DoubleConstant DRIVE_PATH_CROSSTRACK(2.0, "DRIVE_PATH_CROSSTRACK"); // deg/inch off
+DoubleConstant DRIVE_PATH_KV(0.005, "DRIVE_PATH_KV"); // power per in/s slow
 
-	return maxp * sign;
-}
+DoubleConstant AUTO_CLOSE_ENOUGH(1.0, "DRIVE_CLOSE_ENOUGH");
 
-Drive::Drive() :
-	gyro(ANALOG_GYRO), mode(kNothing),
+Drive::Drive(const RobotState& s) :
+	sensors(s), gyro(ANALOG_GYRO), mode(kNothing),
 			leftMotors(CANID_DRIVE_LEFT_FRONT, CANID_DRIVE_LEFT_REAR, true),
 			rightMotors(CANID_DRIVE_RIGHT_FRONT, CANID_DRIVE_RIGHT_REAR, true),
 			leftEncoder(DIG_DRIVE_ENCODER_LEFT_B),
-			rightEncoder(DIG_DRIVE_ENCODER_RIGHT_A) {
+			rightEncoder(DIG_DRIVE_ENCODER_RIGHT_A),
+			odometry(leftEncoder, rightEncoder, gyro, IN_PER_TICK) {
 	// sample averaging (over a quarter rotation, est. good)
 	leftEncoder.SetSamplesToAverage(63);
 	rightEncoder.SetSamplesToAverage(63);
 
 	leftEncoder.Start();
 	rightEncoder.Start();
-	lastUpdate.Start();
+	InputLog::addCounter(DIG_DRIVE_ENCODER_LEFT_B, &leftEncoder);
+	InputLog::addCounter(DIG_DRIVE_ENCODER_RIGHT_A, &rightEncoder);
+
+	// read every cycle by debug()
+	leftMotors.PollStatus(1 << SafeCANJag::kStatusCurrent);
+	rightMotors.PollStatus(1 << SafeCANJag::kStatusCurrent);
 
 	initialize();
 }
 
 void Drive::initialize() {
-	//Set up encoders.
-	leftEncoder.Reset();
-	rightEncoder.Reset();
 	//Stop the motors.
 	tankDrive(0, 0);
 	// Set variables that need to start off with a set value to appropriate placeholders.
-	lastLeftDist = leftEncoder.Get();
-	lastRightDist = rightEncoder.Get();
+	startDistance = sensors.pose.distance;
+	startHeading = sensors.pose.heading;
 	maxPower = 0.0;
+	path = NULL;
+	pathHeld = false;
 	mode = kNothing;
 }
 
-void Drive::gyroController(double sign, double d_left, double d_right,
-		double v_left, double v_right, double t_step) {
-	double d_avg = (d_left + d_right) / 2;
-	double target_pow = getTrapezoidalTarget(d_avg, moveTarget, maxPower);
+void Drive::sample(RobotState* next) {
+	odometry.GetPoseAt(next->time, &next->pose);
+}
+
+void Drive::gyroController(double sign, double progress, double velocity,
+		double heading) {
+	// where the move should be by now
+	MotionProfile::Point p;
+	double t = sensors.time - profileStart;
+	profile.sample(t, &p);
 
-	double delta = (moveTarget - d_avg) * sign;
+	static int ch = Telemetry::channel("AutoDrive",
+			"progress,position,velocity,heading");
+	Telemetry::send(ch, progress, p.position, velocity, heading);
+
+	double delta = fabs(moveTarget) - progress;
 	if (delta < AUTO_CLOSE_ENOUGH) {
 		mode = kNothing;
 		tankDrive(0.0, 0.0);
+	} else if (t > profile.getDuration() + DRIVE_SETTLE_TIME) {
+		// stuck short of the target; let autonomous go on
+		printf("Drive: move stopped %3.2f in short\n", delta);
+		mode = kNothing;
+		tankDrive(0.0, 0.0);
 	} else {
-		// pPow is forward-motion power. Now gyro correct
-		// negative delta means robot pointed left-of target
-		double delta = gyro.GetAngle();
-		delta *= 0.05; // %pow/deg err
-		// Swap delta direction -- negative in driveAndTurn means turn left
-		delta *= -1.0f;
+		// pPow is forward-motion power: feed forward the profile,
+		// and feed back how far behind it the robot is; KS until
+		// it arrives, or the last inches would not overcome friction
+		double target_pow = p.velocity / DRIVE_FULL_SPEED + DRIVE_PROFILE_KA
+				* p.acceleration + DRIVE_PROFILE_KP * (p.position - progress)
+				+ DRIVE_PROFILE_KS;
+		// Now gyro correct
+		// positive heading means robot pointed left-of target
+		double correct = heading * 0.05 * sign; // %pow/deg err
 
 		// Add/subtract turn value
-		double left = target_pow - delta;
-		double right = target_pow + delta;
-
-		left = bound(left, 0.25 * sign, maxPower * sign);
-		right = bound(right, 0.25 * sign, maxPower * sign);
+		double left = bound(target_pow + correct, 0.0, maxPower) * sign;
+		double right = bound(target_pow - correct, 0.0, maxPower) * sign;
 
 		tankDrive(left, right);
 	}
-	printf("L %3.6f R %3.6f l %3.6f r %3.6f G %3.6f\n", d_left, d_right,
-			v_left, v_right, gyro.GetAngle());
 }
 
-void Drive::process() {
-	double sign = (moveTarget < 0) ? -1.0 : 1.0;
+void Drive::pathController() {
+	const Odometry::Pose& pose = sensors.pose;
+	// the distance travelled the way the path goes; coasting past
+	// where it turns back does not count
+	Path::Point p, ahead;
+	path->sample(pathProgress, &p);
+	pathProgress += (pose.distance - pathLastDistance) * p.direction;
+	pathLastDistance = pose.distance;
+
+	double end = path->getLength();
+	if (pathLimit < end) {
+		end = pathLimit;
+	}
+	if (end - pathProgress < AUTO_CLOSE_ENOUGH) {
+		pathHeld = true;
+		if (end >= path->getLength()) {
+			mode = kNothing;
+		}
+		tankDrive(0.0, 0.0);
+		return;
+	}
+	if (sensors.time - pathStart > pathTime + DRIVE_SETTLE_TIME) {
+		// stuck short of where it is held; let autonomous go on
+		printf("Drive: path stopped %3.2f in short\n", end - pathProgress);
+		pathHeld = true;
+		mode = kNothing;
+		tankDrive(0.0, 0.0);
+		return;
+	}
+	pathHeld = false;
+	// a change of direction is as good as reached, too
+	double reversal = path->getNextReversal(pathProgress);
+	if (reversal - pathProgress < AUTO_CLOSE_ENOUGH) {
+		pathProgress = reversal;
+	}
 
-	//Determine total distance traveled.
-	double leftDist = leftEncoder.Get() * IN_PER_TICK * sign;
-	double rightDist = rightEncoder.Get() * IN_PER_TICK * sign;
+	// how fast it may go here; a little ahead too, to get moving
+	// from a stop, unless it has to reverse first
+	path->sample(pathProgress, &p);
+	path->sample(pathProgress + DRIVE_PATH_LOOKAHEAD, &ahead);
+	double speed = p.speed;
+	double accel = p.acceleration;
+	if (ahead.direction == p.direction && ahead.speed > speed) {
+		speed = ahead.speed;
+		accel = ahead.acceleration;
+	}
+	// and stop where it is held
+	double stop = sqrt(2 * DRIVE_PROFILE_ACCEL * (end - pathProgress));
+	if (stop < speed) {
+		speed = stop;
+		accel = -DRIVE_PROFILE_ACCEL;
+	}
 
-	double timestep = lastUpdate.Get();
-	lastUpdate.Reset();
+	// the pose in the path's frame
+	double h0 = pathOrigin.heading * M_PI / 180.0;
+	double dx = pose.x - pathOrigin.x;
+	double dy = pose.y - pathOrigin.y;
+	double x = dx * cos(h0) + dy * sin(h0);
+	double y = dy * cos(h0) - dx * sin(h0);
+	double h = p.heading * M_PI / 180.0;
+	// inches left of the path, facing along it
+	double off = (y - p.y) * cos(h) - (x - p.x) * sin(h);
+	// positive error means robot pointed left of where it should;
+	// steering back onto the path is the other way in reverse
+	double error = pose.heading - pathOrigin.heading - p.heading + off
+			* DRIVE_PATH_CROSSTRACK * p.direction;
+	double correct = error * 0.05; // %pow/deg err
 
-	double leftRate = (leftDist - lastLeftDist) / timestep;
-	double rightRate = (rightDist - lastRightDist) / timestep;
-	lastLeftDist = leftDist;
-	lastRightDist = rightDist;
+	double forward = speed / DRIVE_FULL_SPEED + DRIVE_PROFILE_KA * accel
+			+ DRIVE_PATH_KV * (speed - pose.velocity * p.direction)
+			+ DRIVE_PROFILE_KS;
+	// the curve, at that speed
+	double turn = p.curvature * M_PI / 180.0 * DRIVE_TRACK_WIDTH / 2
+			* forward;
+	double left = p.direction * forward - turn + correct;
+	double right = p.direction * forward + turn - correct;
+	tankDrive(bound(left, -maxPower, maxPower),
+			bound(right, -maxPower, maxPower));
+
+	static int ch = Telemetry::channel("Path",
+			"progress,speed,velocity,error");
+	Telemetry::send(ch, pathProgress, speed, pose.velocity, error);
+}
+
+void Drive::process() {
+	double sign = (moveTarget < 0) ? -1.0 : 1.0;
+
+	//Determine progress along the move and heading change since it began.
+	const Odometry::Pose& pose = sensors.pose;
+	double progress = (pose.distance - startDistance) * sign;
+	double heading = pose.heading - startHeading;
 
 	if (mode == kAutoDrive) {
-		gyroController(sign, leftDist, rightDist, leftRate, rightRate, timestep);
+		gyroController(sign, progress, pose.velocity * sign, heading);
+	} else if (mode == kFollowPath) {
+		pathController();
 	}
 }
 
@@ -128,8 +208,8 @@ inline double jagCurrent(SafeCANJag* jag) {
 void Drive::debug() {
 	LCDWriter l;
 	l.line1("Gyro %2.4f", gyro.GetAngle());
-	l.line2("LDist: %d", leftEncoder.Get());
-	l.line3("RDist: %d", rightEncoder.Get());
+	l.line2("X %6.1f Y %6.1f", sensors.pose.x, sensors.pose.y);
+	l.line3("H %6.1f V %6.1f", sensors.pose.heading, sensors.pose.velocity);
 	double time = GetTime();
 	l.line4("LCurr %05.2f %05.2f",
 			jagCurrent(leftMotors.GetByID(CANID_DRIVE_LEFT_FRONT)),
@@ -142,37 +222,90 @@ void Drive::debug() {
 
 void Drive::tankDrive(double left_power_percentage,
 		double right_power_percentage) {
-	leftMotors.Set(left_power_percentage);
-	rightMotors.Set(-right_power_percentage);
+	leftMotors.Stage(left_power_percentage);
+	rightMotors.Stage(-right_power_percentage);
+	odometry.SetDirection(left_power_percentage, right_power_percentage);
 }
 
 void Drive::autonDrive(double distance_inches, double max_power_percentage) {
 	//Set the move target that process checks against and the max speed for this drive segment.
 	moveTarget = distance_inches;
-	leftEncoder.Reset();
-	rightEncoder.Reset();
-	;
-	lastLeftDist = 0.0;
-	lastRightDist = 0.0;
-	lastUpdate.Reset();
-	gyro.Reset();
+	startDistance = sensors.pose.distance;
+	startHeading = sensors.pose.heading;
 
 	maxPower = max_power_percentage;
 
-	if (moveTarget == 0) {
+	if (moveTarget == 0 || maxPower <= 0) {
 		mode = kNothing;
 		tankDrive(0.0, 0.0);
 		return;
 	}
 
+	// planned once; each cycle looks up where the move should be
+	profile.plan(MotionProfile::kSCurve, fabs(moveTarget),
+			maxPower * DRIVE_FULL_SPEED, DRIVE_PROFILE_ACCEL, DRIVE_PROFILE_JERK);
+	profileStart = sensors.time;
+
 	mode = kAutoDrive;
 }
 
+void Drive::planPath(Path* p, const Path::Leg* legs, int count,
+		double max_power_percentage) {
+	p->build(legs, count, max_power_percentage * DRIVE_FULL_SPEED,
+			DRIVE_PROFILE_ACCEL);
+}
+
+void Drive::followPath(const Path* p, double max_power_percentage) {
+	path = p;
+	maxPower = max_power_percentage;
+	pathOrigin = sensors.pose;
+	pathLastDistance = sensors.pose.distance;
+	pathProgress = 0.0;
+	pathLimit = p->getLength();
+	pathHeld = false;
+	pathStart = sensors.time;
+	pathTime = p->getTime(0.0, pathLimit);
+
+	if (p->getLength() == 0) {
+		mode = kNothing;
+		tankDrive(0.0, 0.0);
+		return;
+	}
+	mode = kFollowPath;
+}
+
+void Drive::holdPathAt(double distance) {
+	pathLimit = distance;
+	// a path given up on stays given up, and held
+	if (mode != kFollowPath) {
+		return;
+	}
+	pathHeld = false;
+	pathStart = sensors.time;
+	pathTime = path->getTime(pathProgress, distance);
+}
+
+bool Drive::isPathHeld() {
+	return pathHeld;
+}
+
+double Drive::getPathProgress() {
+	return pathProgress;
+}
+
 bool Drive::autoDone() {
 	//Determine whether or not the robot is moving.
 	return (mode == kNothing);
 }
 
+void Drive::resetPose() {
+	odometry.Reset();
+}
+
+const Odometry::Pose& Drive::getPose() {
+	return sensors.pose;
+}
+
 void Drive::finalizeGyro() {
 	gyro.FinishMeasurement();
 }
@@ -3,6 +3,7 @@
 
 #include <math.h>
 #include "util.h"
+#include "robotstate.h"
 #include "Counter.h"
 #include "Timer.h"
 #include "Gyro.h"
@@ -12,11 +13,15 @@
  */
 class Drive {
 public:
-	Drive();
+	Drive(const RobotState& s);
 	/**
 	 * Reset state at start of a mode.
 	 */
 	void initialize();
+	/**
+	 * Read the sensors into the next cycle's state.
+	 */
+	void sample(RobotState* next);
 	/**
 	 * Needs to run after the autonomous drive function. 
 	 * Run every cycle. Automaticaly straightens itself
@@ -28,7 +33,8 @@ public:
 	 */
 	void debug();
 	/**
-	 * Apply left and right power to drivetrain. 
+	 * Apply left and right power to drivetrain, at the end of
+	 * the loop (MultiMotor::CommitAll()).
 	 * Used for movement throughout the class.
 	 */
 	void tankDrive(double left_power_percentage, double right_power_percentage);
@@ -37,37 +43,94 @@ public:
 	 * straight line for a specified distance. Distance
 	 * can be any number of inches (positive or negative).
 	 * Negative makes the robot move backwards. Max power
-	 * goes from zero to positive one.
+	 * goes from zero to positive one, and sets the profile's
+	 * top speed.
 	 */
 	void autonDrive(double distance_inches, double max_power_percentage);
+	/**
+	 * Tabulate a path for followPath, with the drive's speed
+	 * and acceleration limits, and max power as for autonDrive.
+	 * Not for every cycle: plan while disabled.
+	 */
+	void planPath(Path* path, const Path::Leg* legs, int count,
+			double max_power_percentage);
+	/**
+	 * Sets up for process. Tells robot to follow a planned path,
+	 * from where it is now, without stopping between legs unless
+	 * they change direction. The path must outlive the drive.
+	 */
+	void followPath(const Path* path, double max_power_percentage);
+	/**
+	 * Go no farther than `distance` inches along the path, slowing
+	 * to stop there, until called again. followPath() allows the
+	 * whole path. A robot that does not get there in the planned
+	 * time, and DRIVE_SETTLE_TIME, stops following the path.
+	 */
+	void holdPathAt(double distance);
+	/**
+	 * Whether the robot is stopped where holdPathAt() holds it,
+	 * or has stopped following the path.
+	 */
+	bool isPathHeld();
+	/**
+	 * Inches travelled along the path so far.
+	 */
+	double getPathProgress();
 	/*
 	 * Checks to see if the robot is moving. If the robot
 	 * is not moving, this function returns true.
 	 */
 	bool autoDone();
 
+	/**
+	 * Make where the robot is now the origin of its pose
+	 * (at the start of autonomous).
+	 */
+	void resetPose();
+	/**
+	 * The robot's pose as of the start of the cycle.
+	 */
+	const Odometry::Pose& getPose();
+
 	void finalizeGyro();
 	void measureGyro();
 	double getRawGyro();
 private:
 	typedef enum {
-		kAutoDrive, kAutoTurn, kNothing
+		kAutoDrive, kAutoTurn, kFollowPath, kNothing
 	} AutoMode;
+	const RobotState& sensors;
 	RollingGyro gyro;
 	AutoMode mode;
 	MultiMotor leftMotors;
 	MultiMotor rightMotors;
 	Counter leftEncoder;
 	Counter rightEncoder;
+	Odometry odometry;
 
-	void gyroController(double,double,double,double,double,double);
+	void gyroController(double sign, double progress, double velocity,
+			double heading);
+	void pathController();
 
 	double maxPower;// range 0 to 1, max abs output for motors in autonomous
 	double moveTarget;// signed value indicating the target location to go to (inches)
 
-	Timer lastUpdate;
-	double lastLeftDist;// inches
-	double lastRightDist;// inches
+	// the pose when autonDrive() started the move
+	double startDistance;// inches
+	double startHeading;// degrees
+	MotionProfile profile;
+	double profileStart;// seconds
+
+	// the path followPath() is following, and how far along it is
+	const Path* path;
+	Odometry::Pose pathOrigin;// the pose the path starts at
+	double pathLastDistance;// inches, the pose's distance last cycle
+	double pathProgress;// inches
+	double pathLimit;// inches
+	bool pathHeld;
+	// when it set off for pathLimit, and how long the plan takes
+	double pathStart;// seconds
+	double pathTime;// seconds
 };
 
 #endif
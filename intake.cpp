@@ -24,6 +24,12 @@ DoubleConstant SPIN_IN_POWER(1.0, "INTAKE_SPIN_POWER_IN");
 DoubleConstant SPIN_OUT_POWER(1.0, "INTAKE_SPIN_POWER_OUT");
 DoubleConstant SPIN_OUT_SLOW_POWER(0.69, "INTAKE_SPIN_POWER_OUT_SLOW");
 
+ProfileScope INTAKE_PROCESS_SCOPE("Intake::process");
+ProfileScope INTAKE_CONTROL_SCOPE("Intake::control");
+
+// above the main robot task, so the lift keeps its rate
+const int32_t LIFT_PRIORITY = 100;
+
 DoubleConstant PFIELD_DOWN_SPLIT(0.25, "INTAKE_PF_DOWN_SPLIT");
 DoubleConstant PFIELD_DOWN_NEAR(1.0, "INTAKE_PF_DOWN_NEAR");
 DoubleConstant PFIELD_DOWN_FAR(1.0, "INTAKE_PF_DOWN_FAR");
@@ -34,8 +40,18 @@ DoubleConstant PFIELD_UP_FAR(0.75, "INTAKE_PF_UP_FAR");
 
 DoubleConstant POS_OVER(0.03, "INTAKE_POS_OVER");
 
+// position control follows a trapezoid to the target, rather than
+// chasing a step; in positions (0.0 to 1.0) per second, per second
+DoubleConstant LIFT_PROFILE_SPEED(2.0, "INTAKE_PROFILE_SPEED");
+DoubleConstant LIFT_PROFILE_ACCEL(8.0, "INTAKE_PROFILE_ACCEL");
+
+// Hz, and Hz per volt/second: at rest about as smooth as the old
+// 10 sample average, but with a few ms of lag once the arm moves
+DoubleConstant POT_FILTER_MIN_CUTOFF(3.0, "INTAKE_POT_FILTER_CUTOFF");
+DoubleConstant POT_FILTER_BETA(20.0, "INTAKE_POT_FILTER_BETA");
+
 IntakePot::IntakePot(uint8_t chan, Intake &i) :
-	filter(10), noti(IntakePot::callUpdate, this), pot(chan), intake(i) {
+	filter(POT_FILTER_MIN_CUTOFF, POT_FILTER_BETA, kPeriod), noti(IntakePot::callUpdate, this), pot(chan), intake(i) {
 	// configure potentiometer oversampling/avg bit counts.
 	// each averages 2 ** n values, but averaging rounds
 	// off the partial amounts, while oversampling
@@ -73,6 +89,7 @@ void IntakePot::update() {
 	bool wt;
 	{
 		Synchronized sync(semaphore);
+		filter.setCutoff(POT_FILTER_MIN_CUTOFF, POT_FILTER_BETA);
 		filter.calc(pot.GetVoltage());
 		wt = watching;
 	}
@@ -81,8 +98,8 @@ void IntakePot::update() {
 		double loc = getLocation();
 		double pw = intake.getLastLiftOutput();
 		double tg = intake.getTargetPos();
-		double time = GetTime();
-		UDPLog::log("LPT:%f,%f,%f,%f\n", loc, pw, time, tg);
+		static int lpt = Telemetry::channel("LPT", "loc,power,target");
+		Telemetry::send(lpt, loc, pw, tg);
 	}
 }
 
@@ -93,41 +110,91 @@ double IntakePot::getVoltage() {
 	double v;
 	{
 		Synchronized sync(semaphore);
-		v = filter.recalc();
+		v = filter.get();
 	}
 	return v;
 }
 
-Intake::Intake() :
-	motor_roller(CANID_INTAKE_ROLLER, true),
+Intake::Intake(const RobotState& s) :
+	sensors(s), motor_roller(CANID_INTAKE_ROLLER, true),
 			motor_lift(CANID_INTAKE_LIFT, true),
 			pot(ANALOG_INTAKE_POT_1, *this),
 			altpot(ANALOG_INTAKE_ALT_POT, *this),
 			beam_break(DIG_INTAKE_BALL_SENSOR) {
 
+	// read every cycle by debug()
+	motor_roller.PollStatus(1 << SafeCANJag::kStatusCurrent);
+	motor_lift.PollStatus(1 << SafeCANJag::kStatusCurrent);
+
+	command.use_alt = false;
+	command.potbroke = false;
+	command.resets = 0;
+	last_output = 0.0;
+	custom_spin_speed = 0.0;
+	lift_resets = 0;
+	profiled = false;
 	initialize();
-	use_alt = false;
+	lift_handoff.read(&lift);
+
+	ControlExecutor::GetInstance()->Add("IntakeLift", kLiftPeriod,
+			Intake::callControl, this, LIFT_PRIORITY);
 }
 
 void Intake::initialize() {
-	target_power = 0.0;
-	moveToPosition(getLocation());
+	command.target_power = 0.0;
+	command.target_pos = KICK_POSITION;
 	direction = kSpinNot;
-	mode = kPower;
-	pos_controller.reset(getLocation());
-	alt_controller.reset(getLocation());
-	target_pos = KICK_POSITION;
+	command.mode = kPower;
+	command.resets++;
+	sendCommand();
 }
 
-void Intake::process() {
-	switch (mode) {
+void Intake::sample(RobotState* next) {
+	next->intake_location = pot.getLocation();
+	next->ball_present = beam_break.Get();
+}
+
+void Intake::sendCommand() {
+	lift_handoff.write(command);
+}
+
+void Intake::callControl(void* intake) {
+	((Intake*) intake)->control();
+}
+
+void Intake::control() {
+	Profiler prof(INTAKE_CONTROL_SCOPE);
+	lift_handoff.read(&lift);
+	if (lift.resets != lift_resets) {
+		lift_resets = lift.resets;
+		pos_controller.reset(pot.getLocation());
+		alt_controller.reset(pot.getLocation());
+		profiled = false;
+	}
+
+	const double target_pos = lift.target_pos;
+	const double target_power = lift.target_power;
+	switch (lift.mode) {
 	case kPosition:
-		if (potbroke) {
+		if (lift.potbroke) {
 			setLiftDirect(0.0);
 		} else {
-			double loc = getLocation();
-			double pow = pos_controller.calc(target_pos, loc, last_output);
-			if (use_alt) {
+			double loc = pot.getLocation();
+			double now = GetTime();
+			if (!profiled || target_pos != profile_to) {
+				// a new move, from wherever the arm is
+				profile.plan(MotionProfile::kTrapezoidal, target_pos - loc,
+						LIFT_PROFILE_SPEED, LIFT_PROFILE_ACCEL);
+				profile_from = loc;
+				profile_to = target_pos;
+				profile_start = now;
+				profiled = true;
+			}
+			MotionProfile::Point p;
+			profile.sample(now - profile_start, &p);
+			double setpoint = profile_from + p.position;
+			double pow = pos_controller.calc(setpoint, loc, last_output);
+			if (lift.use_alt) {
 				alt_controller.calc(target_pos, loc, last_output);
 			}
 			if (loc > 1.0 && pow > 0.0) {
@@ -139,10 +206,11 @@ void Intake::process() {
 		}
 		break;
 	case kPower:
-		if (potbroke) {
+		profiled = false;
+		if (lift.potbroke) {
 			setLiftDirect(target_power * SCALE_BROKEN_POWER_CONTROL);
 		} else {
-			double loc = getLocation();
+			double loc = pot.getLocation();
 			double power = target_power;
 			if (target_power < 0) { // up
 				double dist = HIGH_POWER_STOP - loc;
@@ -167,28 +235,31 @@ void Intake::process() {
 		}
 		break;
 	}
+}
 
+void Intake::process() {
+	Profiler prof(INTAKE_PROCESS_SCOPE);
 	switch (direction) {
 	case kSpinCustomIn:
 		printf("Custom in: %f\n", custom_spin_speed);
-		motor_roller.Set(custom_spin_speed);
+		motor_roller.Stage(custom_spin_speed);
 		break;
 	case kSpinCustomOut:
 		printf("Custom out: %f\n", custom_spin_speed);
-		motor_roller.Set(-custom_spin_speed);
+		motor_roller.Stage(-custom_spin_speed);
 		break;
 	case kSpinIn:
-		motor_roller.Set(SPIN_IN_POWER);
+		motor_roller.Stage(SPIN_IN_POWER);
 		break;
 	case kSpinOutSlow:
-		motor_roller.Set(-SPIN_OUT_SLOW_POWER);
+		motor_roller.Stage(-SPIN_OUT_SLOW_POWER);
 		break;
 	case kSpinOut:
-		motor_roller.Set(-SPIN_OUT_POWER);
+		motor_roller.Stage(-SPIN_OUT_POWER);
 		break;
 	default:
 	case kSpinNot:
-		motor_roller.Set(0.0);
+		motor_roller.Stage(0.0);
 		break;
 	}
 }
@@ -197,12 +268,14 @@ void Intake::debug() {
 	LCDWriter d;
 	d.line1("V: %6.5f L: %4.3f", pot.getVoltage(), getLocation());
 	d.line2("V: %6.5f L: %4.3f", altpot.getVoltage(), getUnsloppedLocation());
-	d.line3("high %d low %d broke %d", isRaised(), isLowered(), potbroke);
-	d.line4("mode %d ball %d", mode, isBallPresent());
+	d.line3("high %d low %d broke %d", isRaised(), isLowered(),
+			command.potbroke);
+	d.line4("mode %d ball %d", command.mode, isBallPresent());
 	d.line5("lft %05.2f rol %05.2f", motor_lift.GetIdx(0)->GetOutputCurrent(),
 			motor_roller.GetIdx(0)->GetOutputCurrent());
 	d.line6("tg: %3.2f sp %d out %05.4f",
-			mode == kPower ? target_power : target_pos, direction, last_output);
+			command.mode == kPower ? command.target_power : command.target_pos,
+			direction, (double) last_output);
 }
 
 void Intake::spin(SpinMode spin) {
@@ -210,8 +283,9 @@ void Intake::spin(SpinMode spin) {
 }
 
 void Intake::moveArm(double down_power) {
-	target_power = down_power;
-	mode = kPower;
+	command.target_power = down_power;
+	command.mode = kPower;
+	sendCommand();
 }
 void Intake::goToLocation(Position p) {
 	switch (p) {
@@ -233,31 +307,31 @@ void Intake::goToLocation(Position p) {
 	}
 }
 void Intake::moveToPosition(double pos) {
-	target_pos = bound(pos, 0.0, 1.0);
-	if (mode != kPosition) {
-		pos_controller.reset(getLocation());
-		alt_controller.reset(getLocation());
+	command.target_pos = bound(pos, 0.0, 1.0);
+	if (command.mode != kPosition) {
+		command.resets++;
 	}
-	mode = kPosition;
+	command.mode = kPosition;
+	sendCommand();
 }
 
 bool Intake::isRaised() {
-	double loc = getLocation();
-	return (loc > SAFE_PERCENT);
+	return (sensors.intake_location > SAFE_PERCENT);
 }
 bool Intake::isLowered() {
 	return getLocation() < 0.2;
 }
 void Intake::setPotBroken(bool broke) {
-	potbroke = broke;
+	command.potbroke = broke;
+	sendCommand();
 }
 
 bool Intake::isBallPresent() {
-	return beam_break.Get();
+	return sensors.ball_present;
 }
 
 double Intake::getLocation() {
-	return pot.getLocation();
+	return sensors.intake_location;
 }
 
 double Intake::getUnsloppedLocation() {
@@ -265,7 +339,7 @@ double Intake::getUnsloppedLocation() {
 }
 
 double Intake::getTargetPos() {
-	return target_pos;
+	return command.target_pos;
 }
 
 void Intake::setLiftDirect(double v) {
@@ -277,7 +351,7 @@ double Intake::getLastLiftOutput() {
 }
 
 bool Intake::isPosOver() {
-	return getLocation() > target_pos + POS_OVER;
+	return getLocation() > command.target_pos + POS_OVER;
 }
 
 void Intake::setCustomSpinSpeed(double d) {
@@ -285,7 +359,8 @@ void Intake::setCustomSpinSpeed(double d) {
 }
 
 void Intake::setModelController(bool alt) {
-	use_alt = alt;
+	command.use_alt = alt;
+	sendCommand();
 	if (alt) {
 		pot.StartWatching();
 	} else {
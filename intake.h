@@ -3,6 +3,7 @@
 
 #include "util.h"
 #include "armcontroller.h"
+#include "robotstate.h"
 #include "Notifier.h"
 #include "AnalogChannel.h"
 #include "DigitalInput.h"
@@ -24,7 +25,7 @@ private:
 
 	SEM_ID semaphore;
 	bool watching;
-	MovingAverageFilter filter;
+	OneEuroFilter filter;
 	Notifier noti;
 	AnalogChannel pot;
 	Intake &intake;
@@ -48,13 +49,22 @@ public:
 		kLocFeed, kLocAutoKick, kLocArcKick, kLocTeleopKick
 	} Position;
 
-	Intake();
+	// the lift loop runs as often as the pot is sampled
+	// (IntakePot::kPeriod)
+	static const double kLiftPeriod = 0.005;
+
+	Intake(const RobotState& s);
 	/**
 	 * Reset state at start of a mode.
 	 */
 	void initialize();
 	/**
-	 * Update state every cycle.
+	 * Read the sensors into the next cycle's state.
+	 */
+	void sample(RobotState* next);
+	/**
+	 * Update state every cycle. Only stages the roller output; the
+	 * lift is controlled at kLiftPeriod on its own task.
 	 */
 	void process();
 	/**
@@ -97,7 +107,8 @@ public:
 	void setPotBroken(bool broke);
 
 	/**
-	 * Returns normalized range scaled from potentiometer reading;
+	 * Returns normalized range scaled from potentiometer reading,
+	 * as of the start of the cycle;
 	 * 0.0 is low position, 1.0 is high position
 	 */
 	double getLocation();
@@ -141,11 +152,20 @@ public:
 private:
 	/*
 	 * pos is a range from 0.0 (feeding position) to 1.0
-	 * (kicking position).
+	 * (kicking position). The lift gets there along a
+	 * trapezoidal profile.
 	 */
 	void moveToPosition(double pos);
 
+	static void callControl(void* intake);
+	/**
+	 * One step of the lift controller; runs on the
+	 * "IntakeLift" ControlExecutor task.
+	 */
+	void control();
+
 
+	const RobotState& sensors;
 	MultiMotor motor_roller;
 	MultiMotor motor_lift;
 	IntakePot pot;
@@ -159,15 +179,37 @@ private:
 		kPower, kPosition
 	} IntakeMode;
 
-	double target_power;
-	double target_pos;
-	SpinMode direction;
-	bool potbroke;
-	IntakeMode mode;
+	/**
+	 * Everything the lift loop needs from the main loop.
+	 */
+	typedef struct {
+		IntakeMode mode;
+		double target_power;
+		double target_pos;
+		bool potbroke;
+		bool use_alt;
+		// bumped whenever the position controllers must reset
+		unsigned int resets;
+	} LiftCommand;
 
-	double last_output;
+	void sendCommand();
+
+	// main loop side
+	LiftCommand command;
+	Handoff<LiftCommand> lift_handoff;
+	SpinMode direction;
 	double custom_spin_speed;
-	bool use_alt;
+
+	// lift task side
+	LiftCommand lift;
+	unsigned int lift_resets;
+	// the move toward lift.target_pos, planned on the lift task
+	MotionProfile profile;
+	bool profiled;
+	double profile_from;
+	double profile_to;
+	double profile_start;
+	volatile double last_output;
 };
 
 #endif
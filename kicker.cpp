@@ -3,6 +3,8 @@
 
 const double ENCODER_HIGH_LIMIT = 95; // ticks, from low limit angle to stopping angle, may include noise
 
+ProfileScope KICKER_PROCESS_SCOPE("Kicker::process");
+
 DoubleConstant INTAKE_WAIT_TIME(1.00, "KICKER_INTAKE_WAIT_TIME");
 
 DoubleConstant SAFETY_WAIT_TIME(1.75, "KICKER_PREKICK_MAXWAIT");
@@ -20,8 +22,8 @@ DoubleConstant GUARD_RIGHT_OUT_POS(0.149, "KICKER_GUARD_RIGHT_OUT");// greater i
 
 DoubleConstant OPEN_GUARD_TIME(0.40, "KICKER_OPEN_GUARD_TIME"); // seconds
 
-Kicker::Kicker(Intake &i) :
-			intake(i),
+Kicker::Kicker(const RobotState& s, Intake &i) :
+			sensors(s), intake(i),
 			motors(CANID_KICKER_LEFT_FRONT, CANID_KICKER_LEFT_MID,
 					CANID_KICKER_LEFT_BACK, CANID_KICKER_RIGHT_FRONT,
 					CANID_KICKER_RIGHT_MID, CANID_KICKER_RIGHT_BACK, false),
@@ -32,6 +34,16 @@ Kicker::Kicker(Intake &i) :
 
 	sensorsBroken = false;
 
+	// the high flag is wired to the limit input, and
+	// is checked every cycle while kicking
+	SafeCANJag* flag_motor = motors.GetByID(CANID_KICKER_LEFT_BACK);
+	CANStatusPoller::GetInstance()->Add(flag_motor,
+			1 << SafeCANJag::kStatusLimits);
+
+	InputLog::addEncoder(DIG_KICKER_ENCODER_A, &kicker_encoder);
+	InputLog::addCounter(DIG_KICKER_LOW_FLAG, &low_counter);
+	InputLog::addLimits(CANID_KICKER_LEFT_BACK, flag_motor);
+
 	initialize();
 }
 
@@ -48,7 +60,21 @@ void Kicker::initialize() {
 	guardsSet = false;
 }
 
+void Kicker::sample(RobotState* next) {
+	next->kicker_ticks = kicker_encoder.Get();
+	next->kicker_low_count = low_counter.Get();
+	next->kicker_low_flag = !low_flag.Get();
+	SafeCANJag* motor = motors.GetByID(CANID_KICKER_LEFT_BACK);
+	if (motor == NULL) {
+		printf("kicker left back motor dne\n");
+		next->kicker_high_flag = true;
+	} else {
+		next->kicker_high_flag = !motor->GetForwardLimitOK();
+	}
+}
+
 void Kicker::process() {
+	Profiler prof(KICKER_PROCESS_SCOPE);
 	// do sensors imply that the state should end?
 	bool sensor_end;
 
@@ -82,9 +108,9 @@ void Kicker::process() {
 			state = kKickSpinning;
 		}
 		break;
-	case kKickSpinning:
+	case kKickSpinning: {
 		// these two can be broken
-		bool d_encoder = kicker_encoder.Get() >= ENCODER_HIGH_LIMIT;
+		bool d_encoder = sensors.kicker_ticks >= ENCODER_HIGH_LIMIT;
 
 		// guaranteed to work ;-)
 		bool d_highflag = getHighFlag();
@@ -101,7 +127,7 @@ void Kicker::process() {
 			low_counter.Start();
 			setGuard(false);
 			kickPostMortem();
-			printf("ENC: %d >= %.0f\n", (int) kicker_encoder.Get(),
+			printf("ENC: %d >= %.0f\n", (int) sensors.kicker_ticks,
 					ENCODER_HIGH_LIMIT);
 			printf("END: encoder %d; high flag %d; timer %d\n", d_encoder,
 					d_highflag, d_timer);
@@ -111,6 +137,7 @@ void Kicker::process() {
 			turnKicker(startKickPower);
 			setGuard(true);
 		}
+	}
 		break;
 	case kKickStopping:
 		turnKicker(0.0);
@@ -124,10 +151,10 @@ void Kicker::process() {
 	case kKickResetting:
 		setGuard(false);
 
-		sensor_end = low_counter.Get() != 0;
+		sensor_end = sensors.kicker_low_count != 0;
 		if (timer.Get() > RESET_SAFETY_TIME || (sensor_end && !sensorsBroken)) {
 			printf("On reset conclusion: encoder at %d; beam at %c\n",
-					(int) kicker_encoder.Get(), sensor_end ? 'T' : 'F');
+					(int) sensors.kicker_ticks, sensor_end ? 'T' : 'F');
 			turnKicker(0.0); //stop the kicker
 			kicker_encoder.Reset();
 			kicker_encoder.Start();
@@ -146,7 +173,7 @@ void Kicker::process() {
 
 void Kicker::debug() {
 	LCDWriter d;
-	d.line1("encoder: %d", kicker_encoder.Get());
+	d.line1("encoder: %d", sensors.kicker_ticks);
 	d.line2("timer %f", timer.Get());
 	d.line3("");
 	d.line4("low: %d high: %d", getLowFlag(), getHighFlag());
@@ -172,7 +199,7 @@ void Kicker::setSensorsBroken(bool broke) {
 }
 
 void Kicker::turnKicker(double power) {
-	motors.Set(power);
+	motors.Stage(power);
 }
 
 void Kicker::setGuard(bool state) {
@@ -200,15 +227,10 @@ bool Kicker::isReset() {
 	return intake.isRaised() && state != kKickResetting;
 }
 bool Kicker::getLowFlag() {
-	return !low_flag.Get();
+	return sensors.kicker_low_flag;
 }
 bool Kicker::getHighFlag() {
-	SafeCANJag* motor = motors.GetByID(CANID_KICKER_LEFT_BACK);
-	if (motor == NULL) {
-		printf("kicker left back motor dne\n");
-		return true;
-	}
-	return !motor->GetForwardLimitOK();
+	return sensors.kicker_high_flag;
 }
 
 void Kicker::kickPostMortem() {
@@ -18,12 +18,16 @@
  */
 class Kicker {
 public:
-	Kicker(Intake &i);
+	Kicker(const RobotState& s, Intake &i);
 
 	/**
 	 * Reset state at start of a mode.
 	 */
 	void initialize();
+	/**
+	 * Read the sensors into the next cycle's state.
+	 */
+	void sample(RobotState* next);
 	/**
 	 * Update state every cycle.
 	 */
@@ -55,6 +59,7 @@ public:
 
 	/**
 	 * Apply power to kicker motors; positive "power" means upward rotation (kick)
+	 * Takes effect at the end of the loop (MultiMotor::CommitAll()).
 	 */
 	void turnKicker(double power);
 	/*
@@ -89,6 +94,7 @@ private:
 	 */
 	void kickPostMortem();
 
+	const RobotState& sensors;
 	Intake &intake;
 	MultiMotor motors;
 	Encoder kicker_encoder;
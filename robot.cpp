@@ -4,9 +4,17 @@
 #include "lights.h"
 #include "auto.h"
 #include "controls.h"
+#include "robotstate.h"
 #include "util.h"
 #include "SimpleRobot.h"
 
+// five minutes of main loops: a match, and the queue before it
+const char* INPUT_LOG_PATH = "/c/inputs.bin";
+const uint32_t INPUT_LOG_RECORDS = 30000;
+// constants profiles, switchable from the dashboard; each is read
+// from /c/constants_<name>.txt
+const char* CONSTANTS_PROFILES[] = { "practice", "competition" };
+
 /**
  * The robot.
  * 
@@ -26,17 +34,22 @@
  * 
  * Creating a CAN device: the first call to read takes almost exactly 2.005 seconds,
  *    probably due o authentification protocol and setup details.
+ *    This is overlapped with the rest of startup (see Bringup); the
+ *    Jaguars are configured only in RobotInit, all at once.
  */
 class Yolo: public SimpleRobot {
 private:
 	class PreInitCalls {
 	public:
 		PreInitCalls() {
+			Bringup::begin("construct");
 			time = GetTime();
 			printf("RobotBase UP: %f\n", time);
 		}
 		double time;
 	} pre_construct_;
+	// the sensors as of the top of this loop; see sampleInputs()
+	RobotState state;
 	Drive drive;
 	Intake intake;
 	Kicker kicker;
@@ -44,18 +57,29 @@ private:
 	Auto autosel;
 	Controls controls;
 public:
-	const static double ROBOT_PERIOD = 0.050;
+	// base tick: drive and joysticks run every tick
+	const static double ROBOT_PERIOD = 0.010;
+	const static double MECHANISM_PERIOD = 0.050;
+	const static double LIGHTS_PERIOD = 0.100;
+	const static double DISPLAY_PERIOD = 0.200;
 
 	Yolo() :
-		pre_construct_(), drive(), intake(), kicker(intake),
+		pre_construct_(), state(), drive(state), intake(state),
+				kicker(state, intake),
 				lights(drive, intake, kicker),
 				autosel(drive, intake, kicker, lights),
-				controls(drive, intake, kicker, lights) {
+				controls(drive, intake, kicker, lights), loop(ROBOT_PERIOD) {
+		mechanism_rate = loop.addRate("mechanism", MECHANISM_PERIOD);
+		lights_rate = loop.addRate("lights", LIGHTS_PERIOD);
+		display_rate = loop.addRate("display", DISPLAY_PERIOD);
+		mode_name = NULL;
+		Bringup::end("construct");
 		printf("Yolo Took %f to create\n", GetTime() - pre_construct_.time);
 		printf("Battery Voltage: %2.4f\n", GetBatteryVoltage());
 	}
 
 	~Yolo() {
+		InputLog::stop();
 		UDPLog::destroy();
 	}
 
@@ -63,38 +87,69 @@ public:
 	 * Should be called at the start of each mode
 	 */
 	void enterMode(const char* name) {
+		if (mode_name != NULL) {
+			loop.printStats(mode_name);
+			ControlExecutor::GetInstance()->PrintStats();
+		}
+		mode_name = name;
 		// update the semi-fixed constants
-		last_time = GetTime();
 		Constants::reload();
+		Constants::beginCycle();
+		sampleInputs();
+		InputLog::snapshotConstants();
 		printf("\n\n\t\t%s\n\n", name);
+		loop.start();
 	}
 
-	void waitUntilNextPeriod() {
-		double newtime = GetTime();
-		double delta = newtime - last_time;
-		UDPLog::log("Loop:%f\n", delta);
-		Wait(0.005);
-		double leftover = ROBOT_PERIOD - 0.005 - delta;
-		if (leftover > 0) {
-			Wait(leftover);
-		}
-		last_time = GetTime();
+	/**
+	 * The input stage: read every sensor once, into the state
+	 * the systems decide on for the rest of the loop.
+	 */
+	void sampleInputs() {
+		RobotState next;
+		next.time = GetTime();
+		drive.sample(&next);
+		intake.sample(&next);
+		kicker.sample(&next);
+		state = next;
 	}
 
 	void RobotInit() {
-		Constants::load();
+		Bringup::begin("input log");
+		InputLog::start(INPUT_LOG_PATH, INPUT_LOG_RECORDS);
+		Bringup::end("input log");
+		// the subsystems made no CAN calls; now the bus is up, they run
+		Bringup::waitCANWarmup();
+		Bringup::begin("jaguars");
+		MultiMotor::BringUpAll();
+		Bringup::end("jaguars");
+		CANStatusPoller::GetInstance()->Start();
+		Bringup::ready();
 		printf("\n\n\t\tROBOT INITIALIZED\n\n");
 	}
 
 	void Disabled() {
 		enterMode("DISABLED");
+		ControlExecutor::GetInstance()->Stop();
 		controls.initialize(false);
 		lights.initialize();
 		drive.measureGyro();
 		while (IsDisabled()) {
+			Constants::beginCycle();
+			InputLog::record();
+			sampleInputs();
 			controls.process(false);
-			lights.process();
-			waitUntilNextPeriod();
+			if (loop.isDue(lights_rate)) {
+				lights.process();
+			}
+			if (loop.isDue(display_rate)) {
+				controls.processDisplay();
+				// paths and such, ahead of autonomous
+				autosel.prepare(controls.getAutoMode());
+			}
+			// the output stage: what the systems staged, all at once
+			MultiMotor::CommitAll();
+			loop.waitForNextTick();
 		}
 		drive.finalizeGyro();
 	}
@@ -106,13 +161,22 @@ public:
 		intake.initialize();
 		kicker.initialize();
 		drive.initialize();
+		ControlExecutor::GetInstance()->Start();
 		while (IsAutonomous() && IsEnabled()) {
-			autosel.process();
-			lights.process();
-			intake.process();
-			kicker.process();
+			Constants::beginCycle();
+			InputLog::record();
+			sampleInputs();
+			if (loop.isDue(mechanism_rate)) {
+				autosel.process();
+				intake.process();
+				kicker.process();
+			}
 			drive.process();
-			waitUntilNextPeriod();
+			if (loop.isDue(lights_rate)) {
+				lights.process();
+			}
+			MultiMotor::CommitAll();
+			loop.waitForNextTick();
 		}
 	}
 
@@ -123,13 +187,25 @@ public:
 		intake.initialize();
 		kicker.initialize();
 		drive.initialize();
+		ControlExecutor::GetInstance()->Start();
 		while (IsOperatorControl() && IsEnabled()) {
+			Constants::beginCycle();
+			InputLog::record();
+			sampleInputs();
 			controls.process(true);
-			intake.process();
-			kicker.process();
+			if (loop.isDue(mechanism_rate)) {
+				intake.process();
+				kicker.process();
+			}
 			drive.process();
-			lights.process();
-			waitUntilNextPeriod();
+			if (loop.isDue(lights_rate)) {
+				lights.process();
+			}
+			if (loop.isDue(display_rate)) {
+				controls.processDisplay();
+			}
+			MultiMotor::CommitAll();
+			loop.waitForNextTick();
 		}
 	}
 
@@ -137,7 +213,11 @@ public:
 		enterMode("TEST");
 	}
 private:
-	double last_time;
+	LoopScheduler loop;
+	int mechanism_rate;
+	int lights_rate;
+	int display_rate;
+	const char* mode_name;
 
 };
 
@@ -147,12 +227,22 @@ RobotBase *FRC_userClassFactory() {
 	//
 	UDPLog::setup();
 	//
-	// The first CANBus message takes roughly 2 seconds.
-	// The call UpdateSyncGroup(0) does nothing because:
-	//   No jaguars have been commanded with a sync group.
-	//   Sync groups mask in strange ways. 
+	// The first CANBus message takes roughly 2 seconds; send it
+	// on another task, and load constants and build the robot
+	// (which sends nothing on CAN) meanwhile.
 	//
-	SafeCANJag::UpdateSyncGroup(0);
+	Bringup::startCANWarmup();
+	// before construction, so constructors see the file's values
+	Bringup::begin("constants");
+	Constants::load();
+	int profiles = sizeof(CONSTANTS_PROFILES) / sizeof(CONSTANTS_PROFILES[0]);
+	for (int i = 0; i < profiles; i++) {
+		char path[64];
+		snprintf(path, sizeof(path), "/c/constants_%s.txt",
+				CONSTANTS_PROFILES[i]);
+		Constants::loadProfile(CONSTANTS_PROFILES[i], path);
+	}
+	Bringup::end("constants");
 	return new Yolo();
 }
 extern "C" {
@@ -0,0 +1,37 @@
+#ifndef ROBOTSTATE_H_
+#define ROBOTSTATE_H_
+
+#include <stdint.h>
+#include "util.h"
+
+/**
+ * Every sensor the main loop decides on, read once at the top
+ * of each loop (see Yolo::sampleInputs) and then left alone
+ * until the next one. The systems hold it by const reference,
+ * so all the decisions in a cycle see the same values, and
+ * none of them reads the hardware again.
+ *
+ * The intake lift loop runs on its own task, faster than this,
+ * and reads the pot itself; so does the drive odometry, with
+ * the drive counters and gyro.
+ */
+typedef struct {
+	// GetTime() when the sensors were read
+	double time;
+
+	// 0.0 is feeding position, 1.0 kicking position (filtered pot)
+	double intake_location;
+	bool ball_present;
+
+	// ticks since the kicker last reset its encoder
+	int32_t kicker_ticks;
+	// low flag trips since the kicker last reset its counter
+	int32_t kicker_low_count;
+	bool kicker_low_flag;
+	bool kicker_high_flag;
+
+	// where the drive's odometry put the robot, as of `time`
+	Odometry::Pose pose;
+} RobotState;
+
+#endif
@@ -0,0 +1,121 @@
+#include "simcan.h"
+#include "simkernel.h"
+#include "candriver.h"
+#include "safecanjag.h"
+#include "CAN/JaguarCANDriver.h"
+#include "CAN/can_proto.h"
+#include <pthread.h>
+
+// the robot's first CAN call stalls this long while the
+// driver comes up; every call until then waits with it
+const double WARMUP_TIME = 2.005;
+
+static pthread_mutex_t bus_lock = PTHREAD_MUTEX_INITIALIZER;
+static SimCANDriver bus;
+static double ready_time = -1.0;
+
+/**
+ * Jaguars with nothing wired to their limit inputs
+ * report both limits as OK.
+ */
+static class BusInit {
+public:
+	BusInit() {
+		uint8_t ok = SafeCANJag::kForwardLimit | SafeCANJag::kReverseLimit;
+		for (uint8_t device = 1; device <= CAN_MSGID_DEVNO_M; device++) {
+			bus.setRegister(device, LM_API_STATUS_LIMIT, &ok, sizeof(ok));
+		}
+	}
+} bus_init;
+
+/**
+ * Bring the bus up to virtual time `now`; it may already be
+ * ahead, if another thread's reply is still on the wire.
+ * Needs the bus lock.
+ */
+static void sync(double now) {
+	if (now > bus.now()) {
+		bus.advance(now - bus.now());
+	}
+}
+
+static void warmUp() {
+	double now = SimKernel::now();
+	pthread_mutex_lock(&bus_lock);
+	if (ready_time < 0.0) {
+		ready_time = now + WARMUP_TIME;
+	}
+	double ready = ready_time;
+	pthread_mutex_unlock(&bus_lock);
+	if (now < ready) {
+		SimKernel::sleepUntil(ready);
+	}
+}
+
+extern "C" {
+void FRC_NetworkCommunication_JaguarCANDriver_sendMessage(uint32_t messageID,
+		const uint8_t *data, uint8_t dataSize, int32_t *status) {
+	warmUp();
+	double now = SimKernel::now();
+	pthread_mutex_lock(&bus_lock);
+	sync(now);
+	*status = bus.sendMessage(messageID, data, dataSize);
+	pthread_mutex_unlock(&bus_lock);
+}
+
+void FRC_NetworkCommunication_JaguarCANDriver_receiveMessage(
+		uint32_t *messageID, uint8_t *data, uint8_t *dataSize,
+		uint32_t timeoutMs, int32_t *status) {
+	warmUp();
+	double now = SimKernel::now();
+	pthread_mutex_lock(&bus_lock);
+	sync(now);
+	*status = bus.receiveMessage(messageID, data, dataSize, timeoutMs);
+	double done = bus.now();
+	pthread_mutex_unlock(&bus_lock);
+	// the wait happens here, where other threads may run
+	SimKernel::sleepUntil(done);
+}
+}
+
+double SimCAN::getOutput(uint8_t device) {
+	uint8_t data[8];
+	pthread_mutex_lock(&bus_lock);
+	uint8_t size = bus.getRegister(device, LM_API_VOLT_SET, data);
+	pthread_mutex_unlock(&bus_lock);
+	if (size != sizeof(int16_t)) {
+		return 0.0;
+	}
+	return SafeCANJag::unpackPercentage(data);
+}
+
+void SimCAN::setLimits(uint8_t device, bool forward_ok, bool reverse_ok) {
+	uint8_t limits = (forward_ok ? SafeCANJag::kForwardLimit : 0)
+			| (reverse_ok ? SafeCANJag::kReverseLimit : 0);
+	pthread_mutex_lock(&bus_lock);
+	bus.setRegister(device, LM_API_STATUS_LIMIT, &limits, sizeof(limits));
+	pthread_mutex_unlock(&bus_lock);
+}
+
+void SimCAN::setCurrent(uint8_t device, double amps) {
+	uint8_t data[8];
+	uint8_t size = SafeCANJag::packFXP8_8(data, amps);
+	pthread_mutex_lock(&bus_lock);
+	bus.setRegister(device, LM_API_STATUS_CURRENT, data, size);
+	pthread_mutex_unlock(&bus_lock);
+}
+
+void SimCAN::setBusVoltage(uint8_t device, double volts) {
+	uint8_t data[8];
+	uint8_t size = SafeCANJag::packFXP8_8(data, volts);
+	pthread_mutex_lock(&bus_lock);
+	bus.setRegister(device, LM_API_STATUS_VOLTBUS, data, size);
+	pthread_mutex_unlock(&bus_lock);
+}
+
+int SimCAN::getFramesSent() {
+	pthread_mutex_lock(&bus_lock);
+	int sent = bus.getFramesSent();
+	pthread_mutex_unlock(&bus_lock);
+	return sent;
+}
@@ -0,0 +1,33 @@
+#ifndef SIM_SIMCAN_H_
+#define SIM_SIMCAN_H_
+
+#include "vxWorks.h"
+
+/**
+ * The CAN bus behind FRC_NetworkCommunication_JaguarCANDriver_*:
+ * one SimCANDriver, kept in step with the virtual clock. A thread
+ * that waits for a reply sleeps until the reply would have arrived,
+ * so CAN traffic takes as long as it would on a real bus.
+ *
+ * As on the robot, the first call takes about two seconds, while
+ * the driver comes up.
+ *
+ * The plant reads and writes the Jaguars' registers through here.
+ * Threadsafe, and callable from the kernel's tick hook.
+ */
+class SimCAN {
+public:
+	/**
+	 * The output the Jaguar was last set to, from -1 to 1.
+	 */
+	static double getOutput(uint8_t device);
+	/**
+	 * Set what the Jaguar reports for its limit switches.
+	 */
+	static void setLimits(uint8_t device, bool forward_ok, bool reverse_ok);
+	static void setCurrent(uint8_t device, double amps);
+	static void setBusVoltage(uint8_t device, double volts);
+	static int getFramesSent();
+};
+
+#endif
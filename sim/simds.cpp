@@ -0,0 +1,430 @@
+/**
+ * WPILib's driver station, robot base and dashboard, run
+ * from SimMatch.
+ */
+#include "simmatch.h"
+#include "simhardware.h"
+#include "DriverStation.h"
+#include "DriverStationLCD.h"
+#include "Joystick.h"
+#include "SimpleRobot.h"
+#include "Synchronized.h"
+#include "networktables/NetworkTable.h"
+#include "SmartDashboard/SmartDashboard.h"
+#include "LiveWindow/LiveWindow.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const uint32_t DriverStation::kJoystickPorts;
+const uint32_t DriverStation::kJoystickAxes;
+
+// the field sends a control packet every 20 ms
+const double PACKET_PERIOD = 0.020;
+
+DriverStation::DriverStation() {
+}
+
+DriverStation* DriverStation::GetInstance() {
+	static DriverStation ds;
+	return &ds;
+}
+
+float DriverStation::GetStickAxis(uint32_t stick, uint32_t axis) {
+	if (stick < 1 || stick > kJoystickPorts || axis < 1 || axis
+			> kJoystickAxes) {
+		printf("DriverStation: no joystick %u axis %u\n", stick, axis);
+		return 0.0;
+	}
+	return SimMatch::getAxis(stick, axis);
+}
+
+short DriverStation::GetStickButtons(uint32_t stick) {
+	if (stick < 1 || stick > kJoystickPorts) {
+		printf("DriverStation: no joystick %u\n", stick);
+		return 0;
+	}
+	return SimMatch::getButtons(stick);
+}
+
+float DriverStation::GetBatteryVoltage() {
+	return SimHardware::getBatteryVoltage();
+}
+
+bool DriverStation::IsEnabled() {
+	return SimMatch::getMode() != SimMatch::kDisabled;
+}
+
+bool DriverStation::IsDisabled() {
+	return SimMatch::getMode() == SimMatch::kDisabled;
+}
+
+bool DriverStation::IsAutonomous() {
+	return SimMatch::getMode() == SimMatch::kAutonomous;
+}
+
+bool DriverStation::IsOperatorControl() {
+	return SimMatch::getMode() == SimMatch::kTeleop;
+}
+
+bool DriverStation::IsTest() {
+	return false;
+}
+
+void DriverStation::WaitForData() {
+	Wait(PACKET_PERIOD);
+}
+
+const uint32_t DriverStationLCD::kLineLength;
+const uint32_t DriverStationLCD::kNumLines;
+
+DriverStationLCD::DriverStationLCD() :
+	m_show(getenv("SIM_LCD") != NULL) {
+	m_textBufferSemaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE
+			| SEM_DELETE_SAFE);
+	Clear();
+}
+
+DriverStationLCD* DriverStationLCD::GetInstance() {
+	static DriverStationLCD lcd;
+	return &lcd;
+}
+
+void DriverStationLCD::UpdateLCD() {
+	if (!m_show) {
+		return;
+	}
+	Synchronized sync(m_textBufferSemaphore);
+	printf("[lcd %7.3f]", GetTime());
+	for (uint32_t i = 0; i < kNumLines; i++) {
+		printf(" |%-21s", m_lines[i]);
+	}
+	printf("|\n");
+}
+
+void DriverStationLCD::PrintfLine(Line line, const char *writeFmt, ...) {
+	va_list args;
+	va_start(args, writeFmt);
+	VPrintfLine(line, writeFmt, args);
+	va_end(args);
+}
+
+void DriverStationLCD::VPrintfLine(Line line, const char *writeFmt,
+		va_list args) {
+	if ((uint32_t) line >= kNumLines) {
+		return;
+	}
+	Synchronized sync(m_textBufferSemaphore);
+	vsnprintf(m_lines[line], kLineLength + 1, writeFmt, args);
+}
+
+void DriverStationLCD::Clear() {
+	Synchronized sync(m_textBufferSemaphore);
+	memset(m_lines, 0, sizeof(m_lines));
+}
+
+Joystick::Joystick(uint32_t port) :
+	m_ds(DriverStation::GetInstance()), m_port(port) {
+}
+
+Joystick::~Joystick() {
+}
+
+float Joystick::GetX() {
+	return GetRawAxis(1);
+}
+
+float Joystick::GetY() {
+	return GetRawAxis(2);
+}
+
+float Joystick::GetRawAxis(uint32_t axis) {
+	return m_ds->GetStickAxis(m_port, axis);
+}
+
+bool Joystick::GetRawButton(uint32_t button) {
+	return ((0x1 << (button - 1)) & m_ds->GetStickButtons(m_port)) != 0;
+}
+
+RobotBase *RobotBase::m_instance = NULL;
+
+RobotBase::RobotBase() :
+	m_ds(DriverStation::GetInstance()) {
+	setInstance(this);
+}
+
+RobotBase::~RobotBase() {
+	m_instance = NULL;
+}
+
+RobotBase &RobotBase::getInstance() {
+	return *m_instance;
+}
+
+void RobotBase::setInstance(RobotBase* robot) {
+	m_instance = robot;
+}
+
+// task arguments are 32 bits, too narrow for a pointer on the host
+static FUNCPTR robot_factory = NULL;
+
+void RobotBase::startRobotTask(FUNCPTR factory) {
+	robot_factory = factory;
+	Task *task = new Task("FRC_RobotTask", (FUNCPTR) RobotBase::robotTask);
+	task->Start();
+}
+
+int RobotBase::robotTask(FUNCPTR factory) {
+	RobotBase *robot = ((RobotBase *(*)()) robot_factory)();
+	robot->StartCompetition();
+	return 0;
+}
+
+bool RobotBase::IsEnabled() {
+	return m_ds->IsEnabled();
+}
+
+bool RobotBase::IsDisabled() {
+	return m_ds->IsDisabled();
+}
+
+bool RobotBase::IsAutonomous() {
+	return m_ds->IsAutonomous();
+}
+
+bool RobotBase::IsOperatorControl() {
+	return m_ds->IsOperatorControl();
+}
+
+bool RobotBase::IsTest() {
+	return m_ds->IsTest();
+}
+
+SimpleRobot::SimpleRobot() {
+}
+
+SimpleRobot::~SimpleRobot() {
+}
+
+void SimpleRobot::RobotInit() {
+}
+
+void SimpleRobot::Disabled() {
+}
+
+void SimpleRobot::Autonomous() {
+}
+
+void SimpleRobot::OperatorControl() {
+}
+
+void SimpleRobot::Test() {
+}
+
+/**
+ * As in WPILib: each mode method runs until it returns,
+ * and is then not called again until the mode changes.
+ */
+void SimpleRobot::StartCompetition() {
+	RobotInit();
+	while (true) {
+		if (IsDisabled()) {
+			Disabled();
+			while (IsDisabled()) {
+				m_ds->WaitForData();
+			}
+		} else if (IsAutonomous()) {
+			Autonomous();
+			while (IsAutonomous() && IsEnabled()) {
+				m_ds->WaitForData();
+			}
+		} else if (IsTest()) {
+			Test();
+			while (IsTest() && IsEnabled()) {
+				m_ds->WaitForData();
+			}
+		} else {
+			OperatorControl();
+			while (IsOperatorControl() && IsEnabled()) {
+				m_ds->WaitForData();
+			}
+		}
+	}
+}
+
+TableKeyNotDefinedException::TableKeyNotDefinedException(const std::string key) :
+	msg("Unkown Table Key: " + key) {
+}
+
+TableKeyNotDefinedException::~TableKeyNotDefinedException() throw () {
+}
+
+const char* TableKeyNotDefinedException::what() const throw () {
+	return msg.c_str();
+}
+
+NetworkTable::NetworkTable() {
+	semaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+}
+
+NetworkTable* NetworkTable::GetTable(std::string key) {
+	static SEM_ID tables_semaphore = semMCreate(SEM_Q_PRIORITY
+			| SEM_INVERSION_SAFE);
+	static std::map<std::string, NetworkTable*> tables;
+	Synchronized sync(tables_semaphore);
+	NetworkTable*& table = tables[key];
+	if (table == NULL) {
+		table = new NetworkTable();
+	}
+	return table;
+}
+
+/**
+ * Store `value`, and tell the listeners on `key` if it changed;
+ * they are called without the table locked, so they may use it.
+ */
+void NetworkTable::Put(const std::string& key, EntryValue value) {
+	std::vector<ITableListener*> notify;
+	bool isNew;
+	{
+		Synchronized sync(semaphore);
+		std::map<std::string, EntryValue>::iterator it = values.find(key);
+		isNew = (it == values.end());
+		if (!isNew && memcmp(&it->second, &value, sizeof(value)) == 0) {
+			return;
+		}
+		values[key] = value;
+		for (size_t i = 0; i < listeners.size(); i++) {
+			if (listeners[i].key == key) {
+				notify.push_back(listeners[i].listener);
+			}
+		}
+	}
+	for (size_t i = 0; i < notify.size(); i++) {
+		notify[i]->ValueChanged(this, key, value, isNew);
+	}
+}
+
+bool NetworkTable::Lookup(const std::string& key, EntryValue* value) {
+	Synchronized sync(semaphore);
+	std::map<std::string, EntryValue>::iterator it = values.find(key);
+	if (it == values.end()) {
+		return false;
+	}
+	*value = it->second;
+	return true;
+}
+
+bool NetworkTable::ContainsKey(std::string key) {
+	EntryValue value;
+	return Lookup(key, &value);
+}
+
+void NetworkTable::PutNumber(std::string key, double value) {
+	EntryValue entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.f = value;
+	Put(key, entry);
+}
+
+double NetworkTable::GetNumber(std::string key) {
+	EntryValue value;
+	if (!Lookup(key, &value)) {
+		throw TableKeyNotDefinedException(key);
+	}
+	return value.f;
+}
+
+double NetworkTable::GetNumber(std::string key, double defaultValue) {
+	EntryValue value;
+	return Lookup(key, &value) ? value.f : defaultValue;
+}
+
+void NetworkTable::PutBoolean(std::string key, bool value) {
+	EntryValue entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.b = value;
+	Put(key, entry);
+}
+
+bool NetworkTable::GetBoolean(std::string key) {
+	EntryValue value;
+	if (!Lookup(key, &value)) {
+		throw TableKeyNotDefinedException(key);
+	}
+	return value.b;
+}
+
+bool NetworkTable::GetBoolean(std::string key, bool defaultValue) {
+	EntryValue value;
+	return Lookup(key, &value) ? value.b : defaultValue;
+}
+
+void NetworkTable::AddTableListener(std::string key,
+		ITableListener* listener, bool immediateNotify) {
+	EntryValue value;
+	bool present;
+	{
+		Synchronized sync(semaphore);
+		Listener entry;
+		entry.key = key;
+		entry.listener = listener;
+		listeners.push_back(entry);
+	}
+	present = Lookup(key, &value);
+	if (immediateNotify && present) {
+		listener->ValueChanged(this, key, value, true);
+	}
+}
+
+void NetworkTable::RemoveTableListener(ITableListener* listener) {
+	Synchronized sync(semaphore);
+	for (size_t i = 0; i < listeners.size();) {
+		if (listeners[i].listener == listener) {
+			listeners.erase(listeners.begin() + i);
+		} else {
+			i++;
+		}
+	}
+}
+
+static NetworkTable* dashboard() {
+	return NetworkTable::GetTable("SmartDashboard");
+}
+
+void SmartDashboard::PutBoolean(std::string keyName, bool value) {
+	dashboard()->PutBoolean(keyName, value);
+}
+
+bool SmartDashboard::GetBoolean(std::string keyName) {
+	return dashboard()->GetBoolean(keyName);
+}
+
+void SmartDashboard::PutNumber(std::string keyName, double value) {
+	dashboard()->PutNumber(keyName, value);
+}
+
+double SmartDashboard::GetNumber(std::string keyName) {
+	return dashboard()->GetNumber(keyName);
+}
+
+LiveWindow::LiveWindow() {
+}
+
+LiveWindow* LiveWindow::GetInstance() {
+	static LiveWindow window;
+	return &window;
+}
+
+void LiveWindow::AddActuator(const char *subsystem, const char *name,
+		LiveWindowSendable *component) {
+}
+
+void LiveWindow::AddActuator(const char *moduleType, int moduleNumber,
+		int channel, LiveWindowSendable *component) {
+}
+
+void LiveWindow::AddSensor(const char *moduleType, int channel,
+		LiveWindowSendable *component) {
+}
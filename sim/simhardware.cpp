@@ -0,0 +1,347 @@
+#include "simhardware.h"
+#include <pthread.h>
+#include <math.h>
+
+const uint32_t SimHardware::kAnalogChannels;
+const uint32_t SimHardware::kDigitalChannels;
+const uint32_t SimHardware::kPWMChannels;
+const uint32_t SimHardware::kAccumulatorChannels;
+const uint32_t SimHardware::kSampleRate;
+const uint32_t SimHardware::kLSBWeight;
+
+// peak ADC noise, in counts
+const double ADC_NOISE = 1.0;
+
+typedef struct {
+	double volts;
+	uint32_t average_bits;
+	uint32_t oversample_bits;
+	// accumulator
+	INT64 value;
+	uint32_t count;
+	int32_t center;
+	int32_t deadband;
+	// values owed, but not yet whole
+	double pending;
+	// replaying recorded readings
+	bool value_held;
+	int16_t held_value;
+	bool accumulator_held;
+} Analog;
+
+typedef struct {
+	bool level;
+	uint32_t edges;
+	double last_edge;
+	double period;
+	int32_t quadrature;
+	double rate;
+	bool output;
+	// replaying recorded readings
+	bool count_held;
+	int32_t held_count;
+	bool quadrature_held;
+	int32_t held_quadrature;
+} Digital;
+
+static pthread_mutex_t hw_lock = PTHREAD_MUTEX_INITIALIZER;
+static Analog analog[SimHardware::kAnalogChannels + 1];
+static Digital digital[SimHardware::kDigitalChannels + 1];
+static float pwm[SimHardware::kPWMChannels + 1];
+static double battery = 12.5;
+static unsigned int noise_state = 1511;
+
+class Locked {
+public:
+	Locked() {
+		pthread_mutex_lock(&hw_lock);
+	}
+	~Locked() {
+		pthread_mutex_unlock(&hw_lock);
+	}
+};
+
+/**
+ * Uniform in [-1, 1); deterministic, so runs repeat.
+ */
+static double noise() {
+	noise_state = noise_state * 1103515245 + 12345;
+	return ((int) ((noise_state >> 16) & 0x7FFF) - 0x4000) / 16384.0;
+}
+
+static Analog* analogChannel(uint32_t channel) {
+	if (channel < 1 || channel > SimHardware::kAnalogChannels) {
+		return &analog[0];
+	}
+	return &analog[channel];
+}
+
+static Digital* digitalChannel(uint32_t channel) {
+	if (channel < 1 || channel > SimHardware::kDigitalChannels) {
+		return &digital[0];
+	}
+	return &digital[channel];
+}
+
+static double counts(const Analog* a) {
+	return a->volts * 1e9 / SimHardware::kLSBWeight;
+}
+
+static class Init {
+public:
+	Init() {
+		for (uint32_t i = 0; i <= SimHardware::kDigitalChannels; i++) {
+			digital[i].level = true;
+			digital[i].edges = 0;
+			digital[i].last_edge = 0.0;
+			digital[i].period = 0.0;
+			digital[i].quadrature = 0;
+			digital[i].rate = 0.0;
+			digital[i].output = false;
+			digital[i].count_held = false;
+			digital[i].held_count = 0;
+			digital[i].quadrature_held = false;
+			digital[i].held_quadrature = 0;
+		}
+		for (uint32_t i = 0; i <= SimHardware::kAnalogChannels; i++) {
+			analog[i].volts = 0.0;
+			analog[i].average_bits = 0;
+			analog[i].oversample_bits = 0;
+			analog[i].value = 0;
+			analog[i].count = 0;
+			analog[i].center = 0;
+			analog[i].deadband = 0;
+			analog[i].pending = 0.0;
+			analog[i].value_held = false;
+			analog[i].held_value = 0;
+			analog[i].accumulator_held = false;
+		}
+		for (uint32_t i = 0; i <= SimHardware::kPWMChannels; i++) {
+			pwm[i] = 0.0;
+		}
+	}
+} init;
+
+void SimHardware::setVoltage(uint32_t channel, double volts) {
+	Locked l;
+	analogChannel(channel)->volts = volts;
+}
+
+int16_t SimHardware::getValue(uint32_t channel) {
+	Locked l;
+	Analog* a = analogChannel(channel);
+	if (a->value_held) {
+		return a->held_value;
+	}
+	// averaging 2^n samples divides the noise by 2^(n/2)
+	double spread = ADC_NOISE / sqrt((double) (1 << a->average_bits));
+	return (int16_t) floor(counts(a) + spread * noise() + 0.5);
+}
+
+void SimHardware::setAverageBits(uint32_t channel, uint32_t bits) {
+	Locked l;
+	analogChannel(channel)->average_bits = bits;
+}
+
+uint32_t SimHardware::getAverageBits(uint32_t channel) {
+	Locked l;
+	return analogChannel(channel)->average_bits;
+}
+
+void SimHardware::setOversampleBits(uint32_t channel, uint32_t bits) {
+	Locked l;
+	analogChannel(channel)->oversample_bits = bits;
+}
+
+uint32_t SimHardware::getOversampleBits(uint32_t channel) {
+	Locked l;
+	return analogChannel(channel)->oversample_bits;
+}
+
+bool SimHardware::isAccumulatorChannel(uint32_t channel) {
+	return channel >= 1 && channel <= kAccumulatorChannels;
+}
+
+void SimHardware::resetAccumulator(uint32_t channel, INT64 initial) {
+	Locked l;
+	Analog* a = analogChannel(channel);
+	if (a->accumulator_held) {
+		return;
+	}
+	a->value = initial;
+	a->count = 0;
+	a->pending = 0.0;
+}
+
+void SimHardware::setAccumulatorCenter(uint32_t channel, int32_t center) {
+	Locked l;
+	analogChannel(channel)->center = center;
+}
+
+void SimHardware::setAccumulatorDeadband(uint32_t channel, int32_t deadband) {
+	Locked l;
+	analogChannel(channel)->deadband = deadband;
+}
+
+void SimHardware::getAccumulator(uint32_t channel, INT64* value,
+		uint32_t* count) {
+	Locked l;
+	Analog* a = analogChannel(channel);
+	*value = a->value;
+	*count = a->count;
+}
+
+void SimHardware::accumulate(double seconds) {
+	Locked l;
+	for (uint32_t i = 1; i <= kAccumulatorChannels; i++) {
+		Analog* a = &analog[i];
+		if (a->accumulator_held) {
+			continue;
+		}
+		uint32_t bits = a->average_bits + a->oversample_bits;
+		a->pending += seconds * kSampleRate / (1 << bits);
+		uint32_t n = (uint32_t) a->pending;
+		if (n == 0) {
+			continue;
+		}
+		a->pending -= n;
+		// each value sums 2^oversample averaged samples
+		INT64 v = (INT64) floor(counts(a) * (1 << a->oversample_bits)
+				+ noise() * ADC_NOISE + 0.5) - a->center;
+		if (v > a->deadband || v < -a->deadband) {
+			a->value += v * n;
+		}
+		a->count += n;
+	}
+}
+
+void SimHardware::setDigital(uint32_t channel, bool level) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	if (level && !d->level) {
+		d->edges++;
+	}
+	d->level = level;
+}
+
+bool SimHardware::getDigital(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->level;
+}
+
+void SimHardware::addEdges(uint32_t channel, uint32_t edges, double time) {
+	if (edges == 0) {
+		return;
+	}
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	d->edges += edges;
+	d->period = (time - d->last_edge) / edges;
+	d->last_edge = time;
+}
+
+uint32_t SimHardware::getEdges(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->edges;
+}
+
+double SimHardware::getEdgePeriod(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->period;
+}
+
+void SimHardware::setQuadrature(uint32_t channel, int32_t cycles, double rate) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	d->quadrature = cycles;
+	d->rate = rate;
+}
+
+int32_t SimHardware::getQuadrature(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->quadrature;
+}
+
+double SimHardware::getQuadratureRate(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->rate;
+}
+
+void SimHardware::setDigitalOutput(uint32_t channel, bool level) {
+	Locked l;
+	digitalChannel(channel)->output = level;
+}
+
+bool SimHardware::getDigitalOutput(uint32_t channel) {
+	Locked l;
+	return digitalChannel(channel)->output;
+}
+
+void SimHardware::setPWM(uint32_t channel, float position) {
+	Locked l;
+	if (channel >= 1 && channel <= kPWMChannels) {
+		pwm[channel] = position;
+	}
+}
+
+float SimHardware::getPWM(uint32_t channel) {
+	Locked l;
+	if (channel >= 1 && channel <= kPWMChannels) {
+		return pwm[channel];
+	}
+	return 0.0;
+}
+
+void SimHardware::setBatteryVoltage(double volts) {
+	Locked l;
+	battery = volts;
+}
+
+double SimHardware::getBatteryVoltage() {
+	Locked l;
+	return battery;
+}
+
+void SimHardware::holdValue(uint32_t channel, int16_t value) {
+	Locked l;
+	Analog* a = analogChannel(channel);
+	a->value_held = true;
+	a->held_value = value;
+}
+
+void SimHardware::holdAccumulator(uint32_t channel, INT64 value,
+		uint32_t count) {
+	Locked l;
+	Analog* a = analogChannel(channel);
+	a->accumulator_held = true;
+	a->value = value;
+	a->count = count;
+}
+
+void SimHardware::holdCount(uint32_t channel, int32_t count) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	d->count_held = true;
+	d->held_count = count;
+}
+
+bool SimHardware::getHeldCount(uint32_t channel, int32_t* count) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	*count = d->held_count;
+	return d->count_held;
+}
+
+void SimHardware::holdQuadrature(uint32_t channel, int32_t count) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	d->quadrature_held = true;
+	d->held_quadrature = count;
+}
+
+bool SimHardware::getHeldQuadrature(uint32_t channel, int32_t* count) {
+	Locked l;
+	Digital* d = digitalChannel(channel);
+	*count = d->held_quadrature;
+	return d->quadrature_held;
+}
@@ -0,0 +1,95 @@
+#ifndef SIM_SIMHARDWARE_H_
+#define SIM_SIMHARDWARE_H_
+
+#include "vxWorks.h"
+
+/**
+ * The signals on the cRIO's modules: what the plant (SimPhysics)
+ * drives and the WPILib stand-ins read, or the other way around.
+ * Channels are numbered from 1, as on the modules.
+ *
+ * Analog inputs are quantized to the ADC's LSB, with a little
+ * noise. Each accumulator integrates its channel the way the FPGA
+ * does: one oversampled and averaged value at a time, less the
+ * center, skipping values within the deadband.
+ *
+ * For replay, a reading can be held at a recorded value instead:
+ * the robot then reads exactly that, whatever it resets or the
+ * plant drives.
+ *
+ * Threadsafe; nothing here touches the virtual clock, so the
+ * plant may call it from the kernel's tick hook.
+ */
+class SimHardware {
+public:
+	static const uint32_t kAnalogChannels = 8;
+	static const uint32_t kDigitalChannels = 14;
+	static const uint32_t kPWMChannels = 10;
+	static const uint32_t kAccumulatorChannels = 2;
+	// samples per second per channel, and nanovolts per ADC count
+	static const uint32_t kSampleRate = 50000;
+	static const uint32_t kLSBWeight = 1220703;
+
+	static void setVoltage(uint32_t channel, double volts);
+	/**
+	 * The ADC reading of `channel`, in counts.
+	 */
+	static int16_t getValue(uint32_t channel);
+	static void setAverageBits(uint32_t channel, uint32_t bits);
+	static uint32_t getAverageBits(uint32_t channel);
+	static void setOversampleBits(uint32_t channel, uint32_t bits);
+	static uint32_t getOversampleBits(uint32_t channel);
+
+	static bool isAccumulatorChannel(uint32_t channel);
+	static void resetAccumulator(uint32_t channel, INT64 initial = 0);
+	static void setAccumulatorCenter(uint32_t channel, int32_t center);
+	static void setAccumulatorDeadband(uint32_t channel, int32_t deadband);
+	static void getAccumulator(uint32_t channel, INT64* value,
+			uint32_t* count);
+	/**
+	 * Run the accumulators over `seconds` at the present voltages.
+	 */
+	static void accumulate(double seconds);
+
+	/**
+	 * Inputs are pulled up, so read high until set. A rising edge
+	 * counts towards getEdges(), as do `edges` added by addEdges().
+	 */
+	static void setDigital(uint32_t channel, bool level);
+	static bool getDigital(uint32_t channel);
+	static void addEdges(uint32_t channel, uint32_t edges, double time);
+	static uint32_t getEdges(uint32_t channel);
+	/**
+	 * Seconds between the last two edges on `channel`.
+	 */
+	static double getEdgePeriod(uint32_t channel);
+
+	/**
+	 * Quadrature position, in cycles, of the encoder
+	 * whose A phase is on `channel`.
+	 */
+	static void setQuadrature(uint32_t channel, int32_t cycles, double rate);
+	static int32_t getQuadrature(uint32_t channel);
+	static double getQuadratureRate(uint32_t channel);
+
+	static void setDigitalOutput(uint32_t channel, bool level);
+	static bool getDigitalOutput(uint32_t channel);
+	static void setPWM(uint32_t channel, float position);
+	static float getPWM(uint32_t channel);
+
+	static void setBatteryVoltage(double volts);
+	static double getBatteryVoltage();
+
+	/**
+	 * Hold what getValue(), getAccumulator(), and Counter::Get() and
+	 * Encoder::Get() on the channel read, for replay.
+	 */
+	static void holdValue(uint32_t channel, int16_t value);
+	static void holdAccumulator(uint32_t channel, INT64 value, uint32_t count);
+	static void holdCount(uint32_t channel, int32_t count);
+	static bool getHeldCount(uint32_t channel, int32_t* count);
+	static void holdQuadrature(uint32_t channel, int32_t count);
+	static bool getHeldQuadrature(uint32_t channel, int32_t* count);
+};
+
+#endif
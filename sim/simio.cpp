@@ -0,0 +1,380 @@
+/**
+ * WPILib's analog and digital I/O, on the signals in SimHardware.
+ */
+#include "simhardware.h"
+#include "AnalogChannel.h"
+#include "AnalogModule.h"
+#include "DigitalInput.h"
+#include "DigitalModule.h"
+#include "DigitalOutput.h"
+#include "Counter.h"
+#include "Encoder.h"
+#include "Servo.h"
+#include <stdio.h>
+
+const uint8_t AnalogModule::kDefaultModule;
+
+AnalogModule::AnalogModule() {
+}
+
+AnalogModule* AnalogModule::GetInstance(uint8_t moduleNumber) {
+	static AnalogModule module;
+	return &module;
+}
+
+uint32_t AnalogModule::GetSampleRate() {
+	return SimHardware::kSampleRate;
+}
+
+uint32_t AnalogModule::GetLSBWeight(uint32_t channel) {
+	return SimHardware::kLSBWeight;
+}
+
+int32_t AnalogModule::GetOffset(uint32_t channel) {
+	return 0;
+}
+
+int16_t AnalogModule::GetValue(uint32_t channel) {
+	return SimHardware::getValue(channel);
+}
+
+int32_t AnalogModule::GetAverageValue(uint32_t channel) {
+	return SimHardware::getValue(channel);
+}
+
+DigitalModule::DigitalModule() {
+}
+
+DigitalModule* DigitalModule::GetInstance(uint8_t moduleNumber) {
+	static DigitalModule module;
+	return &module;
+}
+
+bool DigitalModule::GetDIO(uint32_t channel) {
+	return SimHardware::getDigital(channel);
+}
+
+uint16_t DigitalModule::GetDIO() {
+	uint16_t dio = 0;
+	for (uint32_t i = 1; i <= SimHardware::kDigitalChannels; i++) {
+		if (SimHardware::getDigital(i)) {
+			dio |= 1 << (16 - i);
+		}
+	}
+	return dio;
+}
+
+AnalogChannel::AnalogChannel(uint32_t channel) :
+	m_channel(channel), m_module(AnalogModule::GetInstance(
+			AnalogModule::kDefaultModule)) {
+	if (channel < 1 || channel > SimHardware::kAnalogChannels) {
+		printf("AnalogChannel: no channel %u\n", channel);
+	}
+}
+
+AnalogChannel::AnalogChannel(uint8_t moduleNumber, uint32_t channel) :
+	m_channel(channel), m_module(AnalogModule::GetInstance(moduleNumber)) {
+	if (channel < 1 || channel > SimHardware::kAnalogChannels) {
+		printf("AnalogChannel: no channel %u\n", channel);
+	}
+}
+
+AnalogChannel::~AnalogChannel() {
+}
+
+int16_t AnalogChannel::GetValue() {
+	return SimHardware::getValue(m_channel);
+}
+
+int32_t AnalogChannel::GetAverageValue() {
+	return SimHardware::getValue(m_channel);
+}
+
+float AnalogChannel::GetVoltage() {
+	return GetValue() * GetLSBWeight() * 1.0e-9 - GetOffset() * 1.0e-9;
+}
+
+float AnalogChannel::GetAverageVoltage() {
+	return GetAverageValue() * GetLSBWeight() * 1.0e-9 - GetOffset() * 1.0e-9;
+}
+
+uint32_t AnalogChannel::GetLSBWeight() {
+	return m_module->GetLSBWeight(m_channel);
+}
+
+int32_t AnalogChannel::GetOffset() {
+	return m_module->GetOffset(m_channel);
+}
+
+uint32_t AnalogChannel::GetChannel() {
+	return m_channel;
+}
+
+AnalogModule* AnalogChannel::GetModule() {
+	return m_module;
+}
+
+void AnalogChannel::SetAverageBits(uint32_t bits) {
+	SimHardware::setAverageBits(m_channel, bits);
+}
+
+uint32_t AnalogChannel::GetAverageBits() {
+	return SimHardware::getAverageBits(m_channel);
+}
+
+void AnalogChannel::SetOversampleBits(uint32_t bits) {
+	SimHardware::setOversampleBits(m_channel, bits);
+}
+
+uint32_t AnalogChannel::GetOversampleBits() {
+	return SimHardware::getOversampleBits(m_channel);
+}
+
+bool AnalogChannel::IsAccumulatorChannel() {
+	return SimHardware::isAccumulatorChannel(m_channel);
+}
+
+void AnalogChannel::InitAccumulator() {
+	SetAccumulatorCenter(0);
+	SetAccumulatorDeadband(0);
+	ResetAccumulator();
+}
+
+void AnalogChannel::SetAccumulatorInitialValue(INT64 value) {
+	SimHardware::resetAccumulator(m_channel, value);
+}
+
+void AnalogChannel::ResetAccumulator() {
+	SimHardware::resetAccumulator(m_channel);
+}
+
+void AnalogChannel::SetAccumulatorCenter(int32_t center) {
+	SimHardware::setAccumulatorCenter(m_channel, center);
+}
+
+void AnalogChannel::SetAccumulatorDeadband(int32_t deadband) {
+	SimHardware::setAccumulatorDeadband(m_channel, deadband);
+}
+
+INT64 AnalogChannel::GetAccumulatorValue() {
+	INT64 value;
+	uint32_t count;
+	SimHardware::getAccumulator(m_channel, &value, &count);
+	return value;
+}
+
+uint32_t AnalogChannel::GetAccumulatorCount() {
+	INT64 value;
+	uint32_t count;
+	SimHardware::getAccumulator(m_channel, &value, &count);
+	return count;
+}
+
+void AnalogChannel::GetAccumulatorOutput(INT64 *value, uint32_t *count) {
+	SimHardware::getAccumulator(m_channel, value, count);
+}
+
+DigitalSource::~DigitalSource() {
+}
+
+DigitalInput::DigitalInput(uint32_t channel) :
+	m_channel(channel) {
+	if (channel < 1 || channel > SimHardware::kDigitalChannels) {
+		printf("DigitalInput: no channel %u\n", channel);
+	}
+}
+
+DigitalInput::DigitalInput(uint8_t moduleNumber, uint32_t channel) :
+	m_channel(channel) {
+	if (channel < 1 || channel > SimHardware::kDigitalChannels) {
+		printf("DigitalInput: no channel %u\n", channel);
+	}
+}
+
+DigitalInput::~DigitalInput() {
+}
+
+uint32_t DigitalInput::Get() {
+	return SimHardware::getDigital(m_channel);
+}
+
+uint32_t DigitalInput::GetChannel() {
+	return m_channel;
+}
+
+uint32_t DigitalInput::GetChannelForRouting() {
+	return m_channel;
+}
+
+Counter::Counter(uint32_t channel) :
+	m_channel(channel), m_base(SimHardware::getEdges(channel)), m_stopped(0),
+			m_running(false), m_samplesToAverage(1) {
+}
+
+Counter::Counter(DigitalSource *source) :
+	m_channel(source->GetChannelForRouting()), m_base(0), m_stopped(0),
+			m_running(false), m_samplesToAverage(1) {
+	m_base = SimHardware::getEdges(m_channel);
+}
+
+Counter::~Counter() {
+}
+
+void Counter::Start() {
+	if (!m_running) {
+		m_base = SimHardware::getEdges(m_channel) - m_stopped;
+		m_running = true;
+	}
+}
+
+int32_t Counter::Get() {
+	int32_t held;
+	if (SimHardware::getHeldCount(m_channel, &held)) {
+		return held;
+	}
+	if (m_running) {
+		return (int32_t) (SimHardware::getEdges(m_channel) - m_base);
+	}
+	return m_stopped;
+}
+
+void Counter::Reset() {
+	m_base = SimHardware::getEdges(m_channel);
+	m_stopped = 0;
+}
+
+void Counter::Stop() {
+	if (m_running) {
+		m_stopped = Get();
+		m_running = false;
+	}
+}
+
+double Counter::GetPeriod() {
+	return SimHardware::getEdgePeriod(m_channel);
+}
+
+void Counter::SetSamplesToAverage(int samplesToAverage) {
+	m_samplesToAverage = samplesToAverage;
+}
+
+int Counter::GetSamplesToAverage() {
+	return m_samplesToAverage;
+}
+
+Encoder::Encoder(uint32_t aChannel, uint32_t bChannel, bool reverseDirection) :
+	m_aChannel(aChannel), m_reverseDirection(reverseDirection), m_base(0),
+			m_stopped(0), m_running(false) {
+	m_base = SimHardware::getQuadrature(m_aChannel);
+}
+
+Encoder::~Encoder() {
+}
+
+void Encoder::Start() {
+	if (!m_running) {
+		m_base = SimHardware::getQuadrature(m_aChannel) - m_stopped;
+		m_running = true;
+	}
+}
+
+int32_t Encoder::GetRaw() {
+	int32_t raw = m_stopped;
+	if (m_running) {
+		raw = SimHardware::getQuadrature(m_aChannel) - m_base;
+	}
+	return m_reverseDirection ? -raw : raw;
+}
+
+int32_t Encoder::Get() {
+	int32_t held;
+	if (SimHardware::getHeldQuadrature(m_aChannel, &held)) {
+		return held;
+	}
+	return GetRaw();
+}
+
+void Encoder::Reset() {
+	m_base = SimHardware::getQuadrature(m_aChannel);
+	m_stopped = 0;
+}
+
+void Encoder::Stop() {
+	if (m_running) {
+		m_stopped = SimHardware::getQuadrature(m_aChannel) - m_base;
+		m_running = false;
+	}
+}
+
+double Encoder::GetRate() {
+	if (!m_running) {
+		return 0.0;
+	}
+	double rate = SimHardware::getQuadratureRate(m_aChannel);
+	return m_reverseDirection ? -rate : rate;
+}
+
+DigitalOutput::DigitalOutput(uint32_t channel) :
+	m_channel(channel), m_pwm(false) {
+}
+
+DigitalOutput::~DigitalOutput() {
+}
+
+void DigitalOutput::Set(uint32_t value) {
+	SimHardware::setDigitalOutput(m_channel, value != 0);
+}
+
+uint32_t DigitalOutput::GetChannel() {
+	return m_channel;
+}
+
+void DigitalOutput::SetPWMRate(float rate) {
+}
+
+void DigitalOutput::EnablePWM(float initialDutyCycle) {
+	m_pwm = true;
+	UpdateDutyCycle(initialDutyCycle);
+}
+
+void DigitalOutput::DisablePWM() {
+	m_pwm = false;
+	SimHardware::setDigitalOutput(m_channel, false);
+}
+
+void DigitalOutput::UpdateDutyCycle(float dutyCycle) {
+	if (m_pwm) {
+		SimHardware::setDigitalOutput(m_channel, dutyCycle > 0.5);
+	}
+}
+
+Servo::Servo(uint32_t channel) :
+	m_channel(channel) {
+	if (channel < 1 || channel > SimHardware::kPWMChannels) {
+		printf("Servo: no PWM channel %u\n", channel);
+	}
+}
+
+Servo::~Servo() {
+}
+
+void Servo::Set(float value) {
+	SimHardware::setPWM(m_channel, (value < 0.0) ? 0.0 : ((value > 1.0) ? 1.0
+			: value));
+}
+
+float Servo::Get() {
+	return SimHardware::getPWM(m_channel);
+}
+
+// as the Hitec HS-322HD that WPILib assumes
+const float SERVO_MIN_ANGLE = 0.0;
+const float SERVO_MAX_ANGLE = 170.0;
+
+void Servo::SetAngle(float angle) {
+	Set((angle - SERVO_MIN_ANGLE) / (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE));
+}
+
+float Servo::GetAngle() {
+	return Get() * (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE) + SERVO_MIN_ANGLE;
+}
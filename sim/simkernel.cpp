@@ -0,0 +1,386 @@
+#include "simkernel.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <deque>
+#include <vector>
+
+/**
+ * A robot thread, as the kernel sees it.
+ */
+typedef struct {
+	pthread_cond_t cond;
+	const char* name;
+	// virtual time to wake at; negative if only a semaphore can
+	double wake;
+	// waiting for a wake-up, rather than to run
+	bool blocked;
+	// handed the semaphore it was waiting on
+	bool granted;
+	SEM_ID waiting_on;
+} Waiter;
+
+typedef enum {
+	kMutex, kBinary, kCounting
+} SemType;
+
+struct semaphore {
+	SemType type;
+	// free count; for a mutex, how many times the owner holds it
+	int count;
+	Waiter* owner;
+	std::deque<Waiter*> queue;
+};
+
+static pthread_mutex_t kernel_lock = PTHREAD_MUTEX_INITIALIZER;
+static double virtual_now = 0.0;
+// the one thread allowed to run; NULL before the main thread's
+// first call, or while a new thread is on its way
+static Waiter* holder = NULL;
+// woken, in order, waiting for their turn
+static std::deque<Waiter*> ready;
+// Tasks started but not yet attached
+static int starting = 0;
+static std::vector<Waiter*> threads;
+static SimKernel::TickHook tick_hook = NULL;
+static __thread Waiter* self = NULL;
+
+static double hostTime() {
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static const double host_start = hostTime();
+
+static Waiter* newWaiter(const char* name) {
+	Waiter* w = new Waiter;
+	pthread_cond_init(&w->cond, NULL);
+	w->name = name;
+	w->wake = -1.0;
+	w->blocked = false;
+	w->granted = false;
+	w->waiting_on = NULL;
+	threads.push_back(w);
+	return w;
+}
+
+/**
+ * The calling thread; a thread that did not come from a Task
+ * (the main thread) is attached on first use. Needs the lock.
+ */
+static Waiter* current() {
+	if (self == NULL) {
+		bool first = threads.empty();
+		self = newWaiter(first ? "main" : "(unattached)");
+		if (first) {
+			holder = self;
+		}
+	}
+	return self;
+}
+
+static void wake(Waiter* w) {
+	if (w->blocked) {
+		w->blocked = false;
+		ready.push_back(w);
+	}
+}
+
+static void deadlock() {
+	fprintf(stderr, "\nSimKernel: deadlock at %.6f s; every thread is blocked:\n",
+			virtual_now);
+	for (unsigned int i = 0; i < threads.size(); i++) {
+		fprintf(stderr, "\t%s, on semaphore %p\n", threads[i]->name,
+				(void*) threads[i]->waiting_on);
+	}
+	abort();
+}
+
+/**
+ * With no thread ready, move the clock to the next wake-up and
+ * wake everything due then, in the order the threads started.
+ */
+static void advance() {
+	double next = -1.0;
+	for (unsigned int i = 0; i < threads.size(); i++) {
+		Waiter* t = threads[i];
+		if (t->blocked && t->wake >= 0.0 && (next < 0.0 || t->wake < next)) {
+			next = t->wake;
+		}
+	}
+	if (next < 0.0) {
+		deadlock();
+	}
+	if (next > virtual_now) {
+		if (tick_hook != NULL) {
+			tick_hook(virtual_now, next);
+		}
+		virtual_now = next;
+	}
+	for (unsigned int i = 0; i < threads.size(); i++) {
+		Waiter* t = threads[i];
+		if (t->blocked && t->wake >= 0.0 && t->wake <= virtual_now) {
+			wake(t);
+		}
+	}
+}
+
+/**
+ * The running thread is done for now: let the next ready thread
+ * run, moving the clock on if none is. Needs the lock.
+ */
+static void dispatch() {
+	holder = NULL;
+	while (ready.empty()) {
+		if (starting > 0) {
+			// the new thread runs when it attaches
+			return;
+		}
+		advance();
+	}
+	holder = ready.front();
+	ready.pop_front();
+	pthread_cond_signal(&holder->cond);
+}
+
+/**
+ * Block the calling thread until it is woken, or until virtual
+ * time `deadline` if that is not negative, and then until its
+ * turn comes. Needs the lock.
+ */
+static void block(Waiter* w, double deadline) {
+	w->wake = deadline;
+	w->blocked = true;
+	dispatch();
+	while (holder != w) {
+		pthread_cond_wait(&w->cond, &kernel_lock);
+	}
+}
+
+double SimKernel::now() {
+	pthread_mutex_lock(&kernel_lock);
+	double t = virtual_now;
+	pthread_mutex_unlock(&kernel_lock);
+	return t;
+}
+
+void SimKernel::sleepUntil(double time) {
+	pthread_mutex_lock(&kernel_lock);
+	Waiter* w = current();
+	if (time > virtual_now) {
+		block(w, time);
+	}
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+static bool available(SEM_ID sem, Waiter* w) {
+	if (sem->type == kMutex) {
+		return sem->owner == NULL || sem->owner == w;
+	}
+	return sem->count > 0;
+}
+
+static void acquire(SEM_ID sem, Waiter* w) {
+	if (sem->type == kMutex) {
+		sem->owner = w;
+		sem->count++;
+	} else {
+		sem->count--;
+	}
+}
+
+/**
+ * Give `sem` to its first waiter, if it has one. Needs the lock.
+ */
+static bool handOff(SEM_ID sem) {
+	if (sem->queue.empty()) {
+		return false;
+	}
+	Waiter* w = sem->queue.front();
+	sem->queue.pop_front();
+	w->granted = true;
+	if (sem->type == kMutex) {
+		sem->owner = w;
+		sem->count = 1;
+	}
+	wake(w);
+	return true;
+}
+
+bool SimKernel::take(SEM_ID sem, double deadline) {
+	pthread_mutex_lock(&kernel_lock);
+	Waiter* w = current();
+	bool taken = true;
+	if (available(sem, w)) {
+		acquire(sem, w);
+	} else if (deadline >= 0.0 && deadline <= virtual_now) {
+		taken = false;
+	} else {
+		w->granted = false;
+		w->waiting_on = sem;
+		sem->queue.push_back(w);
+		block(w, deadline);
+		w->waiting_on = NULL;
+		taken = w->granted;
+		if (!taken) {
+			for (std::deque<Waiter*>::iterator i = sem->queue.begin(); i
+					!= sem->queue.end(); i++) {
+				if (*i == w) {
+					sem->queue.erase(i);
+					break;
+				}
+			}
+		}
+	}
+	pthread_mutex_unlock(&kernel_lock);
+	return taken;
+}
+
+void SimKernel::setTickHook(TickHook hook) {
+	pthread_mutex_lock(&kernel_lock);
+	tick_hook = hook;
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+double SimKernel::wallTime() {
+	return hostTime() - host_start;
+}
+
+void SimKernel::threadStarting() {
+	pthread_mutex_lock(&kernel_lock);
+	current();
+	starting++;
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+void SimKernel::threadFailed() {
+	pthread_mutex_lock(&kernel_lock);
+	starting--;
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+void SimKernel::threadAttach(const char* name) {
+	pthread_mutex_lock(&kernel_lock);
+	self = newWaiter(name);
+	starting--;
+	ready.push_back(self);
+	if (holder == NULL) {
+		dispatch();
+	}
+	while (holder != self) {
+		pthread_cond_wait(&self->cond, &kernel_lock);
+	}
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+void SimKernel::threadExit() {
+	pthread_mutex_lock(&kernel_lock);
+	for (unsigned int i = 0; i < threads.size(); i++) {
+		if (threads[i] == self) {
+			threads.erase(threads.begin() + i);
+			break;
+		}
+	}
+	pthread_cond_destroy(&self->cond);
+	delete self;
+	self = NULL;
+	dispatch();
+	pthread_mutex_unlock(&kernel_lock);
+}
+
+static SEM_ID semCreate(SemType type, int count) {
+	SEM_ID sem = new semaphore;
+	sem->type = type;
+	sem->count = count;
+	sem->owner = NULL;
+	return sem;
+}
+
+SEM_ID semMCreate(int options) {
+	return semCreate(kMutex, 0);
+}
+
+SEM_ID semBCreate(int options, SEM_B_STATE initialState) {
+	return semCreate(kBinary, initialState == SEM_FULL ? 1 : 0);
+}
+
+SEM_ID semCCreate(int options, int initialCount) {
+	return semCreate(kCounting, initialCount);
+}
+
+STATUS semTake(SEM_ID semId, int timeout) {
+	if (semId == NULL) {
+		return ERROR;
+	}
+	double deadline = -1.0;
+	if (timeout != WAIT_FOREVER) {
+		// the clock cannot move while this thread runs
+		deadline = SimKernel::now() + (double) timeout / SEM_CLOCK_RATE;
+	}
+	return SimKernel::take(semId, deadline) ? OK : ERROR;
+}
+
+STATUS semGive(SEM_ID semId) {
+	if (semId == NULL) {
+		return ERROR;
+	}
+	STATUS status = OK;
+	pthread_mutex_lock(&kernel_lock);
+	switch (semId->type) {
+	case kMutex:
+		if (semId->owner != current()) {
+			status = ERROR;
+		} else if (--semId->count == 0) {
+			semId->owner = NULL;
+			handOff(semId);
+		}
+		break;
+	case kBinary:
+		if (!handOff(semId)) {
+			semId->count = 1;
+		}
+		break;
+	case kCounting:
+		if (!handOff(semId)) {
+			semId->count++;
+		}
+		break;
+	}
+	pthread_mutex_unlock(&kernel_lock);
+	return status;
+}
+
+STATUS semFlush(SEM_ID semId) {
+	if (semId == NULL || semId->type == kMutex) {
+		return ERROR;
+	}
+	pthread_mutex_lock(&kernel_lock);
+	// every waiter's semTake returns OK, but none holds the semaphore
+	while (!semId->queue.empty()) {
+		Waiter* w = semId->queue.front();
+		semId->queue.pop_front();
+		w->granted = true;
+		wake(w);
+	}
+	pthread_mutex_unlock(&kernel_lock);
+	return OK;
+}
+
+STATUS semDelete(SEM_ID semId) {
+	if (semId == NULL) {
+		return ERROR;
+	}
+	pthread_mutex_lock(&kernel_lock);
+	bool waited_on = !semId->queue.empty();
+	pthread_mutex_unlock(&kernel_lock);
+	if (waited_on) {
+		// a waiter would be left blocked on freed memory
+		fprintf(stderr, "SimKernel: semaphore %p deleted while waited on\n",
+				(void*) semId);
+		return ERROR;
+	}
+	delete semId;
+	return OK;
+}
@@ -0,0 +1,65 @@
+#ifndef SIM_SIMKERNEL_H_
+#define SIM_SIMKERNEL_H_
+
+#include "semLib.h"
+
+/**
+ * The virtual clock of the host simulation.
+ *
+ * One robot thread (the main thread, or a Task) runs at a time,
+ * until it blocks: in Wait(), in semTake(), or for a CAN reply.
+ * Threads then take turns in the order they were woken; once none
+ * is ready, the clock jumps straight to the earliest wake-up. Time
+ * the robot spends asleep thus costs nothing on the host, and time
+ * it spends computing costs nothing on the virtual clock. Since the
+ * order never depends on the host's scheduler, a run with the same
+ * inputs always comes out the same.
+ *
+ * If every thread is blocked with nothing due to wake it, the robot
+ * has deadlocked: the simulation prints the blocked threads and
+ * aborts.
+ */
+class SimKernel {
+public:
+	/**
+	 * Called with the old and new time just before the clock moves,
+	 * while every thread is blocked. It must not call back into the
+	 * kernel (no GetTime(), Wait() or semaphores).
+	 */
+	typedef void (*TickHook)(double from, double to);
+
+	/**
+	 * Seconds of virtual time since the simulation started.
+	 */
+	static double now();
+	/**
+	 * Block until virtual time `time`.
+	 */
+	static void sleepUntil(double time);
+	/**
+	 * Take `sem`, waiting until virtual time `deadline` at the
+	 * latest (or forever, if `deadline` is negative). Returns
+	 * whether it was taken.
+	 */
+	static bool take(SEM_ID sem, double deadline);
+
+	static void setTickHook(TickHook hook);
+
+	/**
+	 * Seconds of host time since the simulation started.
+	 */
+	static double wallTime();
+
+	/**
+	 * Thread bookkeeping for Task: call threadStarting() before
+	 * creating the thread, and threadAttach() and threadExit()
+	 * first and last thing on it; or threadFailed() if it could
+	 * not be created.
+	 */
+	static void threadStarting();
+	static void threadFailed();
+	static void threadAttach(const char* name);
+	static void threadExit();
+};
+
+#endif
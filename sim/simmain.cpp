@@ -0,0 +1,63 @@
+// Runs the robot program on the host, against the simulated
+// plant, for one match on the virtual clock:
+//
+//   FLAGS="-std=gnu++11 -fpermissive -O2 -Isim/wpilib -Isim -Iutil -I."
+//   g++ $FLAGS -o yolosim *.cpp util/*.cpp sim/*.cpp -lpthread
+//   ./yolosim [autonomous_seconds teleop_seconds]
+//   ./yolosim tune <space> <output> [trials [jobs]]
+//   ./yolosim replay <log>
+//
+// from the top of the tree. The sim/wpilib headers stand in for
+// WPILib's; the robot code builds unchanged. -fpermissive accepts
+// the in-class double constants the robot's compiler takes; its
+// warnings about them are expected. Set SIM_LCD to see the driver
+// station LCD. For the tuner, see simtune.h; for replaying a log
+// recorded by InputLog, simreplay.h.
+#include "simkernel.h"
+#include "simmatch.h"
+#include "simphysics.h"
+#include "simcan.h"
+#include "simtune.h"
+#include "simreplay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" int32_t FRC_UserProgram_StartupLibraryInit();
+
+int main(int argc, char** argv) {
+	if (argc > 1 && strcmp(argv[1], "tune") == 0) {
+		return SimTune::main(argc - 2, argv + 2);
+	}
+	if (argc > 1 && strcmp(argv[1], "replay") == 0) {
+		return SimReplay::main(argc - 2, argv + 2);
+	}
+	double autonomous_time = SimMatch::kAutonomousTime;
+	double teleop_time = SimMatch::kTeleopTime;
+	if (argc == 3) {
+		autonomous_time = atof(argv[1]);
+		teleop_time = atof(argv[2]);
+	} else if (argc != 1) {
+		fprintf(stderr, "usage: %s [autonomous_seconds teleop_seconds]\n",
+				argv[0]);
+		return 2;
+	}
+
+	SimMatch::setup(autonomous_time, teleop_time);
+	SimPhysics::start();
+	FRC_UserProgram_StartupLibraryInit();
+
+	// let the robot settle into disabled after the match
+	SimKernel::sleepUntil(SimMatch::getEndTime() + 0.5);
+
+	double simulated = SimKernel::now();
+	double wall = SimKernel::wallTime();
+	SimPhysics::printState();
+	printf("[sim] %.1f s simulated in %.2f s (%.0fx real time), "
+		"%d CAN frames\n", simulated, wall, simulated / wall,
+			SimCAN::getFramesSent());
+	fflush(stdout);
+	// the robot's tasks never return; leave them blocked
+	_exit(0);
+}
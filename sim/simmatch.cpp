@@ -0,0 +1,132 @@
+#include "simmatch.h"
+#include "simkernel.h"
+
+constexpr double SimMatch::kDisabledTime;
+constexpr double SimMatch::kAutonomousTime;
+constexpr double SimMatch::kTeleopTime;
+constexpr double SimMatch::kArmRaiseTime;
+constexpr double SimMatch::kArmReleaseTime;
+const uint32_t SimMatch::kPorts;
+const uint32_t SimMatch::kAxes;
+
+// between autonomous and teleop, as on the field
+const double MODE_GAP = 1.0;
+
+/**
+ * Hold an axis at `value`, or press a button, from `start` to
+ * `end` seconds into teleop.
+ */
+typedef struct {
+	double start;
+	double end;
+	uint32_t port;
+	// 0 for a button
+	uint32_t axis;
+	uint32_t button;
+	float value;
+} Input;
+
+// ports, axes and buttons as in controls.cpp
+static const Input SCRIPT[] = {
+// drive forward, then turn in place
+		{ 1.0, 3.0, 1, 2, 0, 0.8 }, { 1.0, 3.0, 1, 5, 0, 0.8 },
+		{ 3.5, 4.5, 1, 2, 0, 0.6 }, { 3.5, 4.5, 1, 5, 0, -0.6 },
+		// raise the arm, open the guards for a high shot, and kick
+		{ 5.0, 9.0, 2, 0, 4, 1.0 }, { 6.5, 8.0, 2, 6, 0, 1.0 },
+		{ 7.0, 7.2, 2, 0, 2, 1.0 },
+		// lower the arm and take in a ball
+		{ 10.0, 11.5, 2, 2, 0, 0.5 }, { 10.0, 13.0, 2, 0, 5, 1.0 },
+		// and raise it from the floor with the ball
+		{ SimMatch::kArmRaiseTime, SimMatch::kArmReleaseTime, 2, 0, 4, 1.0 } };
+static const int SCRIPT_LENGTH = sizeof(SCRIPT) / sizeof(SCRIPT[0]);
+
+static double autonomous_start = SimMatch::kDisabledTime;
+static double teleop_start = autonomous_start + SimMatch::kAutonomousTime
+		+ MODE_GAP;
+static double match_end = teleop_start + SimMatch::kTeleopTime;
+static const SimMatch::Inputs* replaying = NULL;
+static double replay_start = -1.0;
+
+void SimMatch::setup(double autonomous_time, double teleop_time) {
+	autonomous_start = kDisabledTime;
+	teleop_start = autonomous_start + autonomous_time + MODE_GAP;
+	match_end = teleop_start + teleop_time;
+}
+
+SimMatch::Mode SimMatch::getMode() {
+	if (replaying != NULL) {
+		if (replay_start < 0.0) {
+			replay_start = SimKernel::now();
+		}
+		return replaying->mode;
+	}
+	return getModeAt(SimKernel::now());
+}
+
+SimMatch::Mode SimMatch::getModeAt(double t) {
+	if (t >= autonomous_start && t < teleop_start - MODE_GAP) {
+		return kAutonomous;
+	}
+	if (t >= teleop_start && t < match_end) {
+		return kTeleop;
+	}
+	return kDisabled;
+}
+
+double SimMatch::getAutonomousStart() {
+	return autonomous_start;
+}
+
+double SimMatch::getTeleopStart() {
+	return teleop_start;
+}
+
+double SimMatch::getEndTime() {
+	return match_end;
+}
+
+float SimMatch::getAxis(uint32_t port, uint32_t axis) {
+	if (replaying != NULL) {
+		return replaying->axes[port - 1][axis - 1];
+	}
+	if (getMode() != kTeleop) {
+		return 0.0;
+	}
+	double t = SimKernel::now() - teleop_start;
+	float value = 0.0;
+	for (int i = 0; i < SCRIPT_LENGTH; i++) {
+		const Input& in = SCRIPT[i];
+		if (in.port == port && in.axis == axis && in.axis != 0 && t
+				>= in.start && t < in.end) {
+			value = in.value;
+		}
+	}
+	return value;
+}
+
+short SimMatch::getButtons(uint32_t port) {
+	if (replaying != NULL) {
+		return replaying->buttons[port - 1];
+	}
+	if (getMode() != kTeleop) {
+		return 0;
+	}
+	double t = SimKernel::now() - teleop_start;
+	short buttons = 0;
+	for (int i = 0; i < SCRIPT_LENGTH; i++) {
+		const Input& in = SCRIPT[i];
+		if (in.port == port && in.axis == 0 && t >= in.start && t < in.end) {
+			buttons |= 1 << (in.button - 1);
+		}
+	}
+	return buttons;
+}
+
+void SimMatch::replay(const Inputs* inputs) {
+	replaying = inputs;
+	replay_start = -1.0;
+}
+
+double SimMatch::getReplayStart() {
+	return replay_start;
+}
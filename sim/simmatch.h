@@ -0,0 +1,76 @@
+#ifndef SIM_SIMMATCH_H_
+#define SIM_SIMMATCH_H_
+
+#include "vxWorks.h"
+
+/**
+ * The field and the drivers: a match laid out on the virtual clock,
+ * and scripted joystick input during teleop.
+ *
+ * The match runs disabled, autonomous, disabled, teleop, and then
+ * stays disabled, as the robot would sit after a real match. The
+ * teleop script drives forward and turns, raises the arm, kicks,
+ * lowers the arm and runs the roller in, and then raises the
+ * arm again.
+ *
+ * For replay, the mode and the joysticks can come from a
+ * recording instead.
+ */
+class SimMatch {
+public:
+	typedef enum {
+		kDisabled, kAutonomous, kTeleop
+	} Mode;
+
+	static constexpr double kDisabledTime = 3.0;
+	static constexpr double kAutonomousTime = 10.0;
+	static constexpr double kTeleopTime = 20.0;
+	/**
+	 * Seconds into teleop when the script raises the arm from the
+	 * floor for the second time, and when it lets go; long enough
+	 * for the lift to settle.
+	 */
+	static constexpr double kArmRaiseTime = 14.0;
+	static constexpr double kArmReleaseTime = 18.0;
+
+	static void setup(double autonomous_time, double teleop_time);
+	static Mode getMode();
+	/**
+	 * The mode at virtual time `time`; does not read the clock,
+	 * so the plant may call it from the kernel's tick hook.
+	 */
+	static Mode getModeAt(double time);
+	/**
+	 * Virtual times when autonomous and teleop begin, and
+	 * when the final disabled period begins.
+	 */
+	static double getAutonomousStart();
+	static double getTeleopStart();
+	static double getEndTime();
+
+	/**
+	 * Joystick state; ports, axes and buttons count from 1.
+	 */
+	static float getAxis(uint32_t port, uint32_t axis);
+	static short getButtons(uint32_t port);
+
+	static const uint32_t kPorts = 4;
+	static const uint32_t kAxes = 6;
+	typedef struct {
+		Mode mode;
+		float axes[kPorts][kAxes];
+		short buttons[kPorts];
+	} Inputs;
+	/**
+	 * Take getMode() and the joysticks from `inputs` from now on.
+	 * It stays the caller's, who may change it from the tick hook.
+	 */
+	static void replay(const Inputs* inputs);
+	/**
+	 * Virtual time the robot first asked for the mode since
+	 * replay(), or negative if it has not yet.
+	 */
+	static double getReplayStart();
+};
+
+#endif
@@ -0,0 +1,401 @@
+/**
+ * WPILib's timing, tasks, notifiers and error reporting,
+ * on the simulation's virtual clock.
+ */
+#include "simkernel.h"
+#include "Timer.h"
+#include "Task.h"
+#include "Notifier.h"
+#include "Utility.h"
+#include "MotorSafetyHelper.h"
+#include "Synchronized.h"
+#include "taskLib.h"
+#include <stdio.h>
+#include <time.h>
+
+double GetTime() {
+	return SimKernel::now();
+}
+
+void Wait(double seconds) {
+	if (seconds > 0.0) {
+		SimKernel::sleepUntil(SimKernel::now() + seconds);
+	}
+}
+
+uint32_t GetFPGATime() {
+	return (uint32_t) (INT64) (SimKernel::now() * 1e6);
+}
+
+Timer::Timer() :
+	m_startTime(GetTime()), m_accumulatedTime(0.0), m_running(false) {
+}
+
+Timer::~Timer() {
+}
+
+double Timer::Get() {
+	if (m_running) {
+		return m_accumulatedTime + (GetTime() - m_startTime);
+	}
+	return m_accumulatedTime;
+}
+
+void Timer::Reset() {
+	m_accumulatedTime = 0.0;
+	m_startTime = GetTime();
+}
+
+void Timer::Start() {
+	if (!m_running) {
+		m_startTime = GetTime();
+		m_running = true;
+	}
+}
+
+void Timer::Stop() {
+	if (m_running) {
+		m_accumulatedTime = Get();
+		m_running = false;
+	}
+}
+
+bool Timer::HasPeriodPassed(double period) {
+	if (Get() > period) {
+		m_startTime += period;
+		return true;
+	}
+	return false;
+}
+
+double Timer::GetFPGATimestamp() {
+	return GetTime();
+}
+
+double Timer::GetPPCTimestamp() {
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+Error::Error() :
+	m_code(0) {
+}
+
+Error::Code Error::GetCode() const {
+	return m_code;
+}
+
+const char* Error::GetMessage() const {
+	return m_message.c_str();
+}
+
+void Error::Set(Code code, const char* contextMessage, const char* filename,
+		const char* function, uint32_t lineNumber) {
+	m_code = code;
+	m_message = contextMessage;
+	printf("%s: %s (%d) in %s() in %s at line %u\n", (code < 0) ? "ERROR"
+			: "WARNING", contextMessage, (int) code, function, filename,
+			lineNumber);
+}
+
+void Error::Clear() {
+	m_code = 0;
+	m_message = "";
+}
+
+ErrorBase::ErrorBase() {
+}
+
+ErrorBase::~ErrorBase() {
+}
+
+Error& ErrorBase::GetError() {
+	return m_error;
+}
+
+const Error& ErrorBase::GetError() const {
+	return m_error;
+}
+
+void ErrorBase::SetError(Error::Code code, const char* contextMessage,
+		const char* filename, const char* function, uint32_t lineNumber) const {
+	if (code != 0) {
+		m_error.Set(code, contextMessage, filename, function, lineNumber);
+	}
+}
+
+void ErrorBase::SetWPIError(const char* errorMessage, Error::Code code,
+		const char* contextMessage, const char* filename,
+		const char* function, uint32_t lineNumber) const {
+	std::string message = std::string(errorMessage) + ": " + contextMessage;
+	m_error.Set(code, message.c_str(), filename, function, lineNumber);
+}
+
+void ErrorBase::ClearError() const {
+	m_error.Clear();
+}
+
+bool ErrorBase::StatusIsFatal() const {
+	return m_error.GetCode() < 0;
+}
+
+void ErrorBase::SetGlobalWPIError(const char* errorMessage, Error::Code code,
+		const char* contextMessage, const char* filename,
+		const char* function, uint32_t lineNumber) {
+	std::string message = std::string(errorMessage) + ": " + contextMessage;
+	GetGlobalError().Set(code, message.c_str(), filename, function, lineNumber);
+}
+
+Error& ErrorBase::GetGlobalError() {
+	static Error global;
+	return global;
+}
+
+const uint32_t Task::kDefaultPriority;
+
+static __thread int task_id = 0;
+static int last_task_id = 0;
+
+int taskIdSelf() {
+	if (task_id == 0) {
+		task_id = __sync_add_and_fetch(&last_task_id, 1);
+	}
+	return task_id;
+}
+
+typedef struct {
+	Task* task;
+	FUNCPTR function;
+	uint32_t args[10];
+} TaskStart;
+
+Task::Task(const char* name, FUNCPTR function, int32_t priority,
+		uint32_t stackSize) :
+	m_function(function), m_taskName(name), m_priority(priority),
+			m_started(false) {
+}
+
+Task::~Task() {
+	Stop();
+}
+
+bool Task::Start(uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3,
+		uint32_t arg4, uint32_t arg5, uint32_t arg6, uint32_t arg7,
+		uint32_t arg8, uint32_t arg9) {
+	TaskStart* start = new TaskStart;
+	start->task = this;
+	start->function = m_function;
+	uint32_t args[10] = { arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7,
+			arg8, arg9 };
+	for (int i = 0; i < 10; i++) {
+		start->args[i] = args[i];
+	}
+
+	SimKernel::threadStarting();
+	if (pthread_create(&m_thread, NULL, Task::Run, start) != 0) {
+		printf("Task %s: could not start a thread\n", m_taskName.c_str());
+		SimKernel::threadFailed();
+		delete start;
+		return false;
+	}
+	m_started = true;
+	return true;
+}
+
+void* Task::Run(void* arg) {
+	TaskStart* start = (TaskStart*) arg;
+	SimKernel::threadAttach(start->task->GetName());
+	uint32_t* a = start->args;
+	start->function(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9]);
+	delete start;
+	SimKernel::threadExit();
+	return NULL;
+}
+
+bool Task::Stop() {
+	if (m_started) {
+		pthread_detach(m_thread);
+		m_started = false;
+	}
+	return true;
+}
+
+bool Task::IsReady() {
+	return m_started;
+}
+
+int32_t Task::GetPriority() {
+	return m_priority;
+}
+
+bool Task::SetPriority(int32_t priority) {
+	m_priority = priority;
+	return true;
+}
+
+const char* Task::GetName() {
+	return m_taskName.c_str();
+}
+
+Notifier *Notifier::timerQueueHead = NULL;
+SEM_ID Notifier::queueSemaphore = NULL;
+SEM_ID Notifier::wakeup = NULL;
+Task *Notifier::task = NULL;
+
+Notifier::Notifier(TimerEventHandler handler, void *param) :
+	m_handler(handler), m_param(param), m_period(0.0), m_expirationTime(0.0),
+			m_nextEvent(NULL), m_periodic(false), m_queued(false) {
+	m_handlerSemaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+	if (queueSemaphore == NULL) {
+		queueSemaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+		wakeup = semBCreate(SEM_Q_FIFO, SEM_EMPTY);
+		task = new Task("Notifier", (FUNCPTR) Notifier::ProcessQueue);
+		task->Start();
+	}
+}
+
+Notifier::~Notifier() {
+	Stop();
+	semDelete(m_handlerSemaphore);
+}
+
+int Notifier::ProcessQueue() {
+	while (true) {
+		double deadline = -1.0;
+		{
+			Synchronized sync(queueSemaphore);
+			if (timerQueueHead != NULL) {
+				deadline = timerQueueHead->m_expirationTime;
+			}
+		}
+		// woken early when an earlier event is queued
+		SimKernel::take(wakeup, deadline);
+
+		while (true) {
+			Notifier *current;
+			{
+				Synchronized sync(queueSemaphore);
+				current = timerQueueHead;
+				if (current == NULL || current->m_expirationTime > GetTime()) {
+					break;
+				}
+				timerQueueHead = current->m_nextEvent;
+				if (current->m_periodic) {
+					current->InsertInQueue(true);
+				} else {
+					current->m_queued = false;
+				}
+				semTake(current->m_handlerSemaphore, WAIT_FOREVER);
+			}
+			current->m_handler(current->m_param);
+			semGive(current->m_handlerSemaphore);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Queue in expiration order; `reschedule` counts from the last
+ * expiration rather than now, so periodic events do not drift.
+ * Needs the queue semaphore.
+ */
+void Notifier::InsertInQueue(bool reschedule) {
+	if (reschedule) {
+		m_expirationTime += m_period;
+	} else {
+		m_expirationTime = GetTime() + m_period;
+	}
+	if (timerQueueHead == NULL || timerQueueHead->m_expirationTime
+			>= m_expirationTime) {
+		m_nextEvent = timerQueueHead;
+		timerQueueHead = this;
+		if (!reschedule) {
+			semGive(wakeup);
+		}
+	} else {
+		Notifier **npp = &(timerQueueHead->m_nextEvent);
+		while (*npp != NULL && (*npp)->m_expirationTime <= m_expirationTime) {
+			npp = &((*npp)->m_nextEvent);
+		}
+		m_nextEvent = *npp;
+		*npp = this;
+	}
+	m_queued = true;
+}
+
+/**
+ * Needs the queue semaphore.
+ */
+void Notifier::DeleteFromQueue() {
+	if (m_queued) {
+		m_queued = false;
+		if (timerQueueHead == this) {
+			timerQueueHead = m_nextEvent;
+		} else {
+			for (Notifier *n = timerQueueHead; n != NULL; n = n->m_nextEvent) {
+				if (n->m_nextEvent == this) {
+					n->m_nextEvent = m_nextEvent;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void Notifier::StartSingle(double delay) {
+	Synchronized sync(queueSemaphore);
+	m_periodic = false;
+	m_period = delay;
+	DeleteFromQueue();
+	InsertInQueue(false);
+}
+
+void Notifier::StartPeriodic(double period) {
+	Synchronized sync(queueSemaphore);
+	m_periodic = true;
+	m_period = period;
+	DeleteFromQueue();
+	InsertInQueue(false);
+}
+
+void Notifier::Stop() {
+	{
+		Synchronized sync(queueSemaphore);
+		DeleteFromQueue();
+	}
+	// wait for a handler that is already running
+	Synchronized sync(m_handlerSemaphore);
+}
+
+MotorSafetyHelper::MotorSafetyHelper(MotorSafety *safeObject) :
+	m_expiration(DEFAULT_SAFETY_EXPIRATION), m_enabled(false),
+			m_stopTime(GetTime()), m_safeObject(safeObject) {
+}
+
+MotorSafetyHelper::~MotorSafetyHelper() {
+}
+
+void MotorSafetyHelper::Feed() {
+	m_stopTime = GetTime() + m_expiration;
+}
+
+void MotorSafetyHelper::SetExpiration(float expirationTime) {
+	m_expiration = expirationTime;
+}
+
+float MotorSafetyHelper::GetExpiration() {
+	return m_expiration;
+}
+
+bool MotorSafetyHelper::IsAlive() {
+	return !m_enabled || m_stopTime > GetTime();
+}
+
+void MotorSafetyHelper::SetSafetyEnabled(bool enabled) {
+	m_enabled = enabled;
+}
+
+bool MotorSafetyHelper::IsSafetyEnabled() {
+	return m_enabled;
+}
@@ -0,0 +1,289 @@
+#include "simphysics.h"
+#include "simkernel.h"
+#include "simhardware.h"
+#include "simcan.h"
+#include "simmatch.h"
+#include "iomap.h"
+#include <math.h>
+#include <stdio.h>
+
+constexpr double SimPhysics::kStep;
+
+// Intake arm; location runs from 0 (down) to 1 (up), and
+// a negative output raises it
+const double ARM_START = 0.3;
+const double ARM_MIN = -0.05;
+const double ARM_MAX = 1.05;
+const double ARM_LOW_FORCE = 0.10;
+const double ARM_LOW_ZERO = 0.50;
+const double ARM_HIGH_ZERO = 0.65;
+const double ARM_HIGH_FORCE = -0.07;
+const double ARM_STATIC_FRICTION = 0.2;
+const double ARM_DYNAMIC_FRICTION = 0.1;
+// per second: the speed at which back-EMF cancels full output,
+// and the acceleration of a unit of force
+const double ARM_FREE_SPEED = 1.5;
+const double ARM_ACCEL = 6.0;
+// volts at the bottom and top, as in intake.cpp
+const double POT_LOW = 2.34;
+const double POT_HIGH = 1.33;
+const double ALT_POT_LOW = 2.7949;
+const double ALT_POT_HIGH = 2.138;
+
+// Kicker, in encoder cycles from rest
+const double KICK_ACCEL = 8000.0; // cycles/s^2 at full output
+const double KICK_TAU = 0.1; // s
+const double KICK_GRAVITY = 400.0; // cycles/s^2
+const double KICK_TRAVEL = 130.0;
+const double KICK_HIGH_FLAG = 100.0;
+const double KICK_LOW_FLAG_START = 2.0;
+const double KICK_LOW_FLAG_END = 6.0;
+const double KICK_BALL_GONE = 30.0;
+const double ROLLER_LOAD_TIME = 0.5; // s, rolling in with the arm down
+
+// Drivetrain
+const double DRIVE_MAX_SPEED = 150.0; // in/s
+const double DRIVE_TAU = 0.2; // s
+const double DRIVE_IN_PER_TICK = 0.0342727272727273;
+const double DRIVE_TRACK_WIDTH = 24.0; // in
+
+const double GYRO_ZERO = 2.5; // volts
+const double GYRO_SENSITIVITY = 0.007; // volts per degree/s
+
+const double BATTERY_VOLTAGE = 12.5;
+const double BATTERY_RESISTANCE = 0.015; // ohms
+const double STALL_CURRENT = 40.0; // amps per motor
+const double IDLE_CURRENT = 0.5;
+
+static const uint8_t KICKER_JAGS[] = { CANID_KICKER_LEFT_FRONT,
+		CANID_KICKER_LEFT_MID, CANID_KICKER_LEFT_BACK,
+		CANID_KICKER_RIGHT_FRONT, CANID_KICKER_RIGHT_MID,
+		CANID_KICKER_RIGHT_BACK };
+static const int NUM_KICKER_JAGS = sizeof(KICKER_JAGS)
+		/ sizeof(KICKER_JAGS[0]);
+
+static double arm_loc = ARM_START;
+static double arm_vel = 0.0;
+static double arm_out = 0.0;
+static double kick_pos = 0.0;
+static double kick_vel = 0.0;
+static double kick_out = 0.0;
+static bool ball = true;
+static double roller_time = 0.0;
+static double roller_out = 0.0;
+static double left_vel = 0.0;
+static double right_vel = 0.0;
+static double left_ticks = 0.0;
+static double right_ticks = 0.0;
+static double left_out = 0.0;
+static double right_out = 0.0;
+static double heading = 0.0;
+static double left_distance = 0.0;
+static double right_distance = 0.0;
+static int kicks = 0;
+static double last_kick_time = -1.0;
+
+static double sign(double x) {
+	return (x > 0.0) ? 1.0 : ((x < 0.0) ? -1.0 : 0.0);
+}
+
+static double armField(double loc) {
+	if (loc < ARM_LOW_ZERO) {
+		return ARM_LOW_FORCE * (ARM_LOW_ZERO - loc) / ARM_LOW_ZERO;
+	}
+	if (loc > ARM_HIGH_ZERO) {
+		return ARM_HIGH_FORCE * (loc - ARM_HIGH_ZERO) / (1.0 - ARM_HIGH_ZERO);
+	}
+	return 0.0;
+}
+
+static double motorCurrent(double out, double speed) {
+	return IDLE_CURRENT + STALL_CURRENT * fabs(out) * (1.0 - fabs(speed));
+}
+
+static void stepArm(double dt) {
+	// the controller's sign: positive raises
+	double force = -arm_out - arm_vel / ARM_FREE_SPEED + armField(arm_loc);
+	if (arm_vel != 0.0 || fabs(force) > ARM_STATIC_FRICTION) {
+		double dir = (arm_vel != 0.0) ? sign(arm_vel) : sign(force);
+		double v = arm_vel + ARM_ACCEL * (force - dir * ARM_DYNAMIC_FRICTION)
+				* dt;
+		// friction can stop the arm, but not reverse it
+		arm_vel = (sign(v) == -dir) ? 0.0 : v;
+	}
+	arm_loc += arm_vel * dt;
+	if (arm_loc < ARM_MIN || arm_loc > ARM_MAX) {
+		arm_loc = (arm_loc < ARM_MIN) ? ARM_MIN : ARM_MAX;
+		arm_vel = 0.0;
+	}
+}
+
+static void stepKicker(double time, double dt) {
+	double acc = KICK_ACCEL * kick_out - kick_vel / KICK_TAU;
+	if (kick_pos > 0.0) {
+		acc -= KICK_GRAVITY;
+	}
+	kick_vel += acc * dt;
+	kick_pos += kick_vel * dt;
+	if (kick_pos <= 0.0 && kick_vel < 0.0) {
+		kick_pos = 0.0;
+		kick_vel = 0.0;
+	} else if (kick_pos >= KICK_TRAVEL && kick_vel > 0.0) {
+		kick_pos = KICK_TRAVEL;
+		kick_vel = 0.0;
+	}
+
+	if (kick_pos > KICK_BALL_GONE && ball) {
+		ball = false;
+		kicks++;
+		last_kick_time = time;
+	}
+	if (roller_out > 0.3 && arm_loc < 0.2) {
+		roller_time += dt;
+		if (roller_time > ROLLER_LOAD_TIME) {
+			ball = true;
+		}
+	} else {
+		roller_time = 0.0;
+	}
+}
+
+static void stepDrive(double time, double dt) {
+	left_vel += (DRIVE_MAX_SPEED * left_out - left_vel) * dt / DRIVE_TAU;
+	right_vel += (DRIVE_MAX_SPEED * right_out - right_vel) * dt / DRIVE_TAU;
+	left_distance += left_vel * dt;
+	right_distance += right_vel * dt;
+
+	// the counters see one edge per tick, whichever way the wheels turn
+	left_ticks += fabs(left_vel) * dt / DRIVE_IN_PER_TICK;
+	right_ticks += fabs(right_vel) * dt / DRIVE_IN_PER_TICK;
+	uint32_t left_edges = (uint32_t) left_ticks;
+	uint32_t right_edges = (uint32_t) right_ticks;
+	left_ticks -= left_edges;
+	right_ticks -= right_edges;
+	SimHardware::addEdges(DIG_DRIVE_ENCODER_LEFT_B, left_edges, time);
+	SimHardware::addEdges(DIG_DRIVE_ENCODER_RIGHT_A, right_edges, time);
+
+	heading += (right_vel - left_vel) / DRIVE_TRACK_WIDTH * dt;
+}
+
+void SimPhysics::start() {
+	publish(0.0);
+	SimKernel::setTickHook(SimPhysics::tick);
+}
+
+void SimPhysics::printState() {
+	printf("[sim] arm %5.3f kicker %5.1f ball %d drive %6.1f %6.1f in/s "
+		"heading %6.1f deg\n", arm_loc, kick_pos, ball, left_vel, right_vel,
+			heading * 180.0 / M_PI);
+}
+
+SimPhysics::State SimPhysics::getState() {
+	State state;
+	state.arm = arm_loc;
+	state.arm_velocity = arm_vel;
+	state.kicker = kick_pos;
+	state.ball = ball;
+	state.kicks = kicks;
+	state.last_kick_time = last_kick_time;
+	state.left_distance = left_distance;
+	state.right_distance = right_distance;
+	state.left_speed = left_vel;
+	state.right_speed = right_vel;
+	state.heading = heading;
+	return state;
+}
+
+void SimPhysics::tick(double from, double to) {
+	for (double t = from; t < to; t += kStep) {
+		double dt = (to - t < kStep) ? to - t : kStep;
+		step(t + dt, dt);
+	}
+	publish(to);
+}
+
+void SimPhysics::step(double time, double dt) {
+	bool enabled = SimMatch::getModeAt(time) != SimMatch::kDisabled;
+
+	arm_out = enabled ? SimCAN::getOutput(CANID_INTAKE_LIFT) : 0.0;
+	roller_out = enabled ? SimCAN::getOutput(CANID_INTAKE_ROLLER) : 0.0;
+
+	kick_out = 0.0;
+	if (enabled) {
+		for (int i = 0; i < NUM_KICKER_JAGS; i++) {
+			double out = SimCAN::getOutput(KICKER_JAGS[i]);
+			// the high flag is this Jaguar's forward limit
+			if (KICKER_JAGS[i] == CANID_KICKER_LEFT_BACK && out > 0.0
+					&& kick_pos >= KICK_HIGH_FLAG) {
+				out = 0.0;
+			}
+			kick_out += out / NUM_KICKER_JAGS;
+		}
+	}
+
+	left_out = 0.0;
+	right_out = 0.0;
+	if (enabled) {
+		left_out = (SimCAN::getOutput(CANID_DRIVE_LEFT_FRONT)
+				+ SimCAN::getOutput(CANID_DRIVE_LEFT_REAR)) / 2.0;
+		// the right side is mounted the other way round
+		right_out = -(SimCAN::getOutput(CANID_DRIVE_RIGHT_FRONT)
+				+ SimCAN::getOutput(CANID_DRIVE_RIGHT_REAR)) / 2.0;
+	}
+
+	stepArm(dt);
+	stepKicker(time, dt);
+	stepDrive(time, dt);
+
+	// the low flag window is narrow enough to skip over between ticks
+	SimHardware::setDigital(DIG_KICKER_LOW_FLAG, !(kick_pos
+			>= KICK_LOW_FLAG_START && kick_pos < KICK_LOW_FLAG_END));
+	// the gyro voltage in force over this step
+	double rate = (right_vel - left_vel) / DRIVE_TRACK_WIDTH * 180.0 / M_PI;
+	SimHardware::setVoltage(ANALOG_GYRO, GYRO_ZERO + rate * GYRO_SENSITIVITY);
+	SimHardware::accumulate(dt);
+}
+
+void SimPhysics::publish(double time) {
+	SimHardware::setVoltage(ANALOG_INTAKE_POT_1, POT_LOW + arm_loc * (POT_HIGH
+			- POT_LOW));
+	SimHardware::setVoltage(ANALOG_INTAKE_ALT_POT, ALT_POT_LOW + arm_loc
+			* (ALT_POT_HIGH - ALT_POT_LOW));
+	SimHardware::setDigital(DIG_INTAKE_BALL_SENSOR, ball);
+
+	// the encoder counts down as the kicker swings up
+	SimHardware::setQuadrature(DIG_KICKER_ENCODER_A,
+			(int32_t) floor(-kick_pos + 0.5), -kick_vel);
+	bool high_ok = kick_pos < KICK_HIGH_FLAG;
+	SimHardware::setDigital(DIG_KICKER_HIGH_FLAG, high_ok);
+	SimCAN::setLimits(CANID_KICKER_LEFT_BACK, high_ok, true);
+
+	double kick_speed = kick_vel / (KICK_ACCEL * KICK_TAU);
+	double total = 0.0;
+	for (int i = 0; i < NUM_KICKER_JAGS; i++) {
+		double amps = motorCurrent(kick_out, kick_speed);
+		SimCAN::setCurrent(KICKER_JAGS[i], amps);
+		total += amps;
+	}
+	double amps = motorCurrent(arm_out, arm_vel);
+	SimCAN::setCurrent(CANID_INTAKE_LIFT, amps);
+	total += amps;
+	amps = motorCurrent(roller_out, 0.0);
+	SimCAN::setCurrent(CANID_INTAKE_ROLLER, amps);
+	total += amps;
+	amps = motorCurrent(left_out, left_vel / DRIVE_MAX_SPEED);
+	SimCAN::setCurrent(CANID_DRIVE_LEFT_FRONT, amps);
+	SimCAN::setCurrent(CANID_DRIVE_LEFT_REAR, amps);
+	total += 2 * amps;
+	amps = motorCurrent(right_out, right_vel / DRIVE_MAX_SPEED);
+	SimCAN::setCurrent(CANID_DRIVE_RIGHT_FRONT, amps);
+	SimCAN::setCurrent(CANID_DRIVE_RIGHT_REAR, amps);
+	total += 2 * amps;
+
+	double battery = BATTERY_VOLTAGE - BATTERY_RESISTANCE * total;
+	SimHardware::setBatteryVoltage(battery);
+	for (uint8_t device = CANID_DRIVE_LEFT_FRONT; device
+			<= CANID_INTAKE_LIFT; device++) {
+		SimCAN::setBusVoltage(device, battery);
+	}
+}
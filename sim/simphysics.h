@@ -0,0 +1,67 @@
+#ifndef SIM_SIMPHYSICS_H_
+#define SIM_SIMPHYSICS_H_
+
+/**
+ * Plant models for the robot, integrated on the virtual clock (in
+ * steps of at most kStep) whenever the kernel advances it. Each
+ * reads its Jaguars' outputs from the CAN bus and drives the
+ * sensors in SimHardware. Jaguars are stopped while the robot
+ * is disabled, as the field would stop them.
+ *
+ * - Intake arm: the armbench plant. The output plus a position
+ *   dependent force (held up near the floor, pulled down near the
+ *   top) accelerates the arm, less static and dynamic friction and
+ *   the motor's back-EMF, which limits its speed. Drives both pots.
+ * - Kicker: six motors spin it up against gravity, from a hard stop
+ *   at rest. Drives the encoder, the low flag (a narrow window just
+ *   above rest, active low), and the high flag (the forward limit of
+ *   the left back Jaguar, which then refuses to drive forward).
+ *   The ball leaves the beam break once the kicker swings through;
+ *   running the roller in with the arm down brings one back.
+ * - Drivetrain: first order wheel speeds on each side; drives the
+ *   drive encoder counters and the gyro's rate voltage.
+ */
+class SimPhysics {
+public:
+	static constexpr double kStep = 0.001;
+
+	typedef struct {
+		// arm location, 0 (down) to 1 (up), and per second
+		double arm;
+		double arm_velocity;
+		// kicker position, in encoder cycles from rest
+		double kicker;
+		bool ball;
+		// balls kicked, and virtual time of the last
+		int kicks;
+		double last_kick_time;
+		// inches travelled by each side, and inches per second
+		double left_distance;
+		double right_distance;
+		double left_speed;
+		double right_speed;
+		// radians, counterclockwise
+		double heading;
+	} State;
+
+	/**
+	 * Publish the starting state to the sensors, and
+	 * integrate from here on.
+	 */
+	static void start();
+	/**
+	 * One line on the state of the plant.
+	 */
+	static void printState();
+	/**
+	 * The plant as of the present virtual time. Call from a
+	 * robot thread, not the tick hook.
+	 */
+	static State getState();
+private:
+	static void tick(double from, double to);
+	static void step(double time, double dt);
+	static void publish(double time);
+};
+
+#endif
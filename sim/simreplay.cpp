@@ -0,0 +1,287 @@
+#include "simreplay.h"
+#include "simkernel.h"
+#include "simmatch.h"
+#include "simhardware.h"
+#include "simcan.h"
+#include "inputlog.h"
+#include "constants.h"
+#include "safecanjag.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+extern "C" int32_t FRC_UserProgram_StartupLibraryInit();
+
+using namespace InputLog;
+
+// how long to let the robot run after the last record
+const double RUN_OUT = 0.5;
+// how often to check whether the robot has started
+const double START_POLL = 0.1;
+
+static Header header;
+// oldest first
+static std::vector<Record> records;
+static std::vector<std::vector<double> > snapshots;
+// the code's constant for each in the log; NULL if gone
+static std::vector<DoubleConstant*> targets;
+
+static SimMatch::Inputs inputs;
+// the next record to apply, and the snapshot last applied
+static size_t next_record = 0;
+static int applied_snapshot = -1;
+static int snapshot_changes = 0;
+
+static uint16_t swap(uint16_t v) {
+	return __builtin_bswap16(v);
+}
+
+static uint32_t swap(uint32_t v) {
+	return __builtin_bswap32(v);
+}
+
+static void swapInPlace(void* p, size_t size) {
+	char* c = (char*) p;
+	for (size_t i = 0; i < size / 2; i++) {
+		char t = c[i];
+		c[i] = c[size - 1 - i];
+		c[size - 1 - i] = t;
+	}
+}
+
+template<typename T>
+static void swapAll(T* values, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		swapInPlace(&values[i], sizeof(T));
+	}
+}
+
+static void swapHeader(Header* h) {
+	h->byte_order = swap(h->byte_order);
+	h->version = swap(h->version);
+	h->record_size = swap(h->record_size);
+	h->capacity = swap(h->capacity);
+	h->count = swap(h->count);
+	h->dropped = swap(h->dropped);
+	h->num_constants = swap(h->num_constants);
+	h->snapshots = swap(h->snapshots);
+}
+
+static void swapRecord(Record* r) {
+	swapAll(r->accumulator_values, kMaxAccumulators);
+	r->time_us = swap(r->time_us);
+	swapAll(r->accumulator_counts, kMaxAccumulators);
+	swapAll(r->counts, kMaxCounts);
+	swapAll(&r->axes[0][0], kSticks * kAxes);
+	swapInPlace(&r->battery, sizeof(r->battery));
+	for (int i = 0; i < kSticks; i++) {
+		r->buttons[i] = swap(r->buttons[i]);
+	}
+	swapAll(r->analog, kAnalogChannels);
+	r->digital = swap(r->digital);
+}
+
+static bool load(const char* path) {
+	std::ifstream in(path, std::ios::in | std::ios::binary);
+	if (!in.read((char*) &header, sizeof(header))) {
+		printf("replay: could not read %s\n", path);
+		return false;
+	}
+	if (memcmp(header.magic, kMagic, sizeof(header.magic)) != 0) {
+		printf("replay: %s is not an input log\n", path);
+		return false;
+	}
+	bool swapped = (header.byte_order != kByteOrder);
+	if (swapped) {
+		swapHeader(&header);
+	}
+	if (header.byte_order != kByteOrder || header.version != kVersion
+			|| header.record_size != sizeof(Record)) {
+		printf("replay: %s is version %u with %u byte records; "
+			"this reads version %u with %u\n", path, header.version,
+				header.record_size, kVersion, (unsigned int) sizeof(Record));
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.num_constants; i++) {
+		char name[kNameLength];
+		in.read(name, kNameLength);
+		name[kNameLength - 1] = '\0';
+		targets.push_back(Constants::findDouble(name));
+		if (targets.back() == NULL) {
+			printf("replay: %s is not in the code; ignored\n", name);
+		}
+	}
+	for (int i = 0; i < kMaxSnapshots; i++) {
+		std::vector<double> values(header.num_constants);
+		if (!values.empty()) {
+			in.read((char*) &values[0], values.size() * sizeof(double));
+		}
+		if (swapped) {
+			swapAll(&values[0], values.size());
+		}
+		snapshots.push_back(values);
+	}
+
+	std::vector<Record> file(header.capacity);
+	in.read((char*) &file[0], file.size() * sizeof(Record));
+	if (!in) {
+		printf("replay: %s is cut short\n", path);
+		return false;
+	}
+	uint32_t n = std::min(header.count, header.capacity);
+	uint32_t oldest = (header.count > header.capacity) ? header.count
+			% header.capacity : 0;
+	for (uint32_t i = 0; i < n; i++) {
+		Record r = file[(oldest + i) % header.capacity];
+		if (swapped) {
+			swapRecord(&r);
+		}
+		records.push_back(r);
+	}
+	if (records.empty()) {
+		printf("replay: %s has no records\n", path);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Seconds from the first record to record `i`.
+ */
+static double offset(size_t i) {
+	return (uint32_t) (records[i].time_us - records[0].time_us) * 1e-6;
+}
+
+static SimMatch::Mode toMode(uint8_t mode) {
+	switch (mode) {
+	case kAutonomous:
+		return SimMatch::kAutonomous;
+	case kTeleop:
+		return SimMatch::kTeleop;
+	default:
+		// test mode is not simulated
+		return SimMatch::kDisabled;
+	}
+}
+
+static void applySnapshot(int snapshot) {
+	if (snapshot == applied_snapshot || snapshot >= (int) header.snapshots) {
+		return;
+	}
+	const std::vector<double>& values = snapshots[snapshot];
+	for (size_t i = 0; i < targets.size(); i++) {
+		if (targets[i] != NULL) {
+			targets[i]->update(values[i]);
+		}
+	}
+	applied_snapshot = snapshot;
+	snapshot_changes++;
+}
+
+/**
+ * Set every input from record `i`; called from the tick hook,
+ * or before the robot starts. Constants are set by the main
+ * thread, since changing one takes a lock.
+ */
+static void apply(size_t i) {
+	const Record& r = records[i];
+	inputs.mode = toMode(r.mode);
+	for (int s = 0; s < kSticks; s++) {
+		for (int a = 0; a < kAxes; a++) {
+			inputs.axes[s][a] = r.axes[s][a];
+		}
+		inputs.buttons[s] = r.buttons[s];
+	}
+	SimHardware::setBatteryVoltage(r.battery);
+	for (int c = 0; c < kAnalogChannels; c++) {
+		SimHardware::holdValue(c + 1, r.analog[c]);
+	}
+	for (int c = 0; c < kDigitalChannels; c++) {
+		SimHardware::setDigital(c + 1, (r.digital & (1 << c)) != 0);
+	}
+	for (int k = 0; k < kMaxCounts; k++) {
+		if (header.count_kinds[k] == kCounter) {
+			SimHardware::holdCount(header.count_channels[k], r.counts[k]);
+		} else if (header.count_kinds[k] == kEncoder) {
+			SimHardware::holdQuadrature(header.count_channels[k], r.counts[k]);
+		}
+	}
+	for (int k = 0; k < kMaxAccumulators; k++) {
+		if (header.accumulator_channels[k] != 0) {
+			SimHardware::holdAccumulator(header.accumulator_channels[k],
+					r.accumulator_values[k], r.accumulator_counts[k]);
+		}
+	}
+	for (int k = 0; k < kMaxLimits; k++) {
+		if (header.limit_devices[k] != 0 && r.limits[k] != kLimitsUnknown) {
+			SimCAN::setLimits(header.limit_devices[k], (r.limits[k]
+					& SafeCANJag::kForwardLimit) != 0, (r.limits[k]
+					& SafeCANJag::kReverseLimit) != 0);
+		}
+	}
+}
+
+static void tick(double from, double to) {
+	double start = SimMatch::getReplayStart();
+	if (start < 0.0) {
+		return;
+	}
+	size_t last = next_record;
+	while (last < records.size() && start + offset(last) <= to) {
+		last++;
+	}
+	if (last > next_record) {
+		apply(last - 1);
+		next_record = last;
+	}
+}
+
+int SimReplay::main(int argc, char** argv) {
+	if (argc != 1) {
+		printf("usage: yolosim replay <log>\n");
+		return 2;
+	}
+	if (!load(argv[0])) {
+		return 1;
+	}
+	double length = offset(records.size() - 1);
+	printf("replay: %u records, %.1f s, %u snapshots of %u constants"
+		"%s\n", (unsigned int) records.size(), length, header.snapshots,
+			header.num_constants, header.dropped ? "; some were dropped"
+					: "");
+
+	// the robot starts with the first record's inputs and constants
+	apply(0);
+	applySnapshot(records[0].snapshot);
+	next_record = 1;
+	SimMatch::replay(&inputs);
+	SimKernel::setTickHook(tick);
+	FRC_UserProgram_StartupLibraryInit();
+
+	double start;
+	while ((start = SimMatch::getReplayStart()) < 0.0) {
+		SimKernel::sleepUntil(SimKernel::now() + START_POLL);
+	}
+	// the main thread starts first, so it wakes ahead of the robot
+	for (size_t i = 1; i < records.size(); i++) {
+		if (records[i].snapshot != records[i - 1].snapshot) {
+			SimKernel::sleepUntil(start + offset(i));
+			applySnapshot(records[i].snapshot);
+		}
+	}
+	SimKernel::sleepUntil(start + length + RUN_OUT);
+
+	double simulated = SimKernel::now();
+	double wall = SimKernel::wallTime();
+	printf("[replay] %u records over %.1f s, %d constant changes; "
+		"%.1f s simulated in %.2f s (%.0fx real time), %d CAN frames\n",
+			(unsigned int) next_record, length, snapshot_changes, simulated,
+			wall, simulated / wall, SimCAN::getFramesSent());
+	fflush(stdout);
+	// the robot's tasks never return; leave them blocked
+	_exit(0);
+}
@@ -0,0 +1,30 @@
+#ifndef SIM_SIMREPLAY_H_
+#define SIM_SIMREPLAY_H_
+
+/**
+ * Plays a log from InputLog back through the robot code:
+ *
+ *   yolosim replay <log>
+ *
+ * Instead of the plant, every reading comes from the log, record by
+ * record on the virtual clock: the driver station's mode, joysticks
+ * and battery, the analog and digital inputs, the counters,
+ * encoders and gyro accumulators, and the Jaguars' limit inputs.
+ * The constants are set from the snapshot each record names. Since
+ * the kernel runs threads in a fixed order, replaying the same log
+ * always gives the same run, so a fix (or a slowdown) can be checked
+ * against real match traffic.
+ *
+ * The log's clock starts when the robot first asks the driver
+ * station for its mode. A mode change shows first in the new mode's
+ * first record, so the robot may enter it a loop late. Readings are
+ * replayed as they were read, at the top of the loop; the robot
+ * resetting a counter or the gyro does not change what it reads
+ * next, and constants changed live within a mode are not replayed.
+ */
+class SimReplay {
+public:
+	static int main(int argc, char** argv);
+};
+
+#endif
@@ -0,0 +1,377 @@
+#include "simtune.h"
+#include "simkernel.h"
+#include "simmatch.h"
+#include "simphysics.h"
+#include "constants.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" int32_t FRC_UserProgram_StartupLibraryInit();
+
+// the constants the trials are measured against
+const char* ARM_TARGET = "INTAKE_LOC_TELEKICK";
+const char* AUTO_DISTANCE = "AUTO_DISTANCE";
+
+const int DEFAULT_TRIALS = 200;
+const double SAMPLE_PERIOD = 0.005;
+// arm location, and wheel speed in inches per second,
+// within which it counts as settled or stopped
+const double ARM_TOLERANCE = 0.02;
+const double STOPPED_SPEED = 1.0;
+// an encoder cycle of the kicker's rest position
+const double KICKER_AT_REST = 1.0;
+
+// score, in seconds, of an arm overshoot of 1.0, a
+// drive error of an inch, and a missed kick in autonomous
+const double OVERSHOOT_WEIGHT = 10.0;
+const double DRIVE_ERROR_WEIGHT = 1.0 / 12.0;
+const double NO_KICK_PENALTY = 10.0;
+const int REPORT_TRIALS = 10;
+// a trial's constants file, by process id
+const char* TRIAL_CONSTANTS = "/tmp/yolotune-%d.txt";
+
+typedef struct {
+	std::string name;
+	double low;
+	double high;
+	// 0 for any value in [low, high]
+	double step;
+} Parameter;
+
+/**
+ * Written by a trial's process, down a pipe.
+ */
+typedef struct {
+	int trial;
+	// seconds from the raise command until the arm stays within
+	// ARM_TOLERANCE of its target; and the furthest beyond it
+	double arm_settle;
+	double arm_overshoot;
+	// seconds into autonomous when the ball is kicked, the kicker
+	// is back at rest, and the robot has stopped
+	bool auto_done;
+	double auto_time;
+	double drive_error;
+	double score;
+} Result;
+
+typedef struct {
+	int trial;
+	int fd;
+} Running;
+
+static bool byScore(const Result& a, const Result& b) {
+	return a.score < b.score;
+}
+
+static bool readSpace(const char* path, std::vector<Parameter>* space) {
+	std::ifstream in(path, std::ios::in);
+	if (!in.good()) {
+		printf("tune: could not read %s\n", path);
+		return false;
+	}
+	std::string line;
+	int number = 0;
+	while (std::getline(in, line)) {
+		number++;
+		line = line.substr(0, line.find('#'));
+		std::istringstream i(line);
+		Parameter p;
+		p.step = 0.0;
+		if (!(i >> p.name)) {
+			continue;
+		}
+		if (!(i >> p.low >> p.high) || p.high < p.low) {
+			printf("tune: %s:%d: expected NAME low high [step]\n", path,
+					number);
+			return false;
+		}
+		i >> p.step;
+		if (Constants::findDouble(p.name.c_str()) == NULL) {
+			printf("tune: %s:%d: no constant %s\n", path, number,
+					p.name.c_str());
+			return false;
+		}
+		space->push_back(p);
+	}
+	if (space->empty()) {
+		printf("tune: %s names no constants\n", path);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * A number in [0, 1) for parameter `index` of `trial`. A full
+ * integer hash (MurmurHash3's finalizer), since consecutive trials
+ * through a bare LCG step give nearly consecutive values.
+ */
+static double uniform(uint32_t trial, uint32_t index) {
+	uint32_t h = trial * 0x9E3779B9u + index * 0x85EBCA6Bu + 1;
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return (h >> 8) / 16777216.0;
+}
+
+/**
+ * The values for `trial`: the code's for trial 0, and otherwise drawn
+ * from a hash of the trial, so any trial can be rerun.
+ */
+static std::vector<double> sample(int trial,
+		const std::vector<Parameter>& space) {
+	std::vector<double> values;
+	for (size_t i = 0; i < space.size(); i++) {
+		const Parameter& p = space[i];
+		if (trial == 0) {
+			values.push_back(*Constants::findDouble(p.name.c_str()));
+			continue;
+		}
+		double u = uniform((uint32_t) trial, (uint32_t) i);
+		double v = p.low + u * (p.high - p.low);
+		if (p.step > 0.0) {
+			v = p.low + floor((v - p.low) / p.step + 0.5) * p.step;
+			v = std::min(v, p.high);
+		}
+		values.push_back(v);
+	}
+	return values;
+}
+
+/**
+ * Run a match with `values` in place, in this process. The robot
+ * loads its constants from a file of the trial's own, since trials
+ * run side by side and the robot saves what it loads.
+ */
+static Result runTrial(int trial, const std::vector<Parameter>& space,
+		const std::vector<double>& values) {
+	for (size_t i = 0; i < space.size(); i++) {
+		Constants::findDouble(space[i].name.c_str())->update(values[i]);
+	}
+	static char path[64];
+	snprintf(path, sizeof(path), TRIAL_CONSTANTS, (int) getpid());
+	Constants::save(path);
+	Constants::setPath(path);
+	double arm_target = *Constants::findDouble(ARM_TARGET);
+	double auto_distance = *Constants::findDouble(AUTO_DISTANCE);
+
+	SimMatch::setup(SimMatch::kAutonomousTime, SimMatch::kTeleopTime);
+	SimPhysics::start();
+	FRC_UserProgram_StartupLibraryInit();
+
+	Result r;
+	r.trial = trial;
+	r.arm_settle = SimMatch::kArmReleaseTime - SimMatch::kArmRaiseTime;
+	r.arm_overshoot = 0.0;
+	r.auto_done = false;
+	r.auto_time = SimMatch::kAutonomousTime;
+	r.drive_error = 0.0;
+
+	double auto_start = SimMatch::getAutonomousStart();
+	double auto_end = auto_start + SimMatch::kAutonomousTime;
+	double raise = SimMatch::getTeleopStart() + SimMatch::kArmRaiseTime;
+	double release = SimMatch::getTeleopStart() + SimMatch::kArmReleaseTime;
+	double last_out = raise;
+
+	for (double t = auto_start; t < release; t += SAMPLE_PERIOD) {
+		SimKernel::sleepUntil(t);
+		SimPhysics::State s = SimPhysics::getState();
+		if (t < auto_end) {
+			bool stopped = fabs(s.left_speed) < STOPPED_SPEED
+					&& fabs(s.right_speed) < STOPPED_SPEED;
+			if (!r.auto_done && s.kicks > 0 && s.kicker < KICKER_AT_REST
+					&& stopped) {
+				r.auto_done = true;
+				r.auto_time = t - auto_start;
+			}
+			r.drive_error = fabs((s.left_distance + s.right_distance) / 2.0
+					- auto_distance);
+		} else if (t >= raise) {
+			if (fabs(s.arm - arm_target) > ARM_TOLERANCE) {
+				last_out = t;
+			}
+			r.arm_overshoot = std::max(r.arm_overshoot, s.arm - arm_target);
+		}
+	}
+	if (last_out + SAMPLE_PERIOD < release) {
+		r.arm_settle = last_out - raise;
+	}
+	unlink(path);
+	unlink((std::string(path, strlen(path) - 4) + ".bin").c_str());
+
+	r.score = r.arm_settle + OVERSHOOT_WEIGHT * r.arm_overshoot + r.auto_time
+			+ DRIVE_ERROR_WEIGHT * r.drive_error;
+	if (!r.auto_done) {
+		r.score += NO_KICK_PENALTY;
+	}
+	return r;
+}
+
+/**
+ * Fork a process for `trial`, which reports down `run`'s pipe.
+ * Returns its pid, or -1.
+ */
+static pid_t startTrial(int trial, const std::vector<Parameter>& space,
+		Running* run) {
+	run->trial = trial;
+	int fds[2];
+	if (pipe(fds) != 0) {
+		printf("tune: pipe failed: %s\n", strerror(errno));
+		return -1;
+	}
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		// the robot talks a lot
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, STDOUT_FILENO);
+		dup2(null, STDERR_FILENO);
+		Result r = runTrial(trial, space, sample(trial, space));
+		write(fds[1], &r, sizeof(r));
+		_exit(0);
+	}
+	close(fds[1]);
+	if (pid < 0) {
+		printf("tune: fork failed: %s\n", strerror(errno));
+		close(fds[0]);
+		return -1;
+	}
+	run->fd = fds[0];
+	return pid;
+}
+
+static void printResult(const Result& r, const std::vector<Parameter>& space) {
+	printf("%5d %7.3f %6.3f %6.3f %6.2f%s %6.1f ", r.trial, r.score,
+			r.arm_settle, r.arm_overshoot, r.auto_time, r.auto_done ? " "
+					: "*", r.drive_error);
+	std::vector<double> values = sample(r.trial, space);
+	for (size_t i = 0; i < values.size(); i++) {
+		printf(" %s=%g", space[i].name.c_str(), values[i]);
+	}
+	printf("\n");
+}
+
+/**
+ * Say so if every trial gave the same `term`: the constants tuned
+ * do not reach it, or the scenario does not test them.
+ */
+static void warnIfSame(const std::vector<Result>& results, const char* term,
+		double Result::*value) {
+	if (results.size() < 2) {
+		return;
+	}
+	for (size_t i = 1; i < results.size(); i++) {
+		if (results[i].*value != results[0].*value) {
+			return;
+		}
+	}
+	printf("tune: warning: %s is %g in every trial\n", term,
+			results[0].*value);
+}
+
+int SimTune::main(int argc, char** argv) {
+	if (argc < 2 || argc > 4) {
+		printf("usage: yolosim tune <space> <output> [trials [jobs]]\n");
+		return 2;
+	}
+	std::vector<Parameter> space;
+	if (!readSpace(argv[0], &space)) {
+		return 1;
+	}
+	int trials = (argc > 2) ? atoi(argv[2]) : DEFAULT_TRIALS;
+	int jobs = (argc > 3) ? atoi(argv[3]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+	trials = std::max(trials, 1);
+	jobs = std::max(jobs, 1);
+	printf("tune: %d trials over %d constants, %d at a time\n", trials,
+			(int) space.size(), jobs);
+
+	double start = SimKernel::wallTime();
+	std::vector<Result> results;
+	std::map<pid_t, Running> running;
+	int next = 0;
+	int failed = 0;
+	while (next < trials || !running.empty()) {
+		if (next < trials && (int) running.size() < jobs) {
+			Running run;
+			pid_t pid = startTrial(next++, space, &run);
+			if (pid < 0) {
+				failed++;
+			} else {
+				running[pid] = run;
+			}
+			continue;
+		}
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0) {
+			break;
+		}
+		std::map<pid_t, Running>::iterator it = running.find(pid);
+		if (it == running.end()) {
+			continue;
+		}
+		// the child has exited, so this does not block
+		Result r;
+		if (read(it->second.fd, &r, sizeof(r)) == (ssize_t) sizeof(r)) {
+			results.push_back(r);
+		} else {
+			printf("tune: trial %d failed\n", it->second.trial);
+			failed++;
+		}
+		close(it->second.fd);
+		running.erase(it);
+		int done = (int) results.size() + failed;
+		if (done % std::max(trials / 10, 1) == 0) {
+			printf("tune: %d/%d trials, %.0f s\n", done, trials,
+					SimKernel::wallTime() - start);
+		}
+	}
+	if (results.empty()) {
+		printf("tune: no trials finished\n");
+		return 1;
+	}
+
+	warnIfSame(results, "arm_settle", &Result::arm_settle);
+	warnIfSame(results, "arm_overshoot", &Result::arm_overshoot);
+	warnIfSame(results, "auto_time", &Result::auto_time);
+	warnIfSame(results, "drive_error", &Result::drive_error);
+
+	std::sort(results.begin(), results.end(), byScore);
+	printf("\ntrial   score settle overshoot auto   drive  (* no kick)\n");
+	for (size_t i = 0; i < results.size() && (int) i < REPORT_TRIALS; i++) {
+		printResult(results[i], space);
+	}
+	for (size_t i = 0; i < results.size(); i++) {
+		if (results[i].trial == 0) {
+			printf("baseline, ranked %d of %d:\n", (int) i + 1,
+					(int) results.size());
+			printResult(results[i], space);
+		}
+	}
+
+	std::vector<double> best = sample(results[0].trial, space);
+	for (size_t i = 0; i < space.size(); i++) {
+		Constants::findDouble(space[i].name.c_str())->update(best[i]);
+	}
+	if (!Constants::save(argv[1])) {
+		printf("tune: could not write %s\n", argv[1]);
+		return 1;
+	}
+	printf("tune: wrote trial %d to %s\n", results[0].trial, argv[1]);
+	return 0;
+}
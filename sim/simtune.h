@@ -0,0 +1,29 @@
+#ifndef SIM_SIMTUNE_H_
+#define SIM_SIMTUNE_H_
+
+/**
+ * Random search over DoubleConstants, one simulated match per trial:
+ *
+ *   yolosim tune <space> <output> [trials [jobs]]
+ *
+ * Each line of the space file names a constant and the range to
+ * draw it from, "NAME low high", or "NAME low high step" for values
+ * on a grid; '#' starts a comment. Trial 0 keeps the values in the
+ * code, for comparison.
+ *
+ * Every trial runs in a process of its own (the simulation is one
+ * per process), `jobs` at a time; by default, one per core. Trials
+ * are ranked by how fast the lift settles on the teleop kick
+ * position, how far it overshoots, how long autonomous takes to
+ * drive and kick, and how far it misses its distance; a term that
+ * is the same in every trial is reported, as the constants tuned
+ * do not reach it. The best
+ * values are written to `output`, with every other constant at its
+ * value in the code, ready to copy to /c/constants.txt.
+ */
+class SimTune {
+public:
+	static int main(int argc, char** argv);
+};
+
+#endif
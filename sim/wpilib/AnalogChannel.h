@@ -0,0 +1,45 @@
+#ifndef SIM_WPILIB_ANALOGCHANNEL_H_
+#define SIM_WPILIB_ANALOGCHANNEL_H_
+
+#include "AnalogModule.h"
+
+/**
+ * An analog input; the voltage comes from the simulated plant.
+ * Channels 1 and 2 have accumulators.
+ */
+class AnalogChannel: public ErrorBase {
+public:
+	explicit AnalogChannel(uint32_t channel);
+	AnalogChannel(uint8_t moduleNumber, uint32_t channel);
+	virtual ~AnalogChannel();
+
+	int16_t GetValue();
+	int32_t GetAverageValue();
+	float GetVoltage();
+	float GetAverageVoltage();
+	uint32_t GetLSBWeight();
+	int32_t GetOffset();
+	uint32_t GetChannel();
+	AnalogModule* GetModule();
+
+	void SetAverageBits(uint32_t bits);
+	uint32_t GetAverageBits();
+	void SetOversampleBits(uint32_t bits);
+	uint32_t GetOversampleBits();
+
+	bool IsAccumulatorChannel();
+	void InitAccumulator();
+	void SetAccumulatorInitialValue(INT64 value);
+	void ResetAccumulator();
+	void SetAccumulatorCenter(int32_t center);
+	void SetAccumulatorDeadband(int32_t deadband);
+	INT64 GetAccumulatorValue();
+	uint32_t GetAccumulatorCount();
+	void GetAccumulatorOutput(INT64 *value, uint32_t *count);
+private:
+	uint32_t m_channel;
+	AnalogModule *m_module;
+	DISALLOW_COPY_AND_ASSIGN(AnalogChannel);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIM_WPILIB_ANALOGMODULE_H_
+#define SIM_WPILIB_ANALOGMODULE_H_
+
+#include "ErrorBase.h"
+
+class AnalogModule: public ErrorBase {
+public:
+	static const uint8_t kDefaultModule = 1;
+
+	static AnalogModule* GetInstance(uint8_t moduleNumber);
+	/**
+	 * Samples per second, per channel.
+	 */
+	uint32_t GetSampleRate();
+	uint32_t GetLSBWeight(uint32_t channel);
+	int32_t GetOffset(uint32_t channel);
+	int16_t GetValue(uint32_t channel);
+	int32_t GetAverageValue(uint32_t channel);
+private:
+	AnalogModule();
+	DISALLOW_COPY_AND_ASSIGN(AnalogModule);
+};
+
+#endif
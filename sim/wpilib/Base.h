@@ -0,0 +1,8 @@
+#ifndef SIM_WPILIB_BASE_H_
+#define SIM_WPILIB_BASE_H_
+
+#define DISALLOW_COPY_AND_ASSIGN(TypeName) \
+  TypeName(const TypeName&);               \
+  void operator=(const TypeName&)
+
+#endif
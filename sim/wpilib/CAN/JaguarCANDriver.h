@@ -0,0 +1,17 @@
+#ifndef SIM_WPILIB_JAGUARCANDRIVER_H_
+#define SIM_WPILIB_JAGUARCANDRIVER_H_
+
+#include "vxWorks.h"
+
+/**
+ * The CAN bus, implemented in sim/simcan.cpp.
+ */
+extern "C" {
+void FRC_NetworkCommunication_JaguarCANDriver_sendMessage(uint32_t messageID,
+		const uint8_t *data, uint8_t dataSize, int32_t *status);
+void FRC_NetworkCommunication_JaguarCANDriver_receiveMessage(
+		uint32_t *messageID, uint8_t *data, uint8_t *dataSize,
+		uint32_t timeoutMs, int32_t *status);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SIM_WPILIB_CAN_PROTO_H_
+#define SIM_WPILIB_CAN_PROTO_H_
+
+// The Jaguar message IDs the robot code uses. Both ends of the bus
+// are simulated, so IDs only need to be distinct; they do not all
+// match the Luminary Micro RDK header.
+
+#define CAN_MSGID_FULL_M 0x1fffffff
+#define CAN_MSGID_DEVNO_M 0x0000003f
+#define CAN_MSGID_API_M 0x0000ffc0
+#define CAN_MSGID_MFR_M 0x00ff0000
+#define CAN_MSGID_DTYPE_M 0x1f000000
+#define CAN_MSGID_API_S 6
+#define CAN_MSGID_API_SYNC 0x000001c0
+#define CAN_MSGID_API_FIRMVER 0x00000200
+#define LM_BASE 0x02020000
+#define LM_API(cls, idx) (LM_BASE | ((cls) << 10) | ((idx) << 6))
+#define LM_API_VOLT_EN LM_API(0,0)
+#define LM_API_VOLT_DIS LM_API(0,1)
+#define LM_API_VOLT_SET LM_API(0,2)
+#define LM_API_VOLT_SET_RAMP LM_API(0,3)
+#define LM_API_VOLT_T_EN LM_API(0,4)
+#define LM_API_VOLT_T_SET LM_API(0,5)
+#define LM_API_SPD_EN LM_API(2,0)
+#define LM_API_SPD_DIS LM_API(2,1)
+#define LM_API_SPD_SET LM_API(2,2)
+#define LM_API_SPD_PC LM_API(2,3)
+#define LM_API_SPD_IC LM_API(2,4)
+#define LM_API_SPD_DC LM_API(2,5)
+#define LM_API_SPD_REF LM_API(2,6)
+#define LM_API_SPD_T_EN LM_API(2,7)
+#define LM_API_SPD_T_SET LM_API(2,8)
+#define LM_API_VCOMP_EN LM_API(3,0)
+#define LM_API_VCOMP_DIS LM_API(3,1)
+#define LM_API_VCOMP_SET LM_API(3,2)
+#define LM_API_VCOMP_IN_RAMP LM_API(3,3)
+#define LM_API_VCOMP_T_EN LM_API(3,5)
+#define LM_API_VCOMP_T_SET LM_API(3,6)
+#define LM_API_POS_EN LM_API(4,0)
+#define LM_API_POS_DIS LM_API(4,1)
+#define LM_API_POS_SET LM_API(4,2)
+#define LM_API_POS_PC LM_API(4,3)
+#define LM_API_POS_IC LM_API(4,4)
+#define LM_API_POS_DC LM_API(4,5)
+#define LM_API_POS_REF LM_API(4,6)
+#define LM_API_POS_T_EN LM_API(4,7)
+#define LM_API_POS_T_SET LM_API(4,8)
+#define LM_API_ICTRL_EN LM_API(5,0)
+#define LM_API_ICTRL_DIS LM_API(5,1)
+#define LM_API_ICTRL_SET LM_API(5,2)
+#define LM_API_ICTRL_PC LM_API(5,3)
+#define LM_API_ICTRL_IC LM_API(5,4)
+#define LM_API_ICTRL_DC LM_API(5,5)
+#define LM_API_ICTRL_T_EN LM_API(5,6)
+#define LM_API_ICTRL_T_SET LM_API(5,7)
+#define LM_API_STATUS_VOLTBUS LM_API(6,0)
+#define LM_API_STATUS_VOLTOUT LM_API(6,1)
+#define LM_API_STATUS_CURRENT LM_API(6,2)
+#define LM_API_STATUS_TEMP LM_API(6,3)
+#define LM_API_STATUS_POS LM_API(6,4)
+#define LM_API_STATUS_SPD LM_API(6,5)
+#define LM_API_STATUS_LIMIT LM_API(6,6)
+#define LM_API_STATUS_FAULT LM_API(6,7)
+#define LM_API_STATUS_POWER LM_API(6,8)
+#define LM_API_STATUS_CMODE LM_API(6,9)
+#define LM_API_STATUS_VOUT LM_API(6,10)
+#define LM_API_CFG_NUM_BRUSHES LM_API(7,0)
+#define LM_API_CFG_ENC_LINES LM_API(7,1)
+#define LM_API_CFG_POT_TURNS LM_API(7,2)
+#define LM_API_CFG_BRAKE_COAST LM_API(7,3)
+#define LM_API_CFG_LIMIT_MODE LM_API(7,4)
+#define LM_API_CFG_LIMIT_FWD LM_API(7,5)
+#define LM_API_CFG_LIMIT_REV LM_API(7,6)
+#define LM_API_CFG_MAX_VOUT LM_API(7,7)
+#define LM_API_CFG_FAULT_TIME LM_API(7,8)
+#define LM_API_ACK LM_API(8,0)
+#define LM_API_HWVER (LM_BASE | (0x5 << 6) | 0xE000)
+#define LM_HWVER_JAG_1_0 1
+
+#endif
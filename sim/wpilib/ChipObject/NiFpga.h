@@ -0,0 +1,7 @@
+#ifndef SIM_WPILIB_NIFPGA_H_
+#define SIM_WPILIB_NIFPGA_H_
+
+// There is no FPGA in the simulation; the types the
+// CAN driver header expects are defined by the includer.
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SIM_WPILIB_COUNTER_H_
+#define SIM_WPILIB_COUNTER_H_
+
+#include "DigitalSource.h"
+
+/**
+ * Counts rising edges on one digital channel,
+ * while started.
+ */
+class Counter: public ErrorBase {
+public:
+	explicit Counter(uint32_t channel);
+	explicit Counter(DigitalSource *source);
+	virtual ~Counter();
+
+	void Start();
+	int32_t Get();
+	void Reset();
+	void Stop();
+	/**
+	 * Seconds between the last two edges.
+	 */
+	double GetPeriod();
+	void SetSamplesToAverage(int samplesToAverage);
+	int GetSamplesToAverage();
+private:
+	uint32_t m_channel;
+	uint32_t m_base;
+	int32_t m_stopped;
+	bool m_running;
+	int m_samplesToAverage;
+	DISALLOW_COPY_AND_ASSIGN(Counter);
+};
+
+#endif
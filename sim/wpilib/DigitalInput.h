@@ -0,0 +1,23 @@
+#ifndef SIM_WPILIB_DIGITALINPUT_H_
+#define SIM_WPILIB_DIGITALINPUT_H_
+
+#include "DigitalSource.h"
+
+/**
+ * A digital input; unconnected inputs read high, as
+ * the cRIO's are pulled up.
+ */
+class DigitalInput: public DigitalSource {
+public:
+	explicit DigitalInput(uint32_t channel);
+	DigitalInput(uint8_t moduleNumber, uint32_t channel);
+	virtual ~DigitalInput();
+	uint32_t Get();
+	uint32_t GetChannel();
+	virtual uint32_t GetChannelForRouting();
+private:
+	uint32_t m_channel;
+	DISALLOW_COPY_AND_ASSIGN(DigitalInput);
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SIM_WPILIB_DIGITALMODULE_H_
+#define SIM_WPILIB_DIGITALMODULE_H_
+
+#include "ErrorBase.h"
+
+class DigitalModule: public ErrorBase {
+public:
+	static DigitalModule* GetInstance(uint8_t moduleNumber);
+	bool GetDIO(uint32_t channel);
+	/**
+	 * Every input at once; as on the FPGA, channel n is bit 16 - n.
+	 */
+	uint16_t GetDIO();
+private:
+	DigitalModule();
+	DISALLOW_COPY_AND_ASSIGN(DigitalModule);
+};
+
+#endif
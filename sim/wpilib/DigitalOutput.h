@@ -0,0 +1,26 @@
+#ifndef SIM_WPILIB_DIGITALOUTPUT_H_
+#define SIM_WPILIB_DIGITALOUTPUT_H_
+
+#include "ErrorBase.h"
+
+/**
+ * A digital output; with PWM enabled, the level reads
+ * as on while the duty cycle is above one half.
+ */
+class DigitalOutput: public ErrorBase {
+public:
+	explicit DigitalOutput(uint32_t channel);
+	virtual ~DigitalOutput();
+	void Set(uint32_t value);
+	uint32_t GetChannel();
+	void SetPWMRate(float rate);
+	void EnablePWM(float initialDutyCycle);
+	void DisablePWM();
+	void UpdateDutyCycle(float dutyCycle);
+private:
+	uint32_t m_channel;
+	bool m_pwm;
+	DISALLOW_COPY_AND_ASSIGN(DigitalOutput);
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_WPILIB_DIGITALSOURCE_H_
+#define SIM_WPILIB_DIGITALSOURCE_H_
+
+#include "ErrorBase.h"
+
+class DigitalSource: public ErrorBase {
+public:
+	virtual ~DigitalSource();
+	virtual uint32_t GetChannelForRouting() = 0;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SIM_WPILIB_DRIVERSTATION_H_
+#define SIM_WPILIB_DRIVERSTATION_H_
+
+#include "ErrorBase.h"
+
+/**
+ * The field and the operator console, as scripted by SimMatch.
+ */
+class DriverStation: public ErrorBase {
+public:
+	static const uint32_t kJoystickPorts = 4;
+	static const uint32_t kJoystickAxes = 6;
+
+	static DriverStation* GetInstance();
+
+	float GetStickAxis(uint32_t stick, uint32_t axis);
+	short GetStickButtons(uint32_t stick);
+	float GetBatteryVoltage();
+
+	bool IsEnabled();
+	bool IsDisabled();
+	bool IsAutonomous();
+	bool IsOperatorControl();
+	bool IsTest();
+	/**
+	 * Wait for the next control packet, which the
+	 * field sends every 20 ms.
+	 */
+	void WaitForData();
+private:
+	DriverStation();
+	DISALLOW_COPY_AND_ASSIGN(DriverStation);
+};
+
+#endif
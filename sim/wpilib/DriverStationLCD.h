@@ -0,0 +1,41 @@
+#ifndef SIM_WPILIB_DRIVERSTATIONLCD_H_
+#define SIM_WPILIB_DRIVERSTATIONLCD_H_
+
+#include "ErrorBase.h"
+#include "semLib.h"
+#include <stdarg.h>
+
+/**
+ * The user messages box. Lines are kept, not shown; set
+ * SIM_LCD in the environment to print each update.
+ */
+class DriverStationLCD: public ErrorBase {
+public:
+	static const uint32_t kLineLength = 21;
+	static const uint32_t kNumLines = 6;
+	enum Line {
+		kMain_Line6 = 0,
+		kUser_Line1 = 0,
+		kUser_Line2 = 1,
+		kUser_Line3 = 2,
+		kUser_Line4 = 3,
+		kUser_Line5 = 4,
+		kUser_Line6 = 5
+	};
+
+	static DriverStationLCD* GetInstance();
+
+	void UpdateLCD();
+	void PrintfLine(Line line, const char *writeFmt, ...);
+	void VPrintfLine(Line line, const char *writeFmt, va_list args);
+	void Clear();
+private:
+	DriverStationLCD();
+
+	char m_lines[kNumLines][kLineLength + 1];
+	SEM_ID m_textBufferSemaphore;
+	bool m_show;
+	DISALLOW_COPY_AND_ASSIGN(DriverStationLCD);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SIM_WPILIB_ENCODER_H_
+#define SIM_WPILIB_ENCODER_H_
+
+#include "Counter.h"
+
+/**
+ * A quadrature encoder, decoded 4X; Get() is in cycles.
+ */
+class Encoder: public ErrorBase {
+public:
+	Encoder(uint32_t aChannel, uint32_t bChannel,
+			bool reverseDirection = false);
+	virtual ~Encoder();
+
+	void Start();
+	int32_t Get();
+	int32_t GetRaw();
+	void Reset();
+	void Stop();
+	/**
+	 * Cycles per second.
+	 */
+	double GetRate();
+private:
+	uint32_t m_aChannel;
+	bool m_reverseDirection;
+	int32_t m_base;
+	int32_t m_stopped;
+	bool m_running;
+	DISALLOW_COPY_AND_ASSIGN(Encoder);
+};
+
+#endif
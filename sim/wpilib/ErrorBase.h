@@ -0,0 +1,65 @@
+#ifndef SIM_WPILIB_ERRORBASE_H_
+#define SIM_WPILIB_ERRORBASE_H_
+
+#include "vxWorks.h"
+#include "Base.h"
+#include <string>
+
+class ErrorBase;
+
+/**
+ * The last error an object reported. Codes below zero are fatal.
+ */
+class Error {
+public:
+	typedef int32_t Code;
+
+	Error();
+	Code GetCode() const;
+	const char* GetMessage() const;
+	void Set(Code code, const char* contextMessage, const char* filename,
+			const char* function, uint32_t lineNumber);
+	void Clear();
+private:
+	Code m_code;
+	std::string m_message;
+};
+
+/**
+ * Error reporting for WPILib objects. Errors are printed
+ * as they are set, as on the robot.
+ */
+class ErrorBase {
+public:
+	virtual ~ErrorBase();
+	virtual Error& GetError();
+	virtual const Error& GetError() const;
+	virtual void SetError(Error::Code code, const char* contextMessage,
+			const char* filename, const char* function, uint32_t lineNumber) const;
+	virtual void SetWPIError(const char* errorMessage, Error::Code code,
+			const char* contextMessage, const char* filename,
+			const char* function, uint32_t lineNumber) const;
+	virtual void ClearError() const;
+	virtual bool StatusIsFatal() const;
+	static void SetGlobalWPIError(const char* errorMessage, Error::Code code,
+			const char* contextMessage, const char* filename,
+			const char* function, uint32_t lineNumber);
+	static Error& GetGlobalError();
+protected:
+	ErrorBase();
+	mutable Error m_error;
+private:
+	DISALLOW_COPY_AND_ASSIGN(ErrorBase);
+};
+
+#define wpi_setErrorWithContext(code, context) \
+	(this->SetError((code), (context), __FILE__, __FUNCTION__, __LINE__))
+#define wpi_setWPIErrorWithContext(error, context) \
+	(this->SetWPIError((wpi_error_s_##error), (wpi_error_value_##error), \
+			(context), __FILE__, __FUNCTION__, __LINE__))
+#define wpi_setGlobalWPIErrorWithContext(error, context) \
+	(::ErrorBase::SetGlobalWPIError((wpi_error_s_##error), \
+			(wpi_error_value_##error), (context), __FILE__, __FUNCTION__, \
+			__LINE__))
+
+#endif
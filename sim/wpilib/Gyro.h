@@ -0,0 +1,8 @@
+#ifndef SIM_WPILIB_GYRO_H_
+#define SIM_WPILIB_GYRO_H_
+
+// The robot reads its gyro through RollingGyro, from the
+// accumulator of an AnalogChannel; WPILib's Gyro is not simulated.
+#include "AnalogChannel.h"
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SIM_WPILIB_JOYSTICK_H_
+#define SIM_WPILIB_JOYSTICK_H_
+
+#include "ErrorBase.h"
+
+class DriverStation;
+
+class Joystick: public ErrorBase {
+public:
+	explicit Joystick(uint32_t port);
+	virtual ~Joystick();
+	float GetX();
+	float GetY();
+	float GetRawAxis(uint32_t axis);
+	bool GetRawButton(uint32_t button);
+private:
+	DriverStation *m_ds;
+	uint32_t m_port;
+	DISALLOW_COPY_AND_ASSIGN(Joystick);
+};
+
+#endif
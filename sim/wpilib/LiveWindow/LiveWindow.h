@@ -0,0 +1,22 @@
+#ifndef SIM_WPILIB_LIVEWINDOW_H_
+#define SIM_WPILIB_LIVEWINDOW_H_
+
+#include "LiveWindow/LiveWindowSendable.h"
+
+/**
+ * Test mode is not simulated; components are accepted and ignored.
+ */
+class LiveWindow {
+public:
+	static LiveWindow* GetInstance();
+	void AddActuator(const char *subsystem, const char *name,
+			LiveWindowSendable *component);
+	void AddActuator(const char *moduleType, int moduleNumber, int channel,
+			LiveWindowSendable *component);
+	void AddSensor(const char *moduleType, int channel,
+			LiveWindowSendable *component);
+private:
+	LiveWindow();
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SIM_WPILIB_LIVEWINDOWSENDABLE_H_
+#define SIM_WPILIB_LIVEWINDOWSENDABLE_H_
+
+#include "tables/ITable.h"
+#include <string>
+
+class LiveWindowSendable {
+public:
+	virtual ~LiveWindowSendable() {
+	}
+	virtual void UpdateTable() = 0;
+	virtual void StartLiveWindowMode() = 0;
+	virtual void StopLiveWindowMode() = 0;
+	virtual std::string GetSmartDashboardType() = 0;
+	virtual void InitTable(ITable *subtable) = 0;
+	virtual ITable* GetTable() = 0;
+};
+
+#endif
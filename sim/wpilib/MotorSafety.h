@@ -0,0 +1,19 @@
+#ifndef SIM_WPILIB_MOTORSAFETY_H_
+#define SIM_WPILIB_MOTORSAFETY_H_
+
+#define DEFAULT_SAFETY_EXPIRATION 0.1
+
+class MotorSafety {
+public:
+	virtual ~MotorSafety() {
+	}
+	virtual void SetExpiration(float timeout) = 0;
+	virtual float GetExpiration() = 0;
+	virtual bool IsAlive() = 0;
+	virtual void StopMotor() = 0;
+	virtual void SetSafetyEnabled(bool enabled) = 0;
+	virtual bool IsSafetyEnabled() = 0;
+	virtual void GetDescription(char *desc) = 0;
+};
+
+#endif
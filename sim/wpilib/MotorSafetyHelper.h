@@ -0,0 +1,29 @@
+#ifndef SIM_WPILIB_MOTORSAFETYHELPER_H_
+#define SIM_WPILIB_MOTORSAFETYHELPER_H_
+
+#include "ErrorBase.h"
+#include "MotorSafety.h"
+
+/**
+ * Motor watchdog, on the virtual clock. Nothing checks it in
+ * the background: expired motors are not stopped.
+ */
+class MotorSafetyHelper: public ErrorBase {
+public:
+	MotorSafetyHelper(MotorSafety *safeObject);
+	~MotorSafetyHelper();
+	void Feed();
+	void SetExpiration(float expirationTime);
+	float GetExpiration();
+	bool IsAlive();
+	void SetSafetyEnabled(bool enabled);
+	bool IsSafetyEnabled();
+private:
+	double m_expiration;
+	bool m_enabled;
+	double m_stopTime;
+	MotorSafety *m_safeObject;
+	DISALLOW_COPY_AND_ASSIGN(MotorSafetyHelper);
+};
+
+#endif
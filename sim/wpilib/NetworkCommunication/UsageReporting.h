@@ -0,0 +1,20 @@
+#ifndef SIM_WPILIB_USAGEREPORTING_H_
+#define SIM_WPILIB_USAGEREPORTING_H_
+
+#include "vxWorks.h"
+
+namespace nUsageReporting {
+typedef enum {
+	kResourceType_CANJaguar = 3
+} tResourceType;
+
+/**
+ * No usage is reported from the simulation.
+ */
+inline uint32_t report(tResourceType resource, uint8_t instanceNumber,
+		uint8_t context = 0, const char *feature = NULL) {
+	return 0;
+}
+}
+
+#endif
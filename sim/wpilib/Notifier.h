@@ -0,0 +1,48 @@
+#ifndef SIM_WPILIB_NOTIFIER_H_
+#define SIM_WPILIB_NOTIFIER_H_
+
+#include "ErrorBase.h"
+#include "semLib.h"
+#include "Synchronized.h"
+
+class Task;
+
+typedef void (*TimerEventHandler)(void *param);
+
+/**
+ * Calls a handler once or periodically, on the virtual clock.
+ * All handlers run on one thread, in expiration order, as
+ * they do on the robot.
+ */
+class Notifier: public ErrorBase {
+public:
+	Notifier(TimerEventHandler handler, void *param = NULL);
+	virtual ~Notifier();
+	void StartSingle(double delay);
+	void StartPeriodic(double period);
+	/**
+	 * Returns once the handler is no longer running.
+	 */
+	void Stop();
+private:
+	static int ProcessQueue();
+	void InsertInQueue(bool reschedule);
+	void DeleteFromQueue();
+
+	static Notifier *timerQueueHead;
+	static SEM_ID queueSemaphore;
+	static SEM_ID wakeup;
+	static Task *task;
+
+	TimerEventHandler m_handler;
+	void *m_param;
+	double m_period;
+	double m_expirationTime;
+	Notifier *m_nextEvent;
+	bool m_periodic;
+	bool m_queued;
+	SEM_ID m_handlerSemaphore;
+	DISALLOW_COPY_AND_ASSIGN(Notifier);
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_WPILIB_PIDOUTPUT_H_
+#define SIM_WPILIB_PIDOUTPUT_H_
+
+class PIDOutput {
+public:
+	virtual ~PIDOutput() {
+	}
+	virtual void PIDWrite(float output) = 0;
+};
+
+#endif
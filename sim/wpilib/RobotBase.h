@@ -0,0 +1,39 @@
+#ifndef SIM_WPILIB_ROBOTBASE_H_
+#define SIM_WPILIB_ROBOTBASE_H_
+
+#include "Base.h"
+#include "Task.h"
+#include "Timer.h"
+#include <stdio.h>
+
+class DriverStation;
+
+class RobotBase {
+public:
+	static RobotBase &getInstance();
+	static void setInstance(RobotBase* robot);
+	/**
+	 * Construct the robot with `factory` and run it,
+	 * on a task of its own.
+	 */
+	static void startRobotTask(FUNCPTR factory);
+
+	bool IsEnabled();
+	bool IsDisabled();
+	bool IsAutonomous();
+	bool IsOperatorControl();
+	bool IsTest();
+	virtual void StartCompetition() = 0;
+protected:
+	RobotBase();
+	virtual ~RobotBase();
+
+	DriverStation *m_ds;
+private:
+	static int robotTask(FUNCPTR factory);
+
+	static RobotBase *m_instance;
+	DISALLOW_COPY_AND_ASSIGN(RobotBase);
+};
+
+#endif
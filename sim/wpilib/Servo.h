@@ -0,0 +1,22 @@
+#ifndef SIM_WPILIB_SERVO_H_
+#define SIM_WPILIB_SERVO_H_
+
+#include "ErrorBase.h"
+
+/**
+ * A servo on a PWM channel; positions run from 0 to 1.
+ */
+class Servo: public ErrorBase {
+public:
+	explicit Servo(uint32_t channel);
+	virtual ~Servo();
+	void Set(float value);
+	float Get();
+	void SetAngle(float angle);
+	float GetAngle();
+private:
+	uint32_t m_channel;
+	DISALLOW_COPY_AND_ASSIGN(Servo);
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef SIM_WPILIB_SIMPLEROBOT_H_
+#define SIM_WPILIB_SIMPLEROBOT_H_
+
+#include "RobotBase.h"
+
+class SimpleRobot: public RobotBase {
+public:
+	SimpleRobot();
+	virtual ~SimpleRobot();
+	virtual void RobotInit();
+	virtual void Disabled();
+	virtual void Autonomous();
+	virtual void OperatorControl();
+	virtual void Test();
+	virtual void StartCompetition();
+private:
+	DISALLOW_COPY_AND_ASSIGN(SimpleRobot);
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef SIM_WPILIB_SMARTDASHBOARD_H_
+#define SIM_WPILIB_SMARTDASHBOARD_H_
+
+#include <string>
+
+/**
+ * The "SmartDashboard" NetworkTable. Getters throw
+ * TableKeyNotDefinedException for keys never put.
+ */
+class SmartDashboard {
+public:
+	static void PutBoolean(std::string keyName, bool value);
+	static bool GetBoolean(std::string keyName);
+	static void PutNumber(std::string keyName, double value);
+	static double GetNumber(std::string keyName);
+};
+
+#endif
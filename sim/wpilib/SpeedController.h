@@ -0,0 +1,16 @@
+#ifndef SIM_WPILIB_SPEEDCONTROLLER_H_
+#define SIM_WPILIB_SPEEDCONTROLLER_H_
+
+#include "vxWorks.h"
+#include "PIDOutput.h"
+
+class SpeedController: public PIDOutput {
+public:
+	virtual ~SpeedController() {
+	}
+	virtual void Set(float speed, uint8_t syncGroup = 0) = 0;
+	virtual float Get() = 0;
+	virtual void Disable() = 0;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIM_WPILIB_SYNCHRONIZED_H_
+#define SIM_WPILIB_SYNCHRONIZED_H_
+
+#include "semLib.h"
+#include "Base.h"
+
+/**
+ * Holds a semaphore for the life of the object.
+ */
+class Synchronized {
+public:
+	explicit Synchronized(SEM_ID semaphore) :
+		m_semaphore(semaphore) {
+		semTake(m_semaphore, WAIT_FOREVER);
+	}
+	virtual ~Synchronized() {
+		semGive(m_semaphore);
+	}
+private:
+	SEM_ID m_semaphore;
+	DISALLOW_COPY_AND_ASSIGN(Synchronized);
+};
+
+#endif
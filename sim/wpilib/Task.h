@@ -0,0 +1,42 @@
+#ifndef SIM_WPILIB_TASK_H_
+#define SIM_WPILIB_TASK_H_
+
+#include "ErrorBase.h"
+#include <pthread.h>
+
+/**
+ * A vxWorks task, as a host thread on the virtual clock.
+ * 
+ * Priorities are recorded but not enforced. A host thread
+ * cannot be killed safely, so Stop() (and the destructor) only
+ * forget the thread; its function runs until it returns.
+ */
+class Task: public ErrorBase {
+public:
+	static const uint32_t kDefaultPriority = 101;
+
+	Task(const char* name, FUNCPTR function, int32_t priority =
+			kDefaultPriority, uint32_t stackSize = 20000);
+	virtual ~Task();
+
+	bool Start(uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t arg2 = 0,
+			uint32_t arg3 = 0, uint32_t arg4 = 0, uint32_t arg5 = 0,
+			uint32_t arg6 = 0, uint32_t arg7 = 0, uint32_t arg8 = 0,
+			uint32_t arg9 = 0);
+	bool Stop();
+	bool IsReady();
+	int32_t GetPriority();
+	bool SetPriority(int32_t priority);
+	const char* GetName();
+private:
+	static void* Run(void* start);
+
+	FUNCPTR m_function;
+	std::string m_taskName;
+	int32_t m_priority;
+	bool m_started;
+	pthread_t m_thread;
+	DISALLOW_COPY_AND_ASSIGN(Task);
+};
+
+#endif
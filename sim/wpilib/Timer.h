@@ -0,0 +1,41 @@
+#ifndef SIM_WPILIB_TIMER_H_
+#define SIM_WPILIB_TIMER_H_
+
+#include "Base.h"
+
+/**
+ * Seconds of virtual time.
+ */
+double GetTime();
+/**
+ * Sleep for `seconds` of virtual time.
+ */
+void Wait(double seconds);
+
+/**
+ * Stopwatch on the virtual clock.
+ */
+class Timer {
+public:
+	Timer();
+	virtual ~Timer();
+	double Get();
+	void Reset();
+	void Start();
+	void Stop();
+	bool HasPeriodPassed(double period);
+
+	static double GetFPGATimestamp();
+	/**
+	 * Host time, not virtual time, so that the Profiler
+	 * measures what the code costs on the host.
+	 */
+	static double GetPPCTimestamp();
+private:
+	double m_startTime;
+	double m_accumulatedTime;
+	bool m_running;
+	DISALLOW_COPY_AND_ASSIGN(Timer);
+};
+
+#endif
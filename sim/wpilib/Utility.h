@@ -0,0 +1,11 @@
+#ifndef SIM_WPILIB_UTILITY_H_
+#define SIM_WPILIB_UTILITY_H_
+
+#include "vxWorks.h"
+
+/**
+ * Microseconds of virtual time; wraps like the FPGA counter.
+ */
+uint32_t GetFPGATime();
+
+#endif
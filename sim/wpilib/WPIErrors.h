@@ -0,0 +1,17 @@
+#ifndef SIM_WPILIB_WPIERRORS_H_
+#define SIM_WPILIB_WPIERRORS_H_
+
+#include "vxWorks.h"
+
+// Negative codes are fatal errors, positive ones warnings.
+#define S(label, offset, message) \
+	const char *const wpi_error_s_##label = message; \
+	const int32_t wpi_error_value_##label = offset
+
+S(ParameterOutOfRange, -28, "Parameter out of range");
+S(JaguarVersionError, -36, "Jaguar firmware version error");
+S(IncompatibleMode, 4, "The object is in an incompatible mode");
+
+#undef S
+
+#endif
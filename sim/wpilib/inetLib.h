@@ -0,0 +1,6 @@
+#ifndef SIM_WPILIB_INETLIB_H_
+#define SIM_WPILIB_INETLIB_H_
+
+#include <arpa/inet.h>
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SIM_WPILIB_NETWORKTABLE_H_
+#define SIM_WPILIB_NETWORKTABLE_H_
+
+#include "tables/ITable.h"
+#include "tables/TableKeyNotDefinedException.h"
+#include "semLib.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A table in process memory; nothing goes over the network.
+ * Listeners are called on the thread that changed the value.
+ */
+class NetworkTable: public ITable {
+public:
+	static NetworkTable* GetTable(std::string key);
+
+	virtual bool ContainsKey(std::string key);
+	virtual void PutNumber(std::string key, double value);
+	virtual double GetNumber(std::string key);
+	virtual double GetNumber(std::string key, double defaultValue);
+	virtual void PutBoolean(std::string key, bool value);
+	virtual bool GetBoolean(std::string key);
+	virtual bool GetBoolean(std::string key, bool defaultValue);
+	virtual void AddTableListener(std::string key, ITableListener* listener,
+			bool immediateNotify);
+	virtual void RemoveTableListener(ITableListener* listener);
+private:
+	NetworkTable();
+	void Put(const std::string& key, EntryValue value);
+	bool Lookup(const std::string& key, EntryValue* value);
+
+	typedef struct {
+		std::string key;
+		ITableListener* listener;
+	} Listener;
+
+	std::map<std::string, EntryValue> values;
+	std::vector<Listener> listeners;
+	SEM_ID semaphore;
+};
+
+#endif
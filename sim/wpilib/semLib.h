@@ -0,0 +1,36 @@
+#ifndef SIM_WPILIB_SEMLIB_H_
+#define SIM_WPILIB_SEMLIB_H_
+
+#include "vxWorks.h"
+
+/**
+ * vxWorks semaphores, on the simulation's virtual clock: a task
+ * blocked in semTake() lets virtual time advance. Timeouts are
+ * in ticks of SEM_CLOCK_RATE per second. Waiters are woken in
+ * FIFO order whatever the queueing option.
+ */
+struct semaphore;
+typedef struct semaphore* SEM_ID;
+
+#define WAIT_FOREVER (-1)
+#define NO_WAIT 0
+#define SEM_CLOCK_RATE 1000
+
+#define SEM_Q_FIFO 0x0
+#define SEM_Q_PRIORITY 0x1
+#define SEM_DELETE_SAFE 0x4
+#define SEM_INVERSION_SAFE 0x8
+
+typedef enum {
+	SEM_EMPTY, SEM_FULL
+} SEM_B_STATE;
+
+SEM_ID semMCreate(int options);
+SEM_ID semBCreate(int options, SEM_B_STATE initialState);
+SEM_ID semCCreate(int options, int initialCount);
+STATUS semTake(SEM_ID semId, int timeout);
+STATUS semGive(SEM_ID semId);
+STATUS semFlush(SEM_ID semId);
+STATUS semDelete(SEM_ID semId);
+
+#endif
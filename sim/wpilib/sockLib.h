@@ -0,0 +1,8 @@
+#ifndef SIM_WPILIB_SOCKLIB_H_
+#define SIM_WPILIB_SOCKLIB_H_
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SIM_WPILIB_ITABLE_H_
+#define SIM_WPILIB_ITABLE_H_
+
+#include "tables/ITableListener.h"
+#include <string>
+
+class ITable {
+public:
+	virtual ~ITable() {
+	}
+	virtual bool ContainsKey(std::string key) = 0;
+	virtual void PutNumber(std::string key, double value) = 0;
+	/**
+	 * Throws TableKeyNotDefinedException if `key` was never put.
+	 */
+	virtual double GetNumber(std::string key) = 0;
+	virtual double GetNumber(std::string key, double defaultValue) = 0;
+	virtual void PutBoolean(std::string key, bool value) = 0;
+	virtual bool GetBoolean(std::string key) = 0;
+	virtual bool GetBoolean(std::string key, bool defaultValue) = 0;
+	virtual void AddTableListener(std::string key, ITableListener* listener,
+			bool immediateNotify) = 0;
+	virtual void RemoveTableListener(ITableListener* listener) = 0;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SIM_WPILIB_ITABLELISTENER_H_
+#define SIM_WPILIB_ITABLELISTENER_H_
+
+#include <string>
+
+class ITable;
+
+union EntryValue {
+	void* ptr;
+	bool b;
+	double f;
+};
+
+class ITableListener {
+public:
+	virtual ~ITableListener() {
+	}
+	virtual void ValueChanged(ITable* source, const std::string& key,
+			EntryValue value, bool isNew) = 0;
+};
+
+#endif
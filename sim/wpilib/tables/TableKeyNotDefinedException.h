@@ -0,0 +1,16 @@
+#ifndef SIM_WPILIB_TABLEKEYNOTDEFINEDEXCEPTION_H_
+#define SIM_WPILIB_TABLEKEYNOTDEFINEDEXCEPTION_H_
+
+#include <exception>
+#include <string>
+
+class TableKeyNotDefinedException: public std::exception {
+public:
+	TableKeyNotDefinedException(const std::string key);
+	virtual ~TableKeyNotDefinedException() throw ();
+	virtual const char* what() const throw ();
+private:
+	std::string msg;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_WPILIB_TASKLIB_H_
+#define SIM_WPILIB_TASKLIB_H_
+
+#include "vxWorks.h"
+
+/**
+ * The calling thread's id: nonzero, and unique for the life of
+ * the process.
+ */
+int taskIdSelf();
+
+#endif
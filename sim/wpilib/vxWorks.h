@@ -0,0 +1,20 @@
+#ifndef SIM_WPILIB_VXWORKS_H_
+#define SIM_WPILIB_VXWORKS_H_
+
+/**
+ * Host stand-ins for the WPILib and vxWorks headers the robot
+ * includes; see sim/simmain.cpp. Only the parts the robot code
+ * uses are declared.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+typedef long long INT64;
+typedef int STATUS;
+typedef int (*FUNCPTR)(...);
+
+#define ERROR (-1)
+#define OK 0
+
+#endif
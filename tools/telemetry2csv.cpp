@@ -0,0 +1,236 @@
+/**
+ * Host-side decoder for the robot's UDP log stream.
+ * 
+ * Reads a capture of the payloads sent to port 1140 (for example,
+ * `nc -lu 1140 > capture.bin`) and writes one CSV per Telemetry
+ * channel, named <channel>.csv, into the output directory. Columns
+ * are the time in seconds since the first sample, then the channel's
+ * fields. Text from UDPLog::log is copied to stdout.
+ * 
+ * A capture started late sees samples before their channel's
+ * definition (which is sent again every second); those are held
+ * until it arrives. Channels never defined are written to
+ * channel<id>.csv with columns f0, f1, ...
+ * 
+ * Build: g++ -O2 -I../util -o telemetry2csv telemetry2csv.cpp
+ * Usage: telemetry2csv capture.bin [output_dir]
+ */
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef struct {
+	double time;
+	std::vector<float> values;
+} Sample;
+
+typedef struct {
+	std::string name;
+	std::string fields;
+	bool defined;
+	FILE* out;
+	// samples seen before the channel's definition
+	std::vector<Sample> pending;
+} Channel;
+
+static std::map<int, Channel> channels;
+static std::string outdir = ".";
+
+static uint16_t get16(const uint8_t* b) {
+	return (b[0] << 8) | b[1];
+}
+
+static uint32_t get32(const uint8_t* b) {
+	return ((uint32_t) b[0] << 24) | ((uint32_t) b[1] << 16)
+			| ((uint32_t) b[2] << 8) | b[3];
+}
+
+// the FPGA clock wraps every 71 minutes
+static bool have_start = false;
+static uint32_t last_us = 0;
+static double elapsed = 0.0;
+
+static double toSeconds(uint32_t us) {
+	if (!have_start) {
+		have_start = true;
+		last_us = us;
+	}
+	elapsed += (uint32_t) (us - last_us) * 1e-6;
+	last_us = us;
+	return elapsed;
+}
+
+static FILE* openCSV(Channel& c, int id, int count) {
+	if (c.out != NULL) {
+		return c.out;
+	}
+	if (c.name.empty()) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "channel%d", id);
+		c.name = buf;
+	}
+	std::string path = outdir + "/" + c.name + ".csv";
+	c.out = fopen(path.c_str(), "w");
+	if (c.out == NULL) {
+		fprintf(stderr, "cannot write %s\n", path.c_str());
+		return NULL;
+	}
+	fprintf(c.out, "time");
+	if (!c.fields.empty()) {
+		fprintf(c.out, ",%s\n", c.fields.c_str());
+	} else {
+		for (int i = 0; i < count; i++) {
+			fprintf(c.out, ",f%d", i);
+		}
+		fprintf(c.out, "\n");
+	}
+	return c.out;
+}
+
+static void writeSample(FILE* out, const Sample& s) {
+	fprintf(out, "%.6f", s.time);
+	for (size_t i = 0; i < s.values.size(); i++) {
+		fprintf(out, ",%g", s.values[i]);
+	}
+	fprintf(out, "\n");
+}
+
+/**
+ * Write out what was held back for the channel, now that its
+ * columns are known (or never will be).
+ */
+static void flushPending(Channel& c, int id) {
+	if (c.pending.empty()) {
+		return;
+	}
+	FILE* out = openCSV(c, id, c.pending[0].values.size());
+	if (out != NULL) {
+		for (size_t i = 0; i < c.pending.size(); i++) {
+			writeSample(out, c.pending[i]);
+		}
+	}
+	c.pending.clear();
+}
+
+/**
+ * Decode the binary record at `b`; returns its length,
+ * or 0 if it runs past `end`.
+ */
+static size_t decode(const uint8_t* b, const uint8_t* end) {
+	if (end - b < 5) {
+		return 0;
+	}
+	int id = get16(b + 2);
+	if (b[1] == Telemetry::kDefinition) {
+		const uint8_t* name = b + 5;
+		const uint8_t* name_end = (const uint8_t*) memchr(name, 0, end - name);
+		if (name_end == NULL) {
+			return 0;
+		}
+		const uint8_t* fields = name_end + 1;
+		const uint8_t* fields_end = (const uint8_t*) memchr(fields, 0, end
+				- fields);
+		if (fields_end == NULL) {
+			return 0;
+		}
+		Channel& c = channels[id];
+		if (!c.defined) {
+			c.defined = true;
+			c.name = (const char*) name;
+			c.fields = (const char*) fields;
+			flushPending(c, id);
+		}
+		return fields_end + 1 - b;
+	} else if (b[1] == Telemetry::kSample) {
+		if (end - b < 9) {
+			return 0;
+		}
+		int count = b[8];
+		size_t len = 9 + 4 * count;
+		if ((size_t) (end - b) < len) {
+			return 0;
+		}
+		Sample sample;
+		sample.time = toSeconds(get32(b + 4));
+		for (int i = 0; i < count; i++) {
+			uint32_t bits = get32(b + 9 + 4 * i);
+			float v;
+			memcpy(&v, &bits, sizeof(v));
+			sample.values.push_back(v);
+		}
+		Channel& c = channels[id];
+		if (!c.defined) {
+			// a capture started late; the definition is sent again
+			// every second, so hold on until it comes
+			c.pending.push_back(sample);
+		} else {
+			FILE* out = openCSV(c, id, count);
+			if (out != NULL) {
+				writeSample(out, sample);
+			}
+		}
+		return len;
+	}
+	fprintf(stderr, "unknown record type 0x%02x\n", b[1]);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s capture.bin [output_dir]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 2) {
+		outdir = argv[2];
+	}
+	FILE* in = fopen(argv[1], "rb");
+	if (in == NULL) {
+		fprintf(stderr, "cannot read %s\n", argv[1]);
+		return 1;
+	}
+	std::vector<uint8_t> data;
+	uint8_t chunk[4096];
+	size_t n;
+	while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+		data.insert(data.end(), chunk, chunk + n);
+	}
+	fclose(in);
+
+	const uint8_t* b = data.empty() ? NULL : &data[0];
+	const uint8_t* end = b + data.size();
+	size_t records = 0;
+	while (b < end) {
+		if (*b == Telemetry::kMarker) {
+			size_t len = decode(b, end);
+			if (len == 0) {
+				// truncated or corrupt; resynchronize at the next marker
+				b++;
+				continue;
+			}
+			records++;
+			b += len;
+		} else {
+			const uint8_t* text_end = b;
+			while (text_end < end && *text_end != Telemetry::kMarker) {
+				text_end++;
+			}
+			fwrite(b, 1, text_end - b, stdout);
+			b = text_end;
+		}
+	}
+
+	for (std::map<int, Channel>::iterator i = channels.begin(); i
+			!= channels.end(); i++) {
+		// never defined: placeholder names
+		flushPending(i->second, i->first);
+		if (i->second.out != NULL) {
+			fclose(i->second.out);
+		}
+	}
+	fprintf(stderr, "%lu records, %lu channels\n", (unsigned long) records,
+			(unsigned long) channels.size());
+	return 0;
+}
@@ -12,14 +12,26 @@
 #include "util/buttonlatch.h"
 #include "util/constants.h"
 #include "util/calc.h"
+#include "util/candriver.h"
+#include "util/canpipeline.h"
 #include "util/safecanjag.h"
+#include "util/canstatus.h"
 #include "util/lcdwriter.h"
 #include "util/threadless_pid.h"
 #include "util/udplog.h"
+#include "util/inputlog.h"
+#include "util/telemetry.h"
 #include "util/controllers.h"
 #include "util/profiler.h"
+#include "util/scheduler.h"
+#include "util/handoff.h"
+#include "util/executor.h"
 #include "util/multimotor.h"
+#include "util/bringup.h"
 #include "util/rollinggyro.h"
+#include "util/odometry.h"
+#include "util/motionprofile.h"
+#include "util/path.h"
 #include "util/misc.h"
 
 #endif
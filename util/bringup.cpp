@@ -0,0 +1,98 @@
+#include "bringup.h"
+#include "safecanjag.h"
+#include "Synchronized.h"
+#include "Task.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <string.h>
+
+// level with the robot's main task; it spends the time blocked
+const int WARMUP_PRIORITY = 101;
+const char* WARMUP_STAGE = "can warm-up";
+
+typedef struct {
+	const char* name;
+	double start;
+	// negative until it ends
+	double end;
+} Stage;
+
+static SEM_ID semaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+static Stage stages[Bringup::kMaxStages];
+static int num_stages = 0;
+
+static SEM_ID warmed_up = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+static Task* warmup = NULL;
+
+static int warmUp() {
+	Bringup::begin(WARMUP_STAGE);
+	// does nothing, as no Jaguar is in a sync group yet
+	SafeCANJag::UpdateSyncGroup(0);
+	Bringup::end(WARMUP_STAGE);
+	semGive(warmed_up);
+	return 0;
+}
+
+void Bringup::begin(const char* stage) {
+	Synchronized sync(semaphore);
+	if (num_stages == kMaxStages) {
+		printf("Bringup: too many stages; not timing %s\n", stage);
+		return;
+	}
+	Stage& s = stages[num_stages];
+	s.name = stage;
+	s.start = GetTime();
+	s.end = -1.0;
+	num_stages++;
+}
+
+void Bringup::end(const char* stage) {
+	Synchronized sync(semaphore);
+	for (int i = num_stages - 1; i >= 0; i--) {
+		if (stages[i].end < 0.0 && strcmp(stages[i].name, stage) == 0) {
+			stages[i].end = GetTime();
+			return;
+		}
+	}
+	printf("Bringup: %s never began\n", stage);
+}
+
+void Bringup::startCANWarmup() {
+	if (warmup != NULL) {
+		return;
+	}
+	warmup = new Task("CANWarmup", (FUNCPTR) warmUp, WARMUP_PRIORITY);
+	warmup->Start();
+}
+
+void Bringup::waitCANWarmup() {
+	if (warmup == NULL) {
+		startCANWarmup();
+	}
+	semTake(warmed_up, WAIT_FOREVER);
+	// for anyone else waiting
+	semGive(warmed_up);
+}
+
+void Bringup::ready() {
+	double now = GetTime();
+	Synchronized sync(semaphore);
+	double first = (num_stages > 0) ? stages[0].start : now;
+	for (int i = 1; i < num_stages; i++) {
+		if (stages[i].start < first) {
+			first = stages[i].start;
+		}
+	}
+	printf("Startup timeline (s):\n");
+	for (int i = 0; i < num_stages; i++) {
+		const Stage& s = stages[i];
+		if (s.end < 0.0) {
+			printf("  %-16s %7.3f  (running)\n", s.name, s.start - first);
+		} else {
+			printf("  %-16s %7.3f +%.3f\n", s.name, s.start - first, s.end
+					- s.start);
+		}
+	}
+	printf("Ready to enable at %.3f s, %.3f s after startup began\n", now,
+			now - first);
+}
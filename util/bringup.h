@@ -0,0 +1,45 @@
+#ifndef UTIL_BRINGUP_H_
+#define UTIL_BRINGUP_H_
+
+/**
+ * Robot startup, overlapped, and a timeline of it.
+ *
+ * The first CAN transaction after boot takes about two seconds while
+ * the driver comes up. startCANWarmup() takes that hit on a task of
+ * its own, so loading constants, making the subsystems and setting
+ * up sensors (none of which touch CAN) happen meanwhile; the Jaguars
+ * are then brought up all at once (MultiMotor::BringUpAll()).
+ *
+ * Example use:
+ *
+ * Bringup::begin("constants");
+ * Constants::load();
+ * Bringup::end("constants");
+ * ...
+ * Bringup::ready();
+ *
+ * prints each stage's start and length, and when the robot could
+ * first be enabled. Stages may overlap, and run on any task.
+ */
+namespace Bringup {
+const int kMaxStages = 16;
+
+void begin(const char* stage);
+void end(const char* stage);
+
+/**
+ * Make the first CAN transaction, on a new task.
+ */
+void startCANWarmup();
+/**
+ * Block until that transaction is done.
+ */
+void waitCANWarmup();
+
+/**
+ * Mark the robot ready to enable, and print the timeline.
+ */
+void ready();
+}
+
+#endif
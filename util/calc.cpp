@@ -1,4 +1,5 @@
 #include "calc.h"
+#include <math.h>
 
 double scaleLinear(double v, double old_min, double old_max,
 		double new_min, double new_max) {
@@ -14,3 +15,190 @@ double bound(double v, double min, double max) {
 	}
 	return v;
 }
+
+/**
+ * Brent's method on [a, b]; leaves the cost of the result in *fbest.
+ */
+static double brent(CostFunction cost, void* arg, double a, double b,
+		double tolerance, double* fbest, int* evals) {
+	// (3 - sqrt(5)) / 2: the golden section of an interval
+	const double kGolden = 0.3819660112501051;
+	// keeps the tolerance meaningful near x = 0
+	const double kRelative = 1.0e-8;
+
+	double lo = a;
+	double hi = b;
+	// x: best so far; w: second best; v: previous w
+	double x = lo + kGolden * (hi - lo);
+	double w = x;
+	double v = x;
+	double fx = cost(arg, x);
+	double fw = fx;
+	double fv = fx;
+	int n = 1;
+	// d: the last step; e: the step before it
+	double d = 0.0;
+	double e = 0.0;
+
+	while (true) {
+		double mid = 0.5 * (lo + hi);
+		double tol1 = kRelative * fabs(x) + tolerance / 3.0;
+		double tol2 = 2.0 * tol1;
+		if (fabs(x - mid) <= tol2 - 0.5 * (hi - lo)) {
+			break;
+		}
+
+		bool golden = true;
+		if (fabs(e) > tol1) {
+			// vertex of the parabola through x, w and v
+			double r = (x - w) * (fx - fv);
+			double q = (x - v) * (fx - fw);
+			double p = (x - v) * q - (x - w) * r;
+			q = 2.0 * (q - r);
+			if (q > 0.0) {
+				p = -p;
+			} else {
+				q = -q;
+			}
+			double last = e;
+			e = d;
+			// only trust it if it falls inside the bracket and
+			// moves less than half the step before last
+			if (fabs(p) < fabs(0.5 * q * last) && p > q * (lo - x) && p < q
+					* (hi - x)) {
+				d = p / q;
+				double u = x + d;
+				if (u - lo < tol2 || hi - u < tol2) {
+					d = (x < mid) ? tol1 : -tol1;
+				}
+				golden = false;
+			}
+		}
+		if (golden) {
+			e = (x < mid) ? hi - x : lo - x;
+			d = kGolden * e;
+		}
+
+		double u;
+		if (fabs(d) >= tol1) {
+			u = x + d;
+		} else {
+			u = x + ((d > 0.0) ? tol1 : -tol1);
+		}
+		double fu = cost(arg, u);
+		n++;
+
+		if (fu <= fx) {
+			if (u < x) {
+				hi = x;
+			} else {
+				lo = x;
+			}
+			v = w;
+			fv = fw;
+			w = x;
+			fw = fx;
+			x = u;
+			fx = fu;
+		} else {
+			if (u < x) {
+				lo = u;
+			} else {
+				hi = u;
+			}
+			if (fu <= fw || w == x) {
+				v = w;
+				fv = fw;
+				w = u;
+				fw = fu;
+			} else if (fu <= fv || v == x || v == w) {
+				v = u;
+				fv = fu;
+			}
+		}
+	}
+
+	// interior steps never land on the bounds themselves,
+	// where saturated costs often have their minimum
+	double edge = (x - a < b - x) ? a : b;
+	if (fabs(x - edge) < tolerance) {
+		double fe = cost(arg, edge);
+		n++;
+		if (fe <= fx) {
+			x = edge;
+			fx = fe;
+		}
+	}
+
+	if (evals != 0) {
+		*evals += n;
+	}
+	*fbest = fx;
+	return x;
+}
+
+double minimize(CostFunction cost, void* arg, double min, double max,
+		double tolerance, int* evals) {
+	double fx;
+	return brent(cost, arg, min, max, tolerance, &fx, evals);
+}
+
+double minimizeTernary(CostFunction cost, void* arg, double min,
+		double max, int generations, int* evals) {
+	cost(arg, max);
+	cost(arg, min);
+	for (int gen = 0; gen < generations; gen++) {
+		double low = (min * 2 + max) * 0.333333333333333333333333;
+		double high = (max * 2 + min) * 0.333333333333333333333333;
+		double score_high = cost(arg, high);
+		double score_low = cost(arg, low);
+
+		if (score_high >= score_low) {
+			max = high;
+		}
+		if (score_low >= score_high) {
+			min = low;
+		}
+	}
+	if (evals != 0) {
+		*evals += 2 + 2 * generations;
+	}
+	return (max + min) * 0.5;
+}
+
+double scoreOne(void* arg, double x) {
+	ScalarCost* s = (ScalarCost*) arg;
+	double cost;
+	s->cost(s->arg, &x, &cost, 1);
+	return cost;
+}
+
+double minimizeGrid(BatchCostFunction cost, void* arg, double min,
+		double max, double tolerance, int* evals) {
+	double x[kMinimizeBatch];
+	double f[kMinimizeBatch];
+	double step = (max - min) / (kMinimizeBatch - 1);
+	for (int i = 0; i < kMinimizeBatch; i++) {
+		x[i] = min + step * i;
+	}
+	x[kMinimizeBatch - 1] = max;
+	cost(arg, x, f, kMinimizeBatch);
+	if (evals != 0) {
+		*evals += kMinimizeBatch;
+	}
+
+	int best = 0;
+	for (int i = 1; i < kMinimizeBatch; i++) {
+		if (f[i] < f[best]) {
+			best = i;
+		}
+	}
+	// the best point's neighbours bracket the minimum
+	double lo = x[(best > 0) ? best - 1 : best];
+	double hi = x[(best < kMinimizeBatch - 1) ? best + 1 : best];
+
+	ScalarCost scalar = { cost, arg };
+	double fx;
+	double xbest = brent(scoreOne, &scalar, lo, hi, tolerance, &fx, evals);
+	return (fx <= f[best]) ? xbest : x[best];
+}
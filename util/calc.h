@@ -6,4 +6,65 @@ double scaleLinear(double v, double old_min, double old_max,
 
 double bound(double v, double min, double max);
 
+/**
+ * A cost to minimize; `arg` is passed through from the minimizer.
+ */
+typedef double (*CostFunction)(void* arg, double x);
+
+/**
+ * Minimize a unimodal cost over [min, max] with Brent's method:
+ * golden-section steps, which reuse one interior point each time,
+ * and parabolic steps wherever the cost looks smooth. Stops once
+ * the minimum is pinned down to within `tolerance`.
+ * 
+ * If `evals` is not NULL, the number of cost evaluations
+ * is added to it.
+ */
+double minimize(CostFunction cost, void* arg, double min, double max,
+		double tolerance, int* evals = 0);
+
+/**
+ * Minimize by ternary search, for a fixed number of generations
+ * (2 + 2 * generations evaluations).
+ */
+double minimizeTernary(CostFunction cost, void* arg, double min,
+		double max, int generations, int* evals = 0);
+
+/**
+ * Number of candidates minimizeGrid() hands to its cost at once.
+ */
+const int kMinimizeBatch = 8;
+
+/**
+ * A cost that scores `n` candidates `x` in one call, into `cost`.
+ */
+typedef void (*BatchCostFunction)(void* arg, const double* x, double* cost,
+		int n);
+
+/**
+ * A batch cost and its argument, to hand to scoreOne().
+ */
+typedef struct {
+	BatchCostFunction cost;
+	void* arg;
+} ScalarCost;
+
+/**
+ * A CostFunction that scores one candidate with a batch
+ * cost; `scalar` is a ScalarCost*.
+ */
+double scoreOne(void* scalar, double x);
+
+/**
+ * Minimize over [min, max]: one batch scores kMinimizeBatch evenly
+ * spaced points (the bounds included), then Brent's method refines
+ * the minimum between the neighbours of the best of them.
+ *
+ * The grid sees the whole range at once, so it is not fooled by
+ * plateaus or shallow local minima, and it leaves Brent's method a
+ * bracket a quarter the size.
+ */
+double minimizeGrid(BatchCostFunction cost, void* arg, double min,
+		double max, double tolerance, int* evals = 0);
+
 #endif
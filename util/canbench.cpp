@@ -0,0 +1,47 @@
+#include "canbench.h"
+#include "candriver.h"
+#include "multimotor.h"
+#include <stdio.h>
+
+void RunCANBenchmark(const double* ack_latencies, int count, int trials) {
+	const uint8_t ids[6] = { 11, 12, 13, 14, 15, 16 };
+	const uint8_t sync = 0x01;
+
+	SimCANDriver sim;
+	CANDriver::set(&sim);
+	{
+		MultiMotor group(ids[0], ids[1], ids[2], ids[3], ids[4], ids[5], false);
+
+		printf("ack latency   serial Set   batched Set   speedup\n");
+		for (int k = 0; k < count; k++) {
+			sim.setAckLatency(ack_latencies[k]);
+
+			// the old path: every write waits for its own ack
+			double start = sim.now();
+			for (int t = 0; t < trials; t++) {
+				double v = (t % 2) ? 0.5 : -0.5;
+				for (int i = 0; i < 6; i++) {
+					group.GetIdx(i)->Set(v, sync);
+				}
+				SafeCANJag::UpdateSyncGroup(sync);
+			}
+			double serial = (sim.now() - start) / trials;
+
+			start = sim.now();
+			for (int t = 0; t < trials; t++) {
+				group.Set((t % 2) ? 0.5 : -0.5);
+			}
+			double batched = (sim.now() - start) / trials;
+
+			printf("%8.3f ms  %8.3f ms   %8.3f ms   %6.2fx\n",
+					ack_latencies[k] * 1000.0, serial * 1000.0,
+					batched * 1000.0, (batched > 0) ? serial / batched : 0.0);
+		}
+	}
+	CANDriver::set(NULL);
+}
+
+void canbench() {
+	const double latencies[] = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025 };
+	RunCANBenchmark(latencies, sizeof(latencies) / sizeof(latencies[0]));
+}
@@ -0,0 +1,23 @@
+#ifndef UTIL_CANBENCH_H_
+#define UTIL_CANBENCH_H_
+
+/**
+ * Compare the command latency of a six-motor MultiMotor group
+ * written one acked Set() at a time against the batched
+ * MultiMotor::Set(), on a SimCANDriver with each of the given
+ * ack latencies (in seconds). Times are on the simulated bus clock,
+ * so the results do not depend on the host.
+ *
+ * Swaps the installed CANDriver for the duration of the run,
+ * so never call this with motors in use.
+ */
+void RunCANBenchmark(const double* ack_latencies, int count, int trials =
+		100);
+
+/**
+ * RunCANBenchmark with a range of typical latencies
+ * (callable from the vxWorks shell).
+ */
+extern "C" void canbench();
+
+#endif
@@ -0,0 +1,268 @@
+#include "candriver.h"
+#define tNIRIO_i32 int
+#include "ChipObject/NiFpga.h"
+#include "CAN/JaguarCANDriver.h"
+#include "CAN/can_proto.h"
+#include "Timer.h"
+#include <string.h>
+
+#define kFullMessageIDMask (CAN_MSGID_API_M | CAN_MSGID_MFR_M | CAN_MSGID_DTYPE_M)
+
+/**
+ * Forwards straight to FRC_NetworkCommunication.
+ */
+class FRCCANDriver: public CANDriver {
+public:
+	virtual int32_t sendMessage(uint32_t messageID, const uint8_t *data,
+			uint8_t dataSize) {
+		int32_t status = 0;
+		FRC_NetworkCommunication_JaguarCANDriver_sendMessage(messageID, data,
+				dataSize, &status);
+		return status;
+	}
+	virtual int32_t receiveMessage(uint32_t *messageID, uint8_t *data,
+			uint8_t *dataSize, uint32_t timeoutMs) {
+		int32_t status = 0;
+		FRC_NetworkCommunication_JaguarCANDriver_receiveMessage(messageID,
+				data, dataSize, timeoutMs, &status);
+		return status;
+	}
+};
+
+static FRCCANDriver frc_driver;
+static CANDriver* installed = &frc_driver;
+
+const int32_t CANDriver::kTimeout;
+
+CANDriver::~CANDriver() {
+}
+
+double CANDriver::now() {
+	return GetTime();
+}
+
+CANDriver* CANDriver::get() {
+	return installed;
+}
+
+void CANDriver::set(CANDriver* driver) {
+	installed = (driver == NULL) ? &frc_driver : driver;
+}
+
+bool CANDriver::isTrusted(uint32_t messageID) {
+	static const uint32_t kTrustedMessages[] = { LM_API_VOLT_T_EN,
+			LM_API_VOLT_T_SET, LM_API_SPD_T_EN, LM_API_SPD_T_SET,
+			LM_API_VCOMP_T_EN, LM_API_VCOMP_T_SET, LM_API_POS_T_EN,
+			LM_API_POS_T_SET, LM_API_ICTRL_T_EN, LM_API_ICTRL_T_SET };
+
+	for (uint8_t i = 0; i < (sizeof(kTrustedMessages)
+			/ sizeof(kTrustedMessages[0])); i++) {
+		if ((kFullMessageIDMask & messageID) == kTrustedMessages[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// A fresh Jaguar on the FIRST approved firmware
+const uint32_t SIM_FIRMWARE_VERSION = 108;
+
+SimCANDriver::SimCANDriver(double ack, double frame) :
+	ack_latency(ack), frame_time(frame), clock(0.0), bus_free(0.0), sent(0),
+			received(0), absent(0) {
+}
+
+SimCANDriver::~SimCANDriver() {
+}
+
+int32_t SimCANDriver::sendMessage(uint32_t messageID, const uint8_t *data,
+		uint8_t dataSize) {
+	// bit 31 only marks remote frames for the 2CAN
+	messageID &= 0x1FFFFFFF;
+	sent++;
+
+	double start = (bus_free > clock) ? bus_free : clock;
+	bus_free = start + frame_time;
+
+	uint8_t device = messageID & CAN_MSGID_DEVNO_M;
+	uint32_t api = messageID & kFullMessageIDMask;
+	if (device == 0 || (absent & (1ULL << device))) {
+		// broadcasts (e.g. sync group updates) are never acked
+		return 0;
+	}
+
+	if (!isTrusted(messageID) && dataSize == 0) {
+		Register r;
+		r.size = getRegister(device, api, r.data);
+		if (api == CAN_MSGID_API_FIRMVER && r.size == sizeof(uint32_t)) {
+			// the wire is little-endian
+			for (uint8_t i = 0; i < sizeof(uint32_t); i++) {
+				r.data[i] = (SIM_FIRMWARE_VERSION >> (8 * i)) & 0xFF;
+			}
+		}
+		reply(messageID, r.data, r.size);
+		return 0;
+	}
+
+	if (isTrusted(messageID)) {
+		data += 2;
+		dataSize -= 2;
+	}
+
+	// setpoints are written through the trusted API
+	// but read back through the plain one
+	static const uint32_t kReadback[][2] = { { LM_API_VOLT_T_SET,
+			LM_API_VOLT_SET }, { LM_API_SPD_T_SET, LM_API_SPD_SET }, {
+			LM_API_POS_T_SET, LM_API_POS_SET }, { LM_API_ICTRL_T_SET,
+			LM_API_ICTRL_SET }, { LM_API_VCOMP_T_SET, LM_API_VCOMP_SET } };
+	for (uint8_t i = 0; i < sizeof(kReadback) / sizeof(kReadback[0]); i++) {
+		if (api == kReadback[i][0]) {
+			api = kReadback[i][1];
+			// drop the trailing sync group byte
+			if (dataSize > defaultSize(api)) {
+				dataSize = defaultSize(api);
+			}
+		}
+	}
+	if (api == LM_API_STATUS_POWER) {
+		// writing 1 clears the power cycled flag
+		uint8_t cleared = 0;
+		setRegister(device, api, &cleared, sizeof(cleared));
+	} else if (dataSize > 0) {
+		setRegister(device, api, data, dataSize);
+	}
+
+	reply(LM_API_ACK | device, NULL, 0);
+	return 0;
+}
+
+int32_t SimCANDriver::receiveMessage(uint32_t *messageID, uint8_t *data,
+		uint8_t *dataSize, uint32_t timeoutMs) {
+	double limit = clock + timeoutMs * 0.001;
+
+	std::deque<Frame>::iterator best = in_flight.end();
+	for (std::deque<Frame>::iterator i = in_flight.begin(); i
+			!= in_flight.end(); i++) {
+		if (i->id == *messageID && (best == in_flight.end() || i->due
+				< best->due)) {
+			best = i;
+		}
+	}
+
+	if (best == in_flight.end() || best->due > limit) {
+		clock = limit;
+		if (dataSize != NULL) {
+			*dataSize = 0;
+		}
+		return kTimeout;
+	}
+
+	if (best->due > clock) {
+		clock = best->due;
+	}
+	if (data != NULL) {
+		memcpy(data, best->data, best->size);
+	}
+	if (dataSize != NULL) {
+		*dataSize = best->size;
+	}
+	in_flight.erase(best);
+	received++;
+	return 0;
+}
+
+double SimCANDriver::now() {
+	return clock;
+}
+
+void SimCANDriver::setAckLatency(double seconds) {
+	ack_latency = seconds;
+}
+
+void SimCANDriver::setPresent(uint8_t device, bool present) {
+	if (present) {
+		absent &= ~(1ULL << device);
+	} else {
+		absent |= (1ULL << device);
+	}
+}
+
+void SimCANDriver::setRegister(uint8_t device, uint32_t api,
+		const uint8_t *data, uint8_t dataSize) {
+	Register r;
+	memcpy(r.data, data, dataSize);
+	r.size = dataSize;
+	registers[api | device] = r;
+}
+
+uint8_t SimCANDriver::getRegister(uint8_t device, uint32_t api, uint8_t *data) {
+	std::map<uint32_t, Register>::iterator i = registers.find(api | device);
+	if (i == registers.end()) {
+		uint8_t size = defaultSize(api);
+		memset(data, 0, size);
+		return size;
+	}
+	memcpy(data, i->second.data, i->second.size);
+	return i->second.size;
+}
+
+void SimCANDriver::advance(double seconds) {
+	clock += seconds;
+}
+
+int SimCANDriver::getFramesSent() {
+	return sent;
+}
+
+int SimCANDriver::getFramesReceived() {
+	return received;
+}
+
+void SimCANDriver::reply(uint32_t id, const uint8_t *data, uint8_t size) {
+	Frame f;
+	f.id = id;
+	if (data != NULL) {
+		memcpy(f.data, data, size);
+	}
+	f.size = size;
+	f.due = bus_free + ack_latency + frame_time;
+	in_flight.push_back(f);
+}
+
+uint8_t SimCANDriver::defaultSize(uint32_t api) {
+	switch (api) {
+	case LM_API_STATUS_LIMIT:
+	case LM_API_STATUS_POWER:
+	case LM_API_STATUS_CMODE:
+	case LM_API_SPD_REF:
+	case LM_API_POS_REF:
+		return 1;
+	case LM_API_VOLT_SET:
+	case LM_API_ICTRL_SET:
+	case LM_API_VCOMP_SET:
+	case LM_API_STATUS_VOLTBUS:
+	case LM_API_STATUS_VOUT:
+	case LM_API_STATUS_CURRENT:
+	case LM_API_STATUS_TEMP:
+	case LM_API_STATUS_FAULT:
+	case LM_API_HWVER:
+		return 2;
+	case LM_API_SPD_SET:
+	case LM_API_POS_SET:
+	case LM_API_STATUS_POS:
+	case LM_API_STATUS_SPD:
+	case LM_API_SPD_PC:
+	case LM_API_SPD_IC:
+	case LM_API_SPD_DC:
+	case LM_API_POS_PC:
+	case LM_API_POS_IC:
+	case LM_API_POS_DC:
+	case LM_API_ICTRL_PC:
+	case LM_API_ICTRL_IC:
+	case LM_API_ICTRL_DC:
+	case CAN_MSGID_API_FIRMVER:
+		return 4;
+	default:
+		return 0;
+	}
+}
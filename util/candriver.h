@@ -0,0 +1,124 @@
+#ifndef UTIL_CANDRIVER_H_
+#define UTIL_CANDRIVER_H_
+
+#include <vxWorks.h>
+#include <deque>
+#include <map>
+
+/**
+ * The transport underneath every Jaguar transaction. The default
+ * driver forwards to FRC_NetworkCommunication_JaguarCANDriver_*;
+ * a SimCANDriver can be installed in its place so the CAN code
+ * runs without a robot.
+ *
+ * receiveMessage only returns frames whose ID matches *messageID
+ * exactly, just like the real driver.
+ */
+class CANDriver {
+public:
+	/**
+	 * Status reported when receiveMessage times out. SafeCANJag
+	 * keeps talking to a device after this error, unlike others.
+	 */
+	static const int32_t kTimeout = -44087;
+
+	virtual ~CANDriver();
+
+	virtual int32_t sendMessage(uint32_t messageID, const uint8_t *data,
+			uint8_t dataSize) = 0;
+	virtual int32_t receiveMessage(uint32_t *messageID, uint8_t *data,
+			uint8_t *dataSize, uint32_t timeoutMs) = 0;
+
+	/**
+	 * Seconds, on the clock that receive timeouts are measured against.
+	 */
+	virtual double now();
+
+	/**
+	 * The installed driver. Passing NULL to set() restores
+	 * the FRC driver.
+	 */
+	static CANDriver* get();
+	static void set(CANDriver* driver);
+
+	/**
+	 * Trusted messages carry a 2-byte token ahead of their payload.
+	 */
+	static bool isTrusted(uint32_t messageID);
+};
+
+/**
+ * In-process stand-in for a bus full of Jaguars, on a virtual clock.
+ *
+ * Every device number answers: writes are stored and acked, reads
+ * return the last value written to that API (or zeros of the right
+ * size). Each frame occupies the bus for `frame_time` seconds and the
+ * Jaguar answers `ack_latency` seconds after the frame lands. Blocking
+ * in receiveMessage advances the virtual clock instead of sleeping, so
+ * now() reports how long the exchange would have taken on a real bus.
+ *
+ * This class is NOT threadsafe.
+ */
+class SimCANDriver: public CANDriver {
+public:
+	SimCANDriver(double ack_latency = 0.0005, double frame_time = 0.00013);
+	virtual ~SimCANDriver();
+
+	virtual int32_t sendMessage(uint32_t messageID, const uint8_t *data,
+			uint8_t dataSize);
+	virtual int32_t receiveMessage(uint32_t *messageID, uint8_t *data,
+			uint8_t *dataSize, uint32_t timeoutMs);
+	virtual double now();
+
+	void setAckLatency(double seconds);
+	/**
+	 * A device that is not present never answers.
+	 */
+	void setPresent(uint8_t device, bool present);
+	/**
+	 * Set the value a device reports for a read of `api`
+	 * (an LM_API_* message ID without the device number).
+	 */
+	void setRegister(uint8_t device, uint32_t api, const uint8_t *data,
+			uint8_t dataSize);
+	/**
+	 * Copies the stored value into `data` and returns its size.
+	 * If nothing is stored, fills in zeros of the size a read
+	 * of `api` normally returns.
+	 */
+	uint8_t getRegister(uint8_t device, uint32_t api, uint8_t *data);
+
+	/**
+	 * Let virtual time pass without any bus activity.
+	 */
+	void advance(double seconds);
+
+	int getFramesSent();
+	int getFramesReceived();
+private:
+	typedef struct {
+		uint32_t id;
+		uint8_t data[8];
+		uint8_t size;
+		double due;
+	} Frame;
+	typedef struct {
+		uint8_t data[8];
+		uint8_t size;
+	} Register;
+
+	void reply(uint32_t id, const uint8_t *data, uint8_t size);
+	uint8_t defaultSize(uint32_t api);
+
+	double ack_latency;
+	double frame_time;
+	double clock;
+	double bus_free;
+	int sent;
+	int received;
+	uint64_t absent;
+	std::deque<Frame> in_flight;
+	std::map<uint32_t, Register> registers;
+};
+
+#endif
@@ -0,0 +1,208 @@
+#include "canpipeline.h"
+#include "candriver.h"
+#include "safecanjag.h"
+#include "CAN/can_proto.h"
+#include <stdio.h>
+#include <string.h>
+
+bool CANTransaction::isDone() const {
+	return done;
+}
+
+bool CANTransaction::succeeded() const {
+	return done && status == 0;
+}
+
+int32_t CANTransaction::getStatus() const {
+	return status;
+}
+
+uint8_t CANTransaction::getDevice() const {
+	return device;
+}
+
+uint32_t CANTransaction::getMessageID() const {
+	return messageID;
+}
+
+uint8_t* CANTransaction::getData() {
+	return data;
+}
+
+uint8_t CANTransaction::getDataSize() const {
+	return dataSize;
+}
+
+uint32_t CANTransaction::replyID() const {
+	if (is_set) {
+		return LM_API_ACK | device;
+	}
+	// Caller may have set bit31 for remote frame transmission so clear invalid bits[31-29]
+	return (messageID | device) & 0x1FFFFFFF;
+}
+
+const int CANPipeline::kMaxTransactions;
+
+CANPipeline::CANPipeline() :
+	count(0), next(0), failed(0), wave_size(0) {
+}
+
+CANTransaction* CANPipeline::queue(uint8_t device, uint32_t messageID,
+		const uint8_t *data, uint8_t dataSize, bool is_set, SEM_ID lock,
+		CANCallback callback, void* arg) {
+	if (count >= kMaxTransactions) {
+		printf("CANPipeline full; dropped message to %d\n", device);
+		return NULL;
+	}
+	CANTransaction* t = &slots[count];
+	count++;
+
+	t->messageID = messageID;
+	t->device = device;
+	t->is_set = is_set;
+	t->dataSize = dataSize;
+	if (dataSize > 0) {
+		memcpy(t->data, data, dataSize);
+	}
+	t->status = 0;
+	t->done = false;
+	t->lock = lock;
+	t->callback = callback;
+	t->arg = arg;
+	waiting[count - 1] = true;
+	return t;
+}
+
+CANTransaction* CANPipeline::queueGet(uint8_t device, uint32_t messageID,
+		SEM_ID lock, CANCallback callback, void* arg) {
+	return queue(device, messageID, NULL, 0, false, lock, callback, arg);
+}
+
+CANTransaction* CANPipeline::queueSet(uint8_t device, uint32_t messageID,
+		const uint8_t *data, uint8_t dataSize, SEM_ID lock,
+		CANCallback callback, void* arg) {
+	return queue(device, messageID, data, dataSize, true, lock, callback, arg);
+}
+
+void CANPipeline::send() {
+	if (wave_size > 0) {
+		return;
+	}
+	CANDriver* driver = CANDriver::get();
+
+	// Pick the wave: no two members may expect the same reply,
+	// and once a device has a deferred transaction, everything
+	// after it for that device waits too, to keep queue order.
+	uint64_t deferred = 0;
+	for (int i = next; i < count; i++) {
+		if (!waiting[i]) {
+			continue;
+		}
+		CANTransaction& t = slots[i];
+		bool clash = (deferred & (1ULL << t.device)) != 0;
+		for (int j = 0; j < wave_size && !clash; j++) {
+			clash = slots[wave[j]].replyID() == t.replyID();
+		}
+		if (clash) {
+			deferred |= (1ULL << t.device);
+		} else {
+			wave[wave_size] = i;
+			wave_size++;
+		}
+	}
+
+	for (int j = 0; j < wave_size; j++) {
+		CANTransaction& t = slots[wave[j]];
+		// Make sure we don't have more than one transaction with the same Jaguar outstanding.
+		if (t.lock != NULL) {
+			semTake(t.lock, WAIT_FOREVER);
+		}
+		// Throw away any stale replies.
+		uint32_t reply = t.replyID();
+		driver->receiveMessage(&reply, NULL, NULL, 0);
+	}
+
+	for (int j = 0; j < wave_size; j++) {
+		CANTransaction& t = slots[wave[j]];
+		t.status = SafeCANJag::sendMessage(t.messageID | t.device, t.data,
+				t.dataSize);
+	}
+
+	// A read's reply has its own message ID, which no write to the
+	// Jaguar waits for; so only writes hold the lock until collected,
+	// and a background read never holds up the main loop's writes.
+	for (int j = 0; j < wave_size; j++) {
+		CANTransaction& t = slots[wave[j]];
+		if (t.lock != NULL && !t.is_set) {
+			semGive(t.lock);
+		}
+	}
+}
+
+void CANPipeline::collect(double deadline) {
+	CANDriver* driver = CANDriver::get();
+
+	for (int j = 0; j < wave_size; j++) {
+		CANTransaction& t = slots[wave[j]];
+		if (t.status == 0) {
+			double remaining = deadline - driver->now();
+			uint32_t ms = 0;
+			if (remaining > 0) {
+				ms = (uint32_t) (remaining * 1000.0 + 0.999);
+			}
+			uint32_t reply = t.replyID();
+			if (t.is_set) {
+				t.status = driver->receiveMessage(&reply, NULL, NULL, ms);
+			} else {
+				t.status = driver->receiveMessage(&reply, t.data, &t.dataSize,
+						ms);
+			}
+		}
+		if (t.status != 0) {
+			t.dataSize = 0;
+			failed++;
+			printf("Error is on CANJaguar %d\n", t.device);
+		} else if (t.is_set) {
+			t.dataSize = 0;
+		}
+
+		if (t.lock != NULL && t.is_set) {
+			semGive(t.lock);
+		}
+		t.done = true;
+		waiting[wave[j]] = false;
+		if (t.callback != NULL) {
+			t.callback(&t, t.arg);
+		}
+	}
+	wave_size = 0;
+}
+
+int CANPipeline::flush(double timeout) {
+	double deadline = CANDriver::get()->now() + timeout;
+	failed = 0;
+
+	while (true) {
+		send();
+		if (wave_size == 0) {
+			break;
+		}
+		collect(deadline);
+	}
+
+	next = count;
+	return failed;
+}
+
+void CANPipeline::clear() {
+	// a wave sent but never flushed still holds its writes' locks
+	if (wave_size > 0) {
+		flush();
+	}
+	count = 0;
+	next = 0;
+}
+
+int CANPipeline::pending() {
+	return count - next;
+}
@@ -0,0 +1,141 @@
+#ifndef UTIL_CANPIPELINE_H_
+#define UTIL_CANPIPELINE_H_
+
+#include <vxWorks.h>
+#include <semLib.h>
+
+class CANTransaction;
+
+/**
+ * Called from CANPipeline::flush() as each transaction completes,
+ * whether or not it succeeded.
+ */
+typedef void (*CANCallback)(CANTransaction* t, void* arg);
+
+/**
+ * A single exchange with a Jaguar, queued on a CANPipeline.
+ * Acts as a future: the status and data are only meaningful
+ * once isDone() returns true.
+ */
+class CANTransaction {
+public:
+	bool isDone() const;
+	/**
+	 * True iff the transaction is done and the reply arrived.
+	 */
+	bool succeeded() const;
+	int32_t getStatus() const;
+	uint8_t getDevice() const;
+	/**
+	 * The message ID as queued, without the device number.
+	 */
+	uint32_t getMessageID() const;
+	/**
+	 * The reply payload of a read; empty for writes.
+	 */
+	uint8_t* getData();
+	uint8_t getDataSize() const;
+private:
+	friend class CANPipeline;
+
+	uint32_t replyID() const;
+
+	uint32_t messageID;
+	uint8_t device;
+	bool is_set;
+	uint8_t data[8];
+	uint8_t dataSize;
+	int32_t status;
+	bool done;
+	SEM_ID lock;
+	CANCallback callback;
+	void* arg;
+};
+
+/**
+ * Asynchronous transaction engine for Jaguars.
+ *
+ * Requests to any number of devices are queued, then flush()
+ * sends them all back-to-back and collects the acks and replies
+ * against a single deadline. Reading one value from each of N
+ * Jaguars thus costs about one bus round trip, rather than N.
+ *
+ * Replies can only be told apart by message ID, so transactions
+ * expecting the same reply (e.g. two writes to one Jaguar, which
+ * both get LM_API_ACK) are split into successive waves, in queue
+ * order.
+ *
+ * Transactions belong to the pipeline; pointers returned by
+ * queueGet/queueSet are valid until clear() is called.
+ *
+ * This class is NOT threadsafe.
+ */
+class CANPipeline {
+public:
+	static const int kMaxTransactions = 128;
+
+	CANPipeline();
+
+	/**
+	 * Queue a read of `messageID` (device number is added internally).
+	 * `lock`, if given, is held while the request is sent.
+	 *
+	 * Returns NULL if the pipeline is full.
+	 */
+	CANTransaction* queueGet(uint8_t device, uint32_t messageID,
+			SEM_ID lock = NULL, CANCallback callback = NULL, void* arg = NULL);
+	/**
+	 * Queue a write of up to 8 bytes to `messageID`, which
+	 * completes when the Jaguar acks. `lock`, if given, is held
+	 * until then.
+	 *
+	 * Returns NULL if the pipeline is full.
+	 */
+	CANTransaction* queueSet(uint8_t device, uint32_t messageID,
+			const uint8_t *data, uint8_t dataSize, SEM_ID lock = NULL,
+			CANCallback callback = NULL, void* arg = NULL);
+
+	/**
+	 * Put the next wave of queued transactions on the bus without
+	 * waiting for any replies. Useful to overlap other traffic (like
+	 * a sync group update) with the round trip; flush() collects
+	 * the replies.
+	 */
+	void send();
+
+	/**
+	 * Run every queued transaction; waits no longer
+	 * than `timeout` seconds in total.
+	 *
+	 * Returns the number of transactions that failed.
+	 */
+	int flush(double timeout = 0.02);
+
+	/**
+	 * Forget all transactions, done or not.
+	 */
+	void clear();
+
+	/**
+	 * Number of queued transactions that have not been flushed.
+	 */
+	int pending();
+private:
+	CANTransaction* queue(uint8_t device, uint32_t messageID,
+			const uint8_t *data, uint8_t dataSize, bool is_set, SEM_ID lock,
+			CANCallback callback, void* arg);
+
+	void collect(double deadline);
+
+	CANTransaction slots[kMaxTransactions];
+	int count;
+	int next;
+	int failed;
+
+	// the wave on the bus
+	int wave[kMaxTransactions];
+	int wave_size;
+	bool waiting[kMaxTransactions];
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "canstatus.h"
+#include "CAN/can_proto.h"
+#include "Synchronized.h"
+#include "Timer.h"
+
+constexpr double CANStatusPoller::kDefaultPeriod;
+const int CANStatusPoller::kStaleCycles;
+
+// indexed by SafeCANJag::StatusField
+static const uint32_t kStatusMessages[SafeCANJag::kNumStatusFields] = {
+		LM_API_STATUS_VOLTBUS, LM_API_STATUS_VOUT, LM_API_STATUS_CURRENT,
+		LM_API_STATUS_TEMP, LM_API_STATUS_POS, LM_API_STATUS_SPD,
+		LM_API_STATUS_LIMIT, LM_API_STATUS_FAULT };
+
+// below the robot's main task
+const int32_t POLLER_PRIORITY = 105;
+
+CANStatusPoller* CANStatusPoller::GetInstance() {
+	static CANStatusPoller* instance = NULL;
+	if (instance == NULL) {
+		instance = new CANStatusPoller();
+	}
+	return instance;
+}
+
+CANStatusPoller::CANStatusPoller() :
+	task("CANStatusPoller", (FUNCPTR) CANStatusPoller::callRun,
+			POLLER_PRIORITY), period(kDefaultPeriod), running(false),
+			started(false) {
+	semaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+	wake = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+}
+
+void CANStatusPoller::Add(SafeCANJag* jag, uint16_t fields) {
+	if (jag == NULL) {
+		return;
+	}
+	Synchronized sync(semaphore);
+	Entry* entry = NULL;
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].jag == jag) {
+			entry = &entries[i];
+		}
+	}
+	if (entry == NULL) {
+		Entry e = { jag, 0 };
+		entries.push_back(e);
+		entry = &entries.back();
+	}
+	entry->fields |= fields;
+
+	Synchronized status(jag->m_statusSemaphore);
+	jag->m_statusPolled = entry->fields;
+	jag->m_statusMaxAge = kStaleCycles * period;
+}
+
+void CANStatusPoller::Remove(SafeCANJag* jag) {
+	Synchronized sync(semaphore);
+	for (std::vector<Entry>::iterator i = entries.begin(); i != entries.end(); i++) {
+		if (i->jag == jag) {
+			entries.erase(i);
+			break;
+		}
+	}
+	Synchronized status(jag->m_statusSemaphore);
+	jag->m_statusPolled = 0;
+}
+
+void CANStatusPoller::SetPeriod(double seconds) {
+	Synchronized sync(semaphore);
+	period = seconds;
+	for (size_t i = 0; i < entries.size(); i++) {
+		SafeCANJag* jag = entries[i].jag;
+		Synchronized status(jag->m_statusSemaphore);
+		jag->m_statusMaxAge = kStaleCycles * period;
+	}
+}
+
+double CANStatusPoller::GetPeriod() {
+	return period;
+}
+
+void CANStatusPoller::Start() {
+	if (running) {
+		return;
+	}
+	running = true;
+	// the task never exits, so a restart resumes it
+	if (!started) {
+		started = true;
+		task.Start();
+	} else {
+		semGive(wake);
+	}
+}
+
+void CANStatusPoller::Stop() {
+	running = false;
+}
+
+int CANStatusPoller::callRun() {
+	GetInstance()->run();
+	return 0;
+}
+
+void CANStatusPoller::run() {
+	while (true) {
+		if (!running) {
+			semTake(wake, WAIT_FOREVER);
+			continue;
+		}
+		double start = GetTime();
+		poll();
+		double leftover = period - (GetTime() - start);
+		if (leftover > 0) {
+			Wait(leftover);
+		}
+	}
+}
+
+void CANStatusPoller::poll() {
+	Synchronized sync(semaphore);
+	pipe.clear();
+	for (size_t i = 0; i < entries.size(); i++) {
+		for (int f = 0; f < SafeCANJag::kNumStatusFields; f++) {
+			if (entries[i].fields & (1 << f)) {
+				entries[i].jag->getTransactionAsync(pipe, kStatusMessages[f],
+						CANStatusPoller::store, entries[i].jag);
+			}
+		}
+	}
+	// never let one slow poll eat the next period
+	pipe.flush(period < 0.02 ? period : 0.02);
+}
+
+void CANStatusPoller::store(CANTransaction* t, void* x) {
+	if (!t->succeeded()) {
+		return;
+	}
+	SafeCANJag* jag = (SafeCANJag*) x;
+	uint8_t* data = t->getData();
+	uint8_t size = t->getDataSize();
+
+	for (int f = 0; f < SafeCANJag::kNumStatusFields; f++) {
+		if (kStatusMessages[f] != t->getMessageID()) {
+			continue;
+		}
+		SafeCANJag::StatusField field = (SafeCANJag::StatusField) f;
+		switch (field) {
+		case SafeCANJag::kStatusPosition:
+		case SafeCANJag::kStatusSpeed:
+			if (size == sizeof(int32_t)) {
+				jag->storeStatus(field, SafeCANJag::unpackFXP16_16(data));
+			}
+			break;
+		case SafeCANJag::kStatusLimits:
+			if (size == sizeof(uint8_t)) {
+				jag->storeStatus(field, *data);
+			}
+			break;
+		case SafeCANJag::kStatusFaults:
+			if (size == sizeof(uint16_t)) {
+				jag->storeStatus(field, (uint16_t) SafeCANJag::unpackint16_t(
+						data));
+			}
+			break;
+		default:
+			if (size == sizeof(int16_t)) {
+				jag->storeStatus(field, SafeCANJag::unpackFXP8_8(data));
+			}
+			break;
+		}
+		return;
+	}
+}
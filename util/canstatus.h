@@ -0,0 +1,69 @@
+#ifndef UTIL_CANSTATUS_H_
+#define UTIL_CANSTATUS_H_
+
+#include "safecanjag.h"
+#include "canpipeline.h"
+#include "Task.h"
+#include <vector>
+
+/**
+ * Background task that periodically reads status fields from
+ * Jaguars into each SafeCANJag's telemetry cache, all in one
+ * CANPipeline flush. While a field is polled, its getter
+ * (GetOutputCurrent, GetForwardLimitOK, ...) is a memory read
+ * instead of a blocking 2.5 ms CAN transaction.
+ *
+ * A cached value older than kStaleCycles periods is not trusted,
+ * so getters fall back to the bus if the poller stalls or stops.
+ */
+class CANStatusPoller {
+public:
+	static constexpr double kDefaultPeriod = 0.020;
+	static const int kStaleCycles = 3;
+
+	static CANStatusPoller* GetInstance();
+
+	/**
+	 * Poll the status fields in `fields` (a bit-mask of
+	 * 1 << SafeCANJag::StatusField) of the Jaguar. Adding
+	 * a Jaguar again adds to its fields.
+	 */
+	void Add(SafeCANJag* jag, uint16_t fields);
+	void Remove(SafeCANJag* jag);
+
+	/**
+	 * Seconds between polls.
+	 */
+	void SetPeriod(double seconds);
+	double GetPeriod();
+
+	/**
+	 * Stop() leaves the task waiting, without polling, for the
+	 * next Start().
+	 */
+	void Start();
+	void Stop();
+private:
+	CANStatusPoller();
+	static int callRun();
+	void run();
+	void poll();
+	static void store(CANTransaction* t, void* jag);
+
+	typedef struct {
+		SafeCANJag* jag;
+		uint16_t fields;
+	} Entry;
+
+	SEM_ID semaphore;
+	// given by Start() to wake a stopped task
+	SEM_ID wake;
+	Task task;
+	CANPipeline pipe;
+	std::vector<Entry> entries;
+	double period;
+	volatile bool running;
+	bool started;
+};
+
+#endif
@@ -1,15 +1,22 @@
 #include "constants.h"
 #include "networktables/NetworkTable.h"
+#include "Synchronized.h"
+#include "Task.h"
 #include "Timer.h"
+#include <taskLib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <set>
+#include <map>
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <stdio.h>
+#include <string.h>
 
 typedef std::set<IntConstant*> IntSet;
-typedef std::set<DoubleConstant*> DoubleSet;
 typedef IntSet::iterator IntIter;
-typedef DoubleSet::iterator DoubleIter;
 
 static IntSet* intbank = 0;
 
@@ -36,32 +43,242 @@ const char* IntConstant::getName() {
 	return name;
 }
 
-static DoubleSet* doublebank = 0;
+// PORTION TWO: snapshots
+// A change never touches a published snapshot: it copies the
+// newest one, changes the copy, and publishes that with one
+// pointer store. Each reading task pins the snapshot it uses (a
+// hazard pointer), so a writer frees an old one only once no
+// task holds it.
+
+typedef struct Snapshot {
+	unsigned int epoch;
+	int count;
+	double* values;
+	// the publish count when it was replaced
+	unsigned int retired_at;
+	struct Snapshot* next_retired;
+} Snapshot;
+
+typedef struct {
+	std::string name;
+	std::string path;
+	// owned; NULL until first filled
+	Snapshot* snapshot;
+	// changed since last saved
+	bool dirty;
+} Profile;
+
+typedef struct {
+	// 0 if the slot is free
+	volatile int task;
+	Snapshot* volatile pinned;
+} Reader;
+
+const int MAX_READERS = 8;
+const char* DEFAULT_PROFILE = "default";
+
+// every DoubleConstant, by index; NULL once destroyed
+static std::vector<DoubleConstant*>* doublebank = 0;
+// and its value in the code
+static std::vector<double>* initials = 0;
+
+static Reader readers[MAX_READERS];
+static Snapshot* volatile published = NULL;
+
+// held by every writer; guards everything below
+static SEM_ID writer = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+static std::vector<Profile*> profiles;
+static int active_profile = 0;
+static unsigned int next_epoch = 1;
+static unsigned int publishes = 0;
+static Snapshot* retired = NULL;
 
 DoubleConstant::DoubleConstant(double val, const char* n) :
 	value(val), name(n) {
 	if (doublebank == 0) {
-		doublebank = new DoubleSet();
+		doublebank = new std::vector<DoubleConstant*>();
+		initials = new std::vector<double>();
 	}
-	doublebank->insert(this);
+	index = doublebank->size();
+	doublebank->push_back(this);
+	initials->push_back(val);
 }
 DoubleConstant::~DoubleConstant() {
 	if (doublebank == 0) {
 		return;
 	}
-	doublebank->erase(this);
+	(*doublebank)[index] = NULL;
 }
-DoubleConstant::operator double() const {
-	return value;
+
+/**
+ * The snapshot the calling task reads.
+ */
+static Snapshot* current() {
+	int self = taskIdSelf();
+	for (int i = 0; i < MAX_READERS; i++) {
+		if (readers[i].task == self) {
+			return readers[i].pinned;
+		}
+	}
+	return published;
 }
-void DoubleConstant::update(double val) {
-	value = val;
+
+DoubleConstant::operator double() const {
+	const Snapshot* s = current();
+	if (s == NULL || index >= s->count) {
+		return value;
+	}
+	return s->values[index];
 }
 const char* DoubleConstant::getName() {
 	return name;
 }
 
-// PORTION TWO: load/reload/write
+static int numDoubles() {
+	return (doublebank == 0) ? 0 : doublebank->size();
+}
+
+static void ensureDefault() {
+	if (profiles.empty()) {
+		Profile* p = new Profile;
+		p->name = DEFAULT_PROFILE;
+		p->path = "";
+		p->snapshot = NULL;
+		p->dirty = false;
+		profiles.push_back(p);
+	}
+}
+
+/**
+ * A new snapshot with the newest values, for a writer to change.
+ * Needs `writer`.
+ */
+static Snapshot* draft() {
+	int n = numDoubles();
+	Snapshot* s = new Snapshot;
+	s->epoch = 0;
+	s->count = n;
+	s->values = new double[n];
+	s->retired_at = 0;
+	s->next_retired = NULL;
+	Snapshot* from = published;
+	for (int i = 0; i < n; i++) {
+		bool known = (from != NULL && i < from->count);
+		s->values[i] = known ? from->values[i] : (*initials)[i];
+	}
+	return s;
+}
+
+static void discard(Snapshot* s) {
+	delete[] s->values;
+	delete s;
+}
+
+static void publish(Snapshot* s) {
+	// the values must land before the pointer
+	__sync_synchronize();
+	published = s;
+	__sync_synchronize();
+	publishes++;
+}
+
+static bool isPinned(Snapshot* s) {
+	for (int i = 0; i < MAX_READERS; i++) {
+		if (readers[i].pinned == s) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Free what no task can still be reading. A task that never
+ * pins reads `published` unguarded, for a few instructions; a
+ * snapshot outlives one more publish, to let such reads finish.
+ */
+static void reclaim() {
+	Snapshot** link = &retired;
+	while (*link != NULL) {
+		Snapshot* s = *link;
+		if (publishes > s->retired_at && !isPinned(s)) {
+			*link = s->next_retired;
+			discard(s);
+		} else {
+			link = &s->next_retired;
+		}
+	}
+}
+
+/**
+ * Make `s` profile `p`'s values, publishing it if `p` is in use.
+ * Needs `writer`.
+ */
+static void install(int p, Snapshot* s) {
+	ensureDefault();
+	s->epoch = next_epoch++;
+	Snapshot* old = profiles[p]->snapshot;
+	profiles[p]->snapshot = s;
+	if (p == active_profile) {
+		publish(s);
+	}
+	if (old != NULL) {
+		old->retired_at = publishes;
+		old->next_retired = retired;
+		retired = old;
+	}
+	reclaim();
+}
+
+static int findProfile(const char* name) {
+	for (size_t i = 0; i < profiles.size(); i++) {
+		if (profiles[i]->name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void DoubleConstant::update(double val) {
+	Synchronized sync(writer);
+	Snapshot* s = draft();
+	s->values[index] = val;
+	install(active_profile, s);
+}
+
+void Constants::beginCycle() {
+	int self = taskIdSelf();
+	Reader* r = NULL;
+	for (int i = 0; i < MAX_READERS && r == NULL; i++) {
+		if (readers[i].task == self) {
+			r = &readers[i];
+		}
+	}
+	for (int i = 0; i < MAX_READERS && r == NULL; i++) {
+		if (readers[i].task == 0 && __sync_bool_compare_and_swap(
+				&readers[i].task, 0, self)) {
+			r = &readers[i];
+		}
+	}
+	if (r == NULL) {
+		// reads the newest values, unpinned
+		return;
+	}
+	// a writer may replace `s` between the read and the pin; if so,
+	// it may not have seen the pin, so try again
+	Snapshot* s;
+	do {
+		s = published;
+		r->pinned = s;
+		__sync_synchronize();
+	} while (s != published);
+}
+
+unsigned int Constants::getEpoch() {
+	Snapshot* s = current();
+	return (s == NULL) ? 0 : s->epoch;
+}
+
+// PORTION THREE: load/reload/write
 // The WPILib Preferences class is inappropriate
 // because asynchronous: it starts a thread that updates
 // the table of values used much later than it should be.
@@ -69,34 +286,304 @@ const char* DoubleConstant::getName() {
 const char* PATH = "/c/constants.txt";
 const char* TABLE = "Constants";
 const char* SAVE_STRING = "S A V E";
+const char* PROFILE_KEY = "PROFILE";
 
-void write() {
-	std::ofstream f(PATH, std::ios::out);
-	if (!f.good()) {
-		printf("Constants file could not be written");
-		return;
+NetworkTable* table = NULL;
+
+/**
+ * The newest values, by index; and the path the profile in use
+ * is saved to.
+ */
+static void newest(std::vector<double>* values, std::string* path) {
+	Synchronized sync(writer);
+	Snapshot* s = draft();
+	values->assign(s->values, s->values + s->count);
+	discard(s);
+	if (path != NULL) {
+		ensureDefault();
+		*path = profiles[active_profile]->path;
 	}
+}
 
-	DoubleIter end = doublebank->end();
-	printf("How many doubles? %d\n", doublebank->size());
-	for (DoubleIter i = doublebank->begin(); i != end; i++) {
-		DoubleConstant* x = *i;
-		f << "D " << double(*x) << " " << x->getName() << std::endl;
-		printf("%3.6f <<- %s\n", double(*x), x->getName());
+/**
+ * Show `values` (every constant, by index) on the dashboard.
+ */
+static void push(const std::vector<double>& values) {
+	for (size_t i = 0; i < values.size(); i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x == NULL) {
+			continue;
+		}
+		try {
+			table->PutNumber(x->getName(), values[i]);
+		} catch (std::exception) {
+			printf("Nettables failed on pushing %s\n", x->getName());
+		}
 	}
-	printf("Writing constants done\n");
 }
 
-NetworkTable* table = NULL;
-bool read() {
-	if (table == NULL) {
-		table = NetworkTable::GetTable(TABLE);
+// Saving is write-behind: a change marks its profile dirty, and a
+// low-priority task writes dirty profiles out, so entering a mode
+// never waits on flash. Each file is written whole to a temporary
+// that is then renamed over it, so a crash leaves the old file or
+// the new one, never a mix. Beside each text file is a binary copy,
+// which load() takes in a single read if it matches the text.
+
+// below the InputLog writer; flash can wait
+const int SAVER_PRIORITY = 200;
+const char* TEMP_SUFFIX = ".tmp";
+const char SIDECAR_MAGIC[4] = { 'Y', 'C', 'O', 'N' };
+const uint32_t SIDECAR_BYTE_ORDER = 0x01020304;
+const uint32_t SIDECAR_VERSION = 1;
+const int SIDECAR_NAME_LENGTH = 32;
+
+typedef struct {
+	char magic[4];
+	uint32_t byte_order;
+	uint32_t version;
+	uint32_t count;
+	// the text file as it was when this was written
+	uint32_t text_size;
+	uint32_t text_mtime;
+	// FNV-1a, of the entries
+	uint32_t checksum;
+} SidecarHeader;
+
+typedef struct {
+	char name[SIDECAR_NAME_LENGTH];
+	double value;
+} SidecarEntry;
+
+static Task* save_task = NULL;
+static SEM_ID saver_wake = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+
+static std::string sidecarPath(const std::string& text) {
+	size_t dot = text.rfind(".txt");
+	if (dot != std::string::npos && dot + 4 == text.size()) {
+		return text.substr(0, dot) + ".bin";
 	}
+	return text + ".bin";
+}
 
-	bool perfect = true;
-	std::map<std::string, double> kvp;
+static uint32_t checksum(const char* data, size_t len) {
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < len; i++) {
+		h = (h ^ (uint8_t) data[i]) * 16777619u;
+	}
+	return h;
+}
+
+/**
+ * Replace `path` with `data`, by way of a temporary file.
+ */
+static bool replaceFile(const std::string& path, const std::string& data) {
+	std::string temp = path + TEMP_SUFFIX;
+	int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = write(fd, (char*) data.data(), data.size())
+			== (ssize_t) data.size();
+	ok = (fsync(fd) == 0) && ok;
+	close(fd);
+	if (!ok) {
+		unlink(temp.c_str());
+		return false;
+	}
+	if (rename(temp.c_str(), path.c_str()) != 0) {
+		// dosFs will not rename over a file; if the robot dies
+		// between these, load() reads the temporary
+		unlink(path.c_str());
+		if (rename(temp.c_str(), path.c_str()) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Write `values` (every constant, by index) to `path`, and the
+ * binary copy beside it. Returns false if the text could not be
+ * written.
+ */
+static bool writeValues(const std::string& path,
+		const std::vector<double>& values) {
+	std::ostringstream text;
+	std::string entries;
+	bool fits = true;
+	uint32_t count = 0;
+	for (size_t i = 0; i < values.size(); i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x == NULL) {
+			continue;
+		}
+		text << "D " << values[i] << " " << x->getName() << std::endl;
+		SidecarEntry e;
+		memset(&e, 0, sizeof(e));
+		if (strlen(x->getName()) >= (size_t) SIDECAR_NAME_LENGTH) {
+			printf("Constant %s: name too long for the binary copy\n",
+					x->getName());
+			fits = false;
+		}
+		strncpy(e.name, x->getName(), SIDECAR_NAME_LENGTH - 1);
+		e.value = values[i];
+		entries.append((char*) &e, sizeof(e));
+		count++;
+	}
+	if (!replaceFile(path, text.str())) {
+		return false;
+	}
+	struct stat st;
+	if (!fits || stat(path.c_str(), &st) != 0) {
+		return true;
+	}
+	SidecarHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, SIDECAR_MAGIC, sizeof(h.magic));
+	h.byte_order = SIDECAR_BYTE_ORDER;
+	h.version = SIDECAR_VERSION;
+	h.count = count;
+	h.text_size = st.st_size;
+	h.text_mtime = st.st_mtime;
+	h.checksum = checksum(entries.data(), entries.size());
+	std::string sidecar((char*) &h, sizeof(h));
+	sidecar += entries;
+	if (!replaceFile(sidecarPath(path), sidecar)) {
+		printf("Constants: could not write %s\n", sidecarPath(path).c_str());
+	}
+	return true;
+}
+
+/**
+ * Read the binary copy of `path` into `kvp`, in one read. Returns
+ * false if it is missing, damaged, or not of the text as it is.
+ */
+static bool readSidecar(const std::string& path,
+		std::map<std::string, double>* kvp) {
+	struct stat text;
+	if (stat(path.c_str(), &text) != 0) {
+		return false;
+	}
+	int fd = open(sidecarPath(path).c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	std::vector<char> buf;
+	bool ok = (fstat(fd, &st) == 0 && st.st_size
+			>= (off_t) sizeof(SidecarHeader));
+	if (ok) {
+		buf.resize(st.st_size);
+		ok = (read(fd, &buf[0], buf.size()) == (ssize_t) buf.size());
+	}
+	close(fd);
+	if (!ok) {
+		return false;
+	}
+	SidecarHeader h;
+	memcpy(&h, &buf[0], sizeof(h));
+	const char* entries = &buf[0] + sizeof(h);
+	size_t len = buf.size() - sizeof(h);
+	if (memcmp(h.magic, SIDECAR_MAGIC, sizeof(h.magic)) != 0 || h.byte_order
+			!= SIDECAR_BYTE_ORDER || h.version != SIDECAR_VERSION || len
+			!= h.count * sizeof(SidecarEntry) || h.checksum != checksum(
+			entries, len) || h.text_size != (uint32_t) text.st_size
+			|| h.text_mtime != (uint32_t) text.st_mtime) {
+		return false;
+	}
+	for (uint32_t i = 0; i < h.count; i++) {
+		SidecarEntry e;
+		memcpy(&e, entries + i * sizeof(e), sizeof(e));
+		e.name[SIDECAR_NAME_LENGTH - 1] = '\0';
+		(*kvp)[e.name] = e.value;
+	}
+	return true;
+}
+
+/**
+ * Write out every dirty profile; on the saver task.
+ */
+static void saveDirty() {
+	std::vector<std::string> paths;
+	std::vector<std::vector<double> > sets;
+	{
+		Synchronized sync(writer);
+		for (size_t p = 0; p < profiles.size(); p++) {
+			Profile* profile = profiles[p];
+			Snapshot* s = profile->snapshot;
+			if (!profile->dirty || s == NULL || profile->path.empty()) {
+				continue;
+			}
+			profile->dirty = false;
+			paths.push_back(profile->path);
+			sets.push_back(std::vector<double>(s->values, s->values + s->count));
+		}
+	}
+	for (size_t i = 0; i < paths.size(); i++) {
+		double time = GetTime();
+		if (writeValues(paths[i], sets[i])) {
+			printf("Constants saved to %s (%.4f s)\n", paths[i].c_str(),
+					GetTime() - time);
+		} else {
+			printf("Constants could not be saved to %s\n", paths[i].c_str());
+		}
+	}
+}
+
+static int runSaver() {
+	while (true) {
+		// any number of changes meanwhile make one save
+		semTake(saver_wake, WAIT_FOREVER);
+		saveDirty();
+	}
+	return 0;
+}
+
+/**
+ * Have the dirty profiles saved soon; returns at once.
+ */
+static void wakeSaver() {
+	{
+		Synchronized sync(writer);
+		if (save_task == NULL) {
+			save_task = new Task("ConstantsSave", (FUNCPTR) runSaver,
+					SAVER_PRIORITY);
+			save_task->Start();
+		}
+	}
+	semGive(saver_wake);
+}
 
-	std::ifstream in(PATH, std::ios::in);
+/**
+ * Save the profile in use now, and print every value; for load(),
+ * when the file is missing or bad.
+ */
+void write() {
+	std::vector<double> values;
+	std::string path;
+	newest(&values, &path);
+	printf("How many doubles? %u\n",
+			(unsigned int) Constants::getDoubles().size());
+	if (!Constants::save(path.c_str())) {
+		printf("Constants file could not be written");
+		return;
+	}
+	for (size_t i = 0; i < values.size(); i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x != NULL) {
+			printf("%3.6f <<- %s\n", values[i], x->getName());
+		}
+	}
+	printf("Writing constants done\n");
+}
+
+/**
+ * Read the name/value pairs in `path`. Returns false if the file
+ * could not be read; `perfect` is cleared if a line was bad.
+ */
+static bool parse(const char* path, std::map<std::string, double>* kvp,
+		bool* perfect) {
+	std::ifstream in(path, std::ios::in);
 	if (!in.good()) {
 		return false;
 	}
@@ -109,39 +596,96 @@ bool read() {
 		i >> key >> yy >> name;
 		if (i.eof() && !i.fail() && !i.bad()) {
 			if (key == "D") {
-				kvp[name] = yy;
+				(*kvp)[name] = yy;
 			} else {
 				printf("Unidentified key: |%s|\n", key.c_str());
-				perfect = false;
+				*perfect = false;
 			}
 		} else {
 			printf("Malformatted line: |%s|\n", line.c_str());
-			perfect = false;
+			*perfect = false;
 		}
 	}
+	return true;
+}
+
+/**
+ * Read `path` into `kvp`: from the binary copy if it is current
+ * (`fresh`), else from the text, or the temporary if a save was
+ * cut short.
+ */
+static bool readValues(const char* path, std::map<std::string, double>* kvp,
+		bool* perfect, bool* fresh) {
+	*fresh = readSidecar(path, kvp);
+	if (*fresh || parse(path, kvp, perfect)) {
+		return true;
+	}
+	std::string temp = std::string(path) + TEMP_SUFFIX;
+	if (parse(temp.c_str(), kvp, perfect)) {
+		printf("Constants: %s missing; read %s\n", path, temp.c_str());
+		return true;
+	}
+	return false;
+}
 
-	// update values, put into /Constants/
-	DoubleIter end = doublebank->end();
-	for (DoubleIter i = doublebank->begin(); i != end; i++) {
-		DoubleConstant* x = *i;
-		std::string name(x->getName());
-		if (kvp.count(name) > 0) {
-			double newval = kvp[name];
-			if (newval != double(*x)) {
+/**
+ * Fill profile `p` from `path`, starting from the newest values.
+ * Returns false if the file could not be read; `perfect` is
+ * cleared if it was bad or lacked a constant.
+ */
+static bool readProfile(int p, const char* path, bool* perfect) {
+	std::map<std::string, double> kvp;
+	bool fresh;
+	if (!readValues(path, &kvp, perfect, &fresh)) {
+		return false;
+	}
+	Synchronized sync(writer);
+	Snapshot* s = draft();
+	for (int i = 0; i < s->count; i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x == NULL) {
+			continue;
+		}
+		std::map<std::string, double>::iterator it = kvp.find(x->getName());
+		if (it != kvp.end()) {
+			if (it->second != s->values[i]) {
 				printf("Constant %s: file is %f, code is %f\n", x->getName(),
-						newval, double(*x));
+						it->second, s->values[i]);
 			}
-			x->update(kvp[name]);
+			s->values[i] = it->second;
 		} else {
-			perfect = false;
+			*perfect = false;
 			printf("%s not yet present\n", x->getName());
 		}
-		try {
-			table->PutNumber(name, double(*x));
-		} catch (std::exception) {
-			printf("Nettables failed on pushing %s\n", x->getName());
-		}
 	}
+	install(p, s);
+	if (!fresh) {
+		// for the binary copy
+		profiles[p]->dirty = true;
+		wakeSaver();
+	}
+	return true;
+}
+
+bool read() {
+	if (table == NULL) {
+		table = NetworkTable::GetTable(TABLE);
+	}
+	bool perfect = true;
+	int p;
+	{
+		Synchronized sync(writer);
+		ensureDefault();
+		profiles[0]->path = PATH;
+		p = active_profile;
+	}
+	if (!readProfile(p, PATH, &perfect)) {
+		return false;
+	}
+	// put into /Constants/
+	std::vector<double> values;
+	newest(&values, NULL);
+	push(values);
 	return perfect;
 }
 
@@ -150,29 +694,79 @@ bool check() {
 		table = NetworkTable::GetTable(TABLE);
 	}
 	// read values from SmartDashboard/Constants/
-	// based on the keys
-	bool change = false;
-
-	DoubleIter end = doublebank->end();
-	for (DoubleIter i = doublebank->begin(); i != end; i++) {
-		DoubleConstant *x = *i;
-		double v = double(*x);
-		std::string name(x->getName());
+	// based on the keys; the table is not read under `writer`,
+	// as its listeners may write
+	int n = numDoubles();
+	std::vector<double> shown(n);
+	std::vector<bool> present(n, false);
+	for (int i = 0; i < n; i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x == NULL) {
+			continue;
+		}
 		try {
-			v = table->GetNumber(name);
+			shown[i] = table->GetNumber(x->getName());
+			present[i] = true;
 		} catch (std::exception) {
 			printf("Nettables errored on %s\n", x->getName());
 		}
-		if (v != double(*x)) {
-			x->update(v);
+	}
+
+	bool change = false;
+	Synchronized sync(writer);
+	Snapshot* s = draft();
+	for (int i = 0; i < n; i++) {
+		if (present[i] && shown[i] != s->values[i]) {
+			s->values[i] = shown[i];
 			change = true;
-			printf("New value for %s: %f\n", x->getName(), double(*x));
+			printf("New value for %s: %f\n", (*doublebank)[i]->getName(),
+					shown[i]);
 		}
 	}
-
+	if (change) {
+		install(active_profile, s);
+		profiles[active_profile]->dirty = true;
+	} else {
+		discard(s);
+	}
 	return change;
 }
 
+/**
+ * Switch to profile `p`, and show its values on the dashboard.
+ */
+static bool useProfile(int p) {
+	std::vector<double> values;
+	const char* name;
+	{
+		Synchronized sync(writer);
+		ensureDefault();
+		if (p < 0 || p >= (int) profiles.size()) {
+			printf("No constants profile %d\n", p);
+			return false;
+		}
+		if (p == active_profile) {
+			return true;
+		}
+		Snapshot* s = profiles[p]->snapshot;
+		if (s == NULL) {
+			// never filled: start it from the newest values
+			s = draft();
+			install(p, s);
+		}
+		active_profile = p;
+		publish(s);
+		reclaim();
+		values.assign(s->values, s->values + s->count);
+		name = profiles[p]->name.c_str();
+	}
+	printf("Constants profile: %s\n", name);
+	// otherwise the next reload would take back the old values
+	push(values);
+	table->PutNumber(PROFILE_KEY, p);
+	return true;
+}
+
 class Saver: public ITableListener {
 	virtual void ValueChanged(ITable* source, const std::string& key, EntryValue value, bool isNew) {
 		if (table->GetBoolean(SAVE_STRING, true)) {
@@ -183,6 +777,12 @@ class Saver: public ITableListener {
 	}
 } saver;
 
+class Switcher: public ITableListener {
+	virtual void ValueChanged(ITable* source, const std::string& key, EntryValue value, bool isNew) {
+		useProfile((int) table->GetNumber(PROFILE_KEY, 0.0));
+	}
+} switcher;
+
 void Constants::load() {
 	double time = GetTime();
 	if (table == NULL) {
@@ -190,6 +790,8 @@ void Constants::load() {
 	}
 	table->PutBoolean(SAVE_STRING, false);
 	table->AddTableListener(SAVE_STRING, &saver, true);
+	table->PutNumber(PROFILE_KEY, 0.0);
+	table->AddTableListener(PROFILE_KEY, &switcher, false);
 
 	if (!read()) {
 		printf("Constants file not good; writing\n");
@@ -203,11 +805,85 @@ void Constants::load() {
 	printf("Constants loaded (%.4f s)\n", GetTime() - time);
 }
 
+void Constants::setPath(const char* path) {
+	PATH = path;
+}
+
 void Constants::reload() {
 	double time = GetTime();
 	if (check()) {
-		printf("Change occured; writing constants to file\n");
-		write();
+		printf("Change occured; saving constants\n");
+		wakeSaver();
 	}
 	printf("Constants reloaded (%.4f s)\n", GetTime() - time);
 }
+
+bool Constants::loadProfile(const char* name, const char* path) {
+	int p;
+	{
+		Synchronized sync(writer);
+		ensureDefault();
+		p = findProfile(name);
+		if (p < 0) {
+			Profile* profile = new Profile;
+			profile->name = name;
+			profile->snapshot = NULL;
+			profile->dirty = false;
+			profiles.push_back(profile);
+			p = profiles.size() - 1;
+		}
+		profiles[p]->path = path;
+	}
+	bool perfect = true;
+	if (!readProfile(p, path, &perfect)) {
+		printf("Constants profile %s: could not read %s\n", name, path);
+		return false;
+	}
+	printf("Constants profile %s (%d) loaded from %s\n", name, p, path);
+	return true;
+}
+
+bool Constants::useProfile(const char* name) {
+	int p;
+	{
+		Synchronized sync(writer);
+		p = findProfile(name);
+	}
+	if (p < 0) {
+		printf("No constants profile %s\n", name);
+		return false;
+	}
+	return ::useProfile(p);
+}
+
+const char* Constants::getProfile() {
+	Synchronized sync(writer);
+	ensureDefault();
+	return profiles[active_profile]->name.c_str();
+}
+
+std::vector<DoubleConstant*> Constants::getDoubles() {
+	std::vector<DoubleConstant*> doubles;
+	for (int i = 0; i < numDoubles(); i++) {
+		if ((*doublebank)[i] != NULL) {
+			doubles.push_back((*doublebank)[i]);
+		}
+	}
+	return doubles;
+}
+
+DoubleConstant* Constants::findDouble(const char* name) {
+	for (int i = 0; i < numDoubles(); i++) {
+		DoubleConstant* x = (*doublebank)[i];
+		if (x != NULL && strcmp(x->getName(), name) == 0) {
+			return x;
+		}
+	}
+	return NULL;
+}
+
+bool Constants::save(const char* path) {
+	std::vector<double> values;
+	newest(&values, NULL);
+	return writeValues(path, values);
+}
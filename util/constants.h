@@ -12,10 +12,74 @@
  * the last values from robot memory. Constants::reload() will then
  * check at the start of a mode if any values have changed; if so, 
  * all constants will assume the new values.
+ * 
+ * Values are never changed in place. A change publishes a new,
+ * immutable snapshot of every value, and each loop moves to the
+ * newest one only when it calls Constants::beginCycle(); so a
+ * live reload from the dashboard cannot land halfway through a
+ * calculation. Reading a constant takes no lock.
+ * 
+ * Changes are saved by a background task, so reload() never
+ * waits on flash. Beside each constants file is a binary copy
+ * (constants.bin for constants.txt), which load() reads in one
+ * piece while it matches the text.
  */
+#include <vector>
+
+class DoubleConstant;
+
 namespace Constants {
 void load();
 void reload();
+/**
+ * The file load() reads, and live reloads save to, in place of
+ * /c/constants.txt; for host tools, before the robot starts.
+ * `path` must outlive the robot.
+ */
+void setPath(const char* path);
+/**
+ * Move the calling task to the newest snapshot. Until it calls
+ * this again, every constant it reads comes from that snapshot;
+ * call it at the top of each loop. Tasks that never call it read
+ * the newest values.
+ */
+void beginCycle();
+/**
+ * The version of the snapshot the calling task reads; every
+ * change, and every switch of profile, gives a different one.
+ */
+unsigned int getEpoch();
+
+/**
+ * Profiles are whole sets of values (per field, or per driver)
+ * kept in memory under a name. load() reads "default", and
+ * loadProfile() reads another from a file in the same format,
+ * taking the present values for any the file lacks (or all, if
+ * there is no file yet: it is written on the first live reload).
+ * useProfile() switches in O(1): loops see the new values at
+ * their next cycle. A live reload changes the profile in use,
+ * and saves it to that profile's file.
+ * 
+ * The dashboard switches profiles by setting Constants/PROFILE
+ * to a profile's number: 0 for the default, then 1, 2, ... in
+ * the order they were loaded.
+ */
+bool loadProfile(const char* name, const char* path);
+bool useProfile(const char* name);
+const char* getProfile();
+/**
+ * Every DoubleConstant, in no particular order; and the one
+ * named `name`, or NULL. For host tools that set constants
+ * before the robot starts.
+ */
+std::vector<DoubleConstant*> getDoubles();
+DoubleConstant* findDouble(const char* name);
+/**
+ * Write the present values to `path`, in the format load()
+ * reads, and its binary copy; each replaces the old file whole.
+ * Returns false if the file could not be written.
+ */
+bool save(const char* path);
 }
 
 class IntConstant {
@@ -45,7 +109,7 @@ public:
 	DoubleConstant(double val, const char* name);
 	~DoubleConstant();
 	operator double() const;
-	// never call update
+	// never call update; it publishes a new snapshot
 	void update(double val);
 	const char* getName();
 private:
@@ -53,8 +117,11 @@ private:
 	DoubleConstant(const DoubleConstant&);             
 	void operator=(const DoubleConstant&);
 	
+	// the value in the code, until a snapshot has this constant
 	double value;
 	const char* name;
+	// position in every snapshot
+	int index;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "controllers.h"
 #include "Timer.h"
+#include <math.h>
 
 TimeDifferentiator::TimeDifferentiator() {
 }
@@ -50,25 +51,222 @@ double TimeIntegrator::lastTimeStep() {
 	return step;
 }
 
-MovingAverageFilter::MovingAverageFilter(int size) :
-	buf(size) {
+const int MovingAverageFilter::kMaxSize;
+
+MovingAverageFilter::MovingAverageFilter(int size) {
+	if (size > kMaxSize) {
+		printf("MovingAverageFilter: size %d cut to %d\n", size, kMaxSize);
+		size = kMaxSize;
+	}
+	if (size < 1) {
+		size = 1;
+	}
+	this->size = size;
+	until_resum = size;
+	sum = 0.0;
+	average = 0.0;
 }
 
 void MovingAverageFilter::reset(double val) {
 	buf.clear();
 	buf.next(val);
+	until_resum = size;
+	sum = val;
+	average = val;
 }
 
 double MovingAverageFilter::calc(double next) {
+	if (buf.size() == size) {
+		sum -= buf[0];
+		buf.drop();
+	}
 	buf.next(next);
-	return recalc();
+	sum += next;
+
+	until_resum--;
+	if (until_resum <= 0) {
+		until_resum = size;
+		const double* runs[2];
+		int lengths[2];
+		buf.spans(&runs[0], &lengths[0], &runs[1], &lengths[1]);
+		sum = 0.0;
+		for (int r = 0; r < 2; r++) {
+			for (int i = 0; i < lengths[r]; i++) {
+				sum += runs[r][i];
+			}
+		}
+	}
+	average = sum / buf.size();
+	return average;
+}
+
+double MovingAverageFilter::get() {
+	return average;
 }
 
 double MovingAverageFilter::recalc() {
-	int l = buf.size();
-	double sum = 0;
-	for (int i = 0; i < l; i++) {
-		sum += buf[i];
+	return average;
+}
+
+ExponentialFilter::ExponentialFilter(double alpha) :
+	alpha(alpha) {
+	value = 0.0;
+}
+
+double ExponentialFilter::alphaFor(double hertz, double period) {
+	const double kTwoPi = 6.283185307179586;
+	double tau = 1.0 / (kTwoPi * hertz);
+	return 1.0 / (1.0 + tau / period);
+}
+
+void ExponentialFilter::reset(double val) {
+	value = val;
+}
+
+double ExponentialFilter::calc(double next) {
+	value += alpha * (next - value);
+	return value;
+}
+
+double ExponentialFilter::get() {
+	return value;
+}
+
+void ExponentialFilter::setAlpha(double a) {
+	alpha = a;
+}
+
+const int MedianFilter::kMaxSize;
+
+MedianFilter::MedianFilter(int size) {
+	if (size > kMaxSize) {
+		printf("MedianFilter: size %d cut to %d\n", size, kMaxSize);
+		size = kMaxSize;
+	}
+	if (size < 1) {
+		size = 1;
+	}
+	this->size = size;
+	count = 0;
+	oldest = 0;
+	median = 0.0;
+}
+
+void MedianFilter::reset(double val) {
+	window[0] = val;
+	sorted[0] = val;
+	count = 1;
+	oldest = 0;
+	median = val;
+}
+
+double MedianFilter::calc(double next) {
+	int slot;
+	if (count == size) {
+		// drop the oldest sample from the sorted copy
+		double old = window[oldest];
+		int i = 0;
+		while (sorted[i] != old) {
+			i++;
+		}
+		for (; i < count - 1; i++) {
+			sorted[i] = sorted[i + 1];
+		}
+		count--;
+		slot = oldest;
+		oldest = (oldest + 1) % size;
+	} else {
+		slot = (oldest + count) % size;
+	}
+	window[slot] = next;
+
+	int i = count;
+	while (i > 0 && sorted[i - 1] > next) {
+		sorted[i] = sorted[i - 1];
+		i--;
+	}
+	sorted[i] = next;
+	count++;
+
+	if (count % 2 == 1) {
+		median = sorted[count / 2];
+	} else {
+		median = 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+	}
+	return median;
+}
+
+double MedianFilter::get() {
+	return median;
+}
+
+AlphaBetaFilter::AlphaBetaFilter(double alpha, double beta, double period) :
+	alpha(alpha), beta(beta), period(period) {
+	reset(0.0);
+	primed = false;
+}
+
+void AlphaBetaFilter::reset(double val) {
+	value = val;
+	velocity = 0.0;
+	primed = true;
+}
+
+double AlphaBetaFilter::calc(double next) {
+	if (!primed) {
+		reset(next);
 	}
-	return sum / ((double) l);
+	double predicted = value + velocity * period;
+	double residual = next - predicted;
+	value = predicted + alpha * residual;
+	velocity += (beta / period) * residual;
+	return value;
+}
+
+double AlphaBetaFilter::get() {
+	return value;
+}
+
+double AlphaBetaFilter::getVelocity() {
+	return velocity;
+}
+
+// cutoff of the velocity estimate, as in the paper
+const double ONE_EURO_VELOCITY_CUTOFF = 1.0;
+
+OneEuroFilter::OneEuroFilter(double min_cutoff, double beta, double period) :
+	min_cutoff(min_cutoff), beta(beta), period(period), value(1.0),
+			velocity(ExponentialFilter::alphaFor(ONE_EURO_VELOCITY_CUTOFF,
+					period)) {
+	reset(0.0);
+	primed = false;
+}
+
+void OneEuroFilter::reset(double val) {
+	value.reset(val);
+	velocity.reset(0.0);
+	primed = true;
+}
+
+double OneEuroFilter::calc(double next) {
+	if (!primed) {
+		reset(next);
+	}
+	double speed = velocity.calc((next - value.get()) / period);
+	double cutoff = min_cutoff + beta * fabs(speed);
+	value.setAlpha(ExponentialFilter::alphaFor(cutoff, period));
+	return value.calc(next);
+}
+
+double OneEuroFilter::get() {
+	return value.get();
+}
+
+double OneEuroFilter::getVelocity() {
+	return velocity.get();
+}
+
+void OneEuroFilter::setCutoff(double min, double b) {
+	min_cutoff = min;
+	beta = b;
 }
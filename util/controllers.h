@@ -36,39 +36,78 @@ private:
 };
 
 /**
- * Ring buffer implementation. Contains a set of doubles.
+ * Ring buffer of up to N elements, stored inline; N must be a power
+ * of two, so indices wrap with a mask. Element 0 is the oldest.
+ *
+ * next() overwrites the oldest element when full, and is not
+ * threadsafe. Alternatively, with one producer calling push() and
+ * one consumer calling pop() (say, a Notifier callback and the main
+ * loop), no lock is needed.
  */
-template<typename T>
+template<typename T, int N>
 class RingBuffer {
+	// fails to compile unless N is a power of two
+	typedef char capacity_is_power_of_two[(N > 0 && (N & (N - 1)) == 0) ? 1
+			: -1];
 public:
-	/**
-	 * Create a ring buffer with the added capacity.
-	 */
-	RingBuffer(int capacity) {
-		length = capacity + 1;
-		buf = new T[length];
-		tip = 0;
+	RingBuffer() {
+		head = 0;
 		tail = 0;
 	}
-	~RingBuffer() {
-		delete[] buf;
+
+	static int capacity() {
+		return N;
 	}
 
 	/**
 	 * Insert the next element: if `capacity` elements have been
 	 * added, overwrites the earliest added element
 	 */
-	void next(T v) {
-		buf[tip] = v;
-		tip++;
-		if (tip >= length) {
-			tip = 0;
+	void next(const T& v) {
+		if (head - tail == (unsigned int) N) {
+			tail++;
+		}
+		buf[head & (N - 1)] = v;
+		head++;
+	}
+
+	/**
+	 * Producer side: add an element, unless full.
+	 */
+	bool push(const T& v) {
+		unsigned int h = head;
+		if (h - tail == (unsigned int) N) {
+			return false;
 		}
-		if (tip == tail) {
+		buf[h & (N - 1)] = v;
+		// publish the element before the index
+		__sync_synchronize();
+		head = h + 1;
+		return true;
+	}
+
+	/**
+	 * Consumer side: take the oldest element, unless empty.
+	 */
+	bool pop(T* v) {
+		unsigned int t = tail;
+		if (head == t) {
+			return false;
+		}
+		__sync_synchronize();
+		*v = buf[t & (N - 1)];
+		// finish reading before the slot is given back
+		__sync_synchronize();
+		tail = t + 1;
+		return true;
+	}
+
+	/**
+	 * Discard the oldest element, if any.
+	 */
+	void drop() {
+		if (head != tail) {
 			tail++;
-			if (tail >= length) {
-				tail = 0;
-			}
 		}
 	}
 
@@ -76,48 +115,71 @@ public:
 	 * Empty the collection: it will have size() 0.
 	 */
 	void clear() {
-		tip = tail;
+		tail = head;
 	}
 	/**
 	 * Number of elements in the collection.
 	 */
 	int size() const {
-		if (tip >= tail) {
-			return tip - tail;
-		} else {
-			return tip - tail + length;
-		}
+		return head - tail;
+	}
+	bool full() const {
+		return head - tail == (unsigned int) N;
 	}
 	/**
-	 * Indices range from 0 to k-1, where k is the number of elements added.
+	 * Indices range from 0 to size()-1; not checked.
 	 * Addition of an element decrements each present element's index
 	 */
-	T operator[](int i) const {
-		if (i >= size() || i < 0) {
-			printf("Index out of bounds: %d\n", i);
-			return T();
-		}
-		int addr = i + tail;
-		if (addr >= length) {
-			return buf[addr - length];
+	const T& operator[](int i) const {
+		return buf[(tail + i) & (N - 1)];
+	}
+	T& operator[](int i) {
+		return buf[(tail + i) & (N - 1)];
+	}
+	const T& newest() const {
+		return buf[(head - 1) & (N - 1)];
+	}
+
+	/**
+	 * The elements, oldest first, as two contiguous runs;
+	 * the second is empty unless the contents wrap around.
+	 */
+	void spans(const T** first, int* first_size, const T** second,
+			int* second_size) const {
+		int start = tail & (N - 1);
+		int n = size();
+		*first = buf + start;
+		*second = buf;
+		if (start + n <= N) {
+			*first_size = n;
+			*second_size = 0;
 		} else {
-			return buf[addr];
+			*first_size = N - start;
+			*second_size = n - (N - start);
 		}
 	}
 private:
-	T* buf;
-	int length;
-	int tip;
-	int tail;
+	T buf[N];
+	// free-running; only their difference and low bits matter
+	volatile unsigned int head;
+	volatile unsigned int tail;
 };
 
+/*
+ * Streaming filters. Each takes one sample per calc(), in constant
+ * time (MedianFilter: linear in its small window), and caches its
+ * output, so get() is just a read.
+ */
+
 /**
- * Moving average filter on up to `size` doubles.
+ * Moving average filter on up to `size` (at most kMaxSize) doubles.
  * Averages as many values as have been added
  * up to a maximum size. 
  */
 class MovingAverageFilter {
 public:
+	static const int kMaxSize = 32;
+
 	MovingAverageFilter(int size);
 	/**
 	 * Clear the filter, seed it with the value.
@@ -129,9 +191,111 @@ public:
 	 * of added values and the filter size.
 	 */
 	double calc(double next);
+	/**
+	 * The last value calc() returned.
+	 */
+	double get();
 	double recalc();
 private:
-	RingBuffer<double> buf;
+	RingBuffer<double, kMaxSize> buf;
+	int size;
+	// the running sum is recomputed once per `size`
+	// samples, so rounding errors cannot pile up
+	int until_resum;
+	double sum;
+	double average;
+};
+
+/**
+ * Exponential moving average: each output moves `alpha`
+ * (0 to 1) of the way from the last output to the sample.
+ */
+class ExponentialFilter {
+public:
+	ExponentialFilter(double alpha);
+	/**
+	 * The alpha that gives a cutoff frequency of
+	 * `hertz` when sampling every `period` seconds.
+	 */
+	static double alphaFor(double hertz, double period);
+
+	void reset(double val);
+	double calc(double next);
+	double get();
+	void setAlpha(double alpha);
+private:
+	double alpha;
+	double value;
+};
+
+/**
+ * Median of the last `size` (at most kMaxSize) samples; rejects
+ * spikes shorter than half the window without smearing steps.
+ */
+class MedianFilter {
+public:
+	static const int kMaxSize = 15;
+
+	MedianFilter(int size);
+
+	void reset(double val);
+	double calc(double next);
+	double get();
+private:
+	int size;
+	// samples in arrival order, and the same sorted
+	double window[kMaxSize];
+	double sorted[kMaxSize];
+	int count;
+	int oldest;
+	double median;
+};
+
+/**
+ * Alpha-beta filter: tracks position and velocity of a signal
+ * sampled every `period` seconds. Unlike an average, it does
+ * not lag behind a signal moving at a steady speed. Starts from
+ * the first sample, unless reset() first.
+ */
+class AlphaBetaFilter {
+public:
+	AlphaBetaFilter(double alpha, double beta, double period);
+
+	void reset(double val);
+	double calc(double next);
+	double get();
+	double getVelocity();
+private:
+	double alpha;
+	double beta;
+	double period;
+	double value;
+	double velocity;
+	bool primed;
+};
+
+/**
+ * The "1 euro" filter: an exponential filter whose cutoff rises
+ * from `min_cutoff` Hz by `beta` Hz per unit/second the signal
+ * moves. Smooth at rest, with little lag when moving. Starts
+ * from the first sample, unless reset() first.
+ */
+class OneEuroFilter {
+public:
+	OneEuroFilter(double min_cutoff, double beta, double period);
+
+	void reset(double val);
+	double calc(double next);
+	double get();
+	double getVelocity();
+	void setCutoff(double min_cutoff, double beta);
+private:
+	double min_cutoff;
+	double beta;
+	double period;
+	ExponentialFilter value;
+	ExponentialFilter velocity;
+	bool primed;
 };
 
 #endif
@@ -0,0 +1,85 @@
+#include "executor.h"
+#include "constants.h"
+#include <stdio.h>
+
+const int ControlExecutor::kMaxLoops;
+
+ControlExecutor* ControlExecutor::GetInstance() {
+	static ControlExecutor* instance = NULL;
+	if (instance == NULL) {
+		instance = new ControlExecutor();
+	}
+	return instance;
+}
+
+ControlExecutor::ControlExecutor() {
+	num_loops = 0;
+}
+
+bool ControlExecutor::Add(const char* name, double period,
+		ControlCallback callback, void* arg, int32_t priority) {
+	if (num_loops >= kMaxLoops) {
+		printf("ControlExecutor: too many loops; dropped %s\n", name);
+		return false;
+	}
+	Loop& l = loops[num_loops];
+	l.name = name;
+	l.period = period;
+	l.callback = callback;
+	l.arg = arg;
+	l.priority = priority;
+	l.task = NULL;
+	l.schedule = NULL;
+	l.enabled = false;
+	l.wake = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+	num_loops++;
+	return true;
+}
+
+void ControlExecutor::Start() {
+	for (int i = 0; i < num_loops; i++) {
+		Loop& l = loops[i];
+		bool was_enabled = l.enabled;
+		l.enabled = true;
+		if (l.task == NULL) {
+			l.task = new Task(l.name, (FUNCPTR) ControlExecutor::callRun,
+					l.priority);
+			l.task->Start(i);
+		} else if (!was_enabled) {
+			semGive(l.wake);
+		}
+	}
+}
+
+void ControlExecutor::Stop() {
+	for (int i = 0; i < num_loops; i++) {
+		loops[i].enabled = false;
+	}
+}
+
+void ControlExecutor::PrintStats() {
+	for (int i = 0; i < num_loops; i++) {
+		if (loops[i].schedule != NULL) {
+			loops[i].schedule->printStats(loops[i].name);
+		}
+	}
+}
+
+int ControlExecutor::callRun(uint32_t loop) {
+	Loop* l = &GetInstance()->loops[loop];
+	LoopScheduler schedule(l->period, 0, l->name);
+	l->schedule = &schedule;
+
+	schedule.start();
+	while (true) {
+		if (!l->enabled) {
+			semTake(l->wake, WAIT_FOREVER);
+			schedule.start();
+			continue;
+		}
+		Constants::beginCycle();
+		l->callback(l->arg);
+		schedule.waitForNextTick();
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef UTIL_EXECUTOR_H_
+#define UTIL_EXECUTOR_H_
+
+#include "scheduler.h"
+#include "Task.h"
+#include <semLib.h>
+
+/**
+ * Called once per period on a ControlExecutor task.
+ */
+typedef void (*ControlCallback)(void* arg);
+
+/**
+ * Runs subsystem control callbacks, each at its own rate on its
+ * own task, on a LoopScheduler (absolute deadlines, overruns
+ * counted). A subsystem registers its callback once at
+ * construction; the robot then turns every loop on for the
+ * enabled modes and off when disabled.
+ * 
+ * Callbacks run concurrently with the main loop, so commands
+ * should be passed in through a Handoff.
+ */
+class ControlExecutor {
+public:
+	static const int kMaxLoops = 8;
+
+	static ControlExecutor* GetInstance();
+
+	/**
+	 * Call `callback(arg)` every `period` seconds while the
+	 * executor is started, on a task of the given priority.
+	 * 
+	 * Returns false if there are too many loops.
+	 */
+	bool Add(const char* name, double period, ControlCallback callback,
+			void* arg, int32_t priority = Task::kDefaultPriority);
+
+	/**
+	 * Begin (or resume) calling every callback.
+	 * The tasks are spawned on the first Start().
+	 */
+	void Start();
+	/**
+	 * Stop calling callbacks; each task waits, without ticking,
+	 * and returns to its deadline grid on the next Start().
+	 */
+	void Stop();
+
+	/**
+	 * Printf each loop's scheduling statistics.
+	 */
+	void PrintStats();
+private:
+	typedef struct {
+		const char* name;
+		double period;
+		ControlCallback callback;
+		void* arg;
+		int32_t priority;
+		Task* task;
+		LoopScheduler* schedule;
+		volatile bool enabled;
+		// given by Start() to wake a stopped task
+		SEM_ID wake;
+	} Loop;
+
+	ControlExecutor();
+	static int callRun(uint32_t loop);
+
+	Loop loops[kMaxLoops];
+	int num_loops;
+};
+
+#endif
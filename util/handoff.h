@@ -0,0 +1,57 @@
+#ifndef UTIL_HANDOFF_H_
+#define UTIL_HANDOFF_H_
+
+/**
+ * Lock-free hand-off of a value from one writer thread to one
+ * reader thread (a triple buffer). Neither side ever waits: the
+ * writer always has a slot of its own to fill, and the reader
+ * always gets the newest complete value.
+ * 
+ * Meant for setpoints and commands passed from the main loop to
+ * a control task; T should be a small plain struct.
+ */
+template<typename T>
+class Handoff {
+public:
+	Handoff() :
+		write_slot(0), middle(1), read_slot(2) {
+	}
+
+	/**
+	 * Writer only. Publish `value`.
+	 */
+	void write(const T& value) {
+		slots[write_slot] = value;
+		// the value must land before the slot is handed over
+		__sync_synchronize();
+		unsigned int old = __sync_lock_test_and_set(&middle, write_slot
+				| kFresh);
+		write_slot = old & kIndex;
+	}
+
+	/**
+	 * Reader only. Returns true, and fetches the newest value,
+	 * if one was written since the last read.
+	 */
+	bool read(T* value) {
+		bool fresh = (middle & kFresh) != 0;
+		if (fresh) {
+			unsigned int old = __sync_lock_test_and_set(&middle, read_slot);
+			read_slot = old & kIndex;
+			__sync_synchronize();
+		}
+		*value = slots[read_slot];
+		return fresh;
+	}
+private:
+	static const unsigned int kIndex = 3;
+	static const unsigned int kFresh = 4;
+
+	T slots[3];
+	unsigned int write_slot;
+	// the slot between writer and reader, and whether it holds news
+	volatile unsigned int middle;
+	unsigned int read_slot;
+};
+
+#endif
@@ -0,0 +1,354 @@
+#include "inputlog.h"
+#include "constants.h"
+#include "controllers.h"
+#include "safecanjag.h"
+#include "AnalogChannel.h"
+#include "AnalogModule.h"
+#include "Counter.h"
+#include "DigitalModule.h"
+#include "DriverStation.h"
+#include "Encoder.h"
+#include "Task.h"
+#include "Timer.h"
+#include "Utility.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace InputLog;
+
+// below the robot's main task and every control notifier
+const int WRITER_PRIORITY = 150;
+const double WRITE_PERIOD = 0.100;
+// must be a power of two; over half a second of main loops,
+// several times the writer's period
+const int RING_SIZE = 64;
+
+typedef struct {
+	CountKind kind;
+	void* sensor;
+} CountSource;
+
+static CountSource count_sources[kMaxCounts];
+static int num_counts = 0;
+static AnalogChannel* accumulators[kMaxAccumulators];
+static int num_accumulators = 0;
+static SafeCANJag* limit_jags[kMaxLimits];
+static int num_limits = 0;
+
+static volatile bool ready = false;
+static int fd = -1;
+static Header header;
+static std::vector<DoubleConstant*> constants;
+// kMaxSnapshots rows of constants.size(); filled by the main task,
+// written out by the writer
+static double* snapshots = NULL;
+static volatile uint32_t snapshot_count = 0;
+static uint32_t snapshots_written = 0;
+// the Constants epoch of the last snapshot; main task only
+static unsigned int snapshot_epoch = 0;
+
+static RingBuffer<Record, RING_SIZE> ring;
+static Record batch[RING_SIZE];
+static volatile unsigned int drops = 0;
+
+static Task* writer = NULL;
+static volatile bool running = false;
+static bool failed = false;
+
+static uint32_t snapshotOffset(uint32_t snapshot) {
+	return sizeof(Header) + constants.size() * kNameLength + snapshot
+			* constants.size() * sizeof(double);
+}
+
+static uint32_t recordOffset(uint32_t slot) {
+	return snapshotOffset(kMaxSnapshots) + slot * sizeof(Record);
+}
+
+static bool writeAt(uint32_t offset, const void* data, uint32_t len) {
+	if (failed) {
+		return false;
+	}
+	if (lseek(fd, offset, SEEK_SET) != (off_t) offset || write(fd,
+			(char*) data, len) != (ssize_t) len) {
+		printf("InputLog: write failed; no more records\n");
+		failed = true;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Write out everything queued. Only the writer task (or stop(),
+ * once the writer is gone) may flush.
+ */
+static void flush() {
+	bool wrote = false;
+	while (snapshots_written < snapshot_count) {
+		__sync_synchronize();
+		writeAt(snapshotOffset(snapshots_written), snapshots
+				+ snapshots_written * constants.size(), constants.size()
+				* sizeof(double));
+		snapshots_written++;
+		wrote = true;
+	}
+
+	int n = 0;
+	while (n < RING_SIZE && ring.pop(&batch[n])) {
+		n++;
+	}
+	int done = 0;
+	while (done < n) {
+		// in one piece, up to the end of the file
+		uint32_t slot = header.count % header.capacity;
+		int len = std::min((uint32_t) (n - done), header.capacity - slot);
+		writeAt(recordOffset(slot), &batch[done], len * sizeof(Record));
+		header.count += len;
+		done += len;
+		wrote = true;
+	}
+
+	if (wrote) {
+		header.dropped = drops;
+		header.snapshots = snapshots_written;
+		writeAt(0, &header, sizeof(header));
+	}
+}
+
+static int run() {
+	while (running) {
+		flush();
+		Wait(WRITE_PERIOD);
+	}
+	return 0;
+}
+
+void InputLog::addCounter(uint32_t channel, Counter* counter) {
+	if (num_counts == kMaxCounts) {
+		printf("InputLog: too many counters; not logging channel %u\n",
+				channel);
+		return;
+	}
+	header.count_kinds[num_counts] = kCounter;
+	header.count_channels[num_counts] = channel;
+	count_sources[num_counts].kind = kCounter;
+	count_sources[num_counts].sensor = counter;
+	num_counts++;
+}
+
+void InputLog::addEncoder(uint32_t channel, Encoder* encoder) {
+	if (num_counts == kMaxCounts) {
+		printf("InputLog: too many counters; not logging channel %u\n",
+				channel);
+		return;
+	}
+	header.count_kinds[num_counts] = kEncoder;
+	header.count_channels[num_counts] = channel;
+	count_sources[num_counts].kind = kEncoder;
+	count_sources[num_counts].sensor = encoder;
+	num_counts++;
+}
+
+void InputLog::addAccumulator(AnalogChannel* channel) {
+	if (num_accumulators == kMaxAccumulators) {
+		printf("InputLog: too many accumulators; not logging channel %u\n",
+				channel->GetChannel());
+		return;
+	}
+	header.accumulator_channels[num_accumulators] = channel->GetChannel();
+	accumulators[num_accumulators] = channel;
+	num_accumulators++;
+}
+
+void InputLog::addLimits(uint8_t device, SafeCANJag* jag) {
+	if (num_limits == kMaxLimits) {
+		printf("InputLog: too many Jaguars; not logging %u\n", device);
+		return;
+	}
+	header.limit_devices[num_limits] = device;
+	limit_jags[num_limits] = jag;
+	num_limits++;
+}
+
+bool InputLog::start(const char* path, uint32_t capacity) {
+	if (ready) {
+		return true;
+	}
+	// keep the last boot's log; there may be none
+	std::string previous = std::string(path) + ".1";
+	remove(previous.c_str());
+	rename(path, previous.c_str());
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		printf("InputLog: could not create %s; not logging\n", path);
+		return false;
+	}
+	constants = Constants::getDoubles();
+	memcpy(header.magic, kMagic, sizeof(header.magic));
+	header.byte_order = kByteOrder;
+	header.version = kVersion;
+	header.record_size = sizeof(Record);
+	header.capacity = capacity;
+	header.count = 0;
+	header.dropped = 0;
+	header.num_constants = constants.size();
+	header.snapshots = 0;
+	memset(header.reserved, 0, sizeof(header.reserved));
+
+	// allocate the whole file now, rather than a block at a time
+	// while the robot runs
+	if (ftruncate(fd, recordOffset(capacity)) != 0) {
+		printf("InputLog: could not allocate %s\n", path);
+	}
+	failed = false;
+	writeAt(0, &header, sizeof(header));
+	for (size_t i = 0; i < constants.size(); i++) {
+		char name[kNameLength];
+		memset(name, 0, sizeof(name));
+		strncpy(name, constants[i]->getName(), kNameLength - 1);
+		writeAt(sizeof(Header) + i * kNameLength, name, kNameLength);
+	}
+	if (failed) {
+		close(fd);
+		return false;
+	}
+
+	delete[] snapshots;
+	snapshots = new double[kMaxSnapshots * constants.size()];
+	snapshot_count = 0;
+	snapshots_written = 0;
+	drops = 0;
+	ready = true;
+	snapshotConstants();
+
+	running = true;
+	writer = new Task("InputLog", (FUNCPTR) run, WRITER_PRIORITY);
+	writer->Start();
+	printf("InputLog: logging to %s, %u records\n", path, capacity);
+	return true;
+}
+
+void InputLog::stop() {
+	if (!ready) {
+		return;
+	}
+	ready = false;
+	if (writer != NULL) {
+		// let the writer finish its current pass
+		running = false;
+		Wait(2 * WRITE_PERIOD);
+		delete writer;
+		writer = NULL;
+	}
+	flush();
+	close(fd);
+	fd = -1;
+}
+
+void InputLog::snapshotConstants() {
+	if (!ready) {
+		return;
+	}
+	snapshot_epoch = Constants::getEpoch();
+	size_t n = constants.size();
+	uint32_t last = snapshot_count;
+	if (last > 0) {
+		double* previous = snapshots + (last - 1) * n;
+		bool same = true;
+		for (size_t i = 0; i < n && same; i++) {
+			same = (previous[i] == double(*constants[i]));
+		}
+		if (same) {
+			return;
+		}
+	}
+	if (last == (uint32_t) kMaxSnapshots) {
+		printf("InputLog: out of snapshots; constants no longer logged\n");
+		return;
+	}
+	double* snapshot = snapshots + last * n;
+	for (size_t i = 0; i < n; i++) {
+		snapshot[i] = double(*constants[i]);
+	}
+	// the values must be visible before the writer sees the count
+	__sync_synchronize();
+	snapshot_count = last + 1;
+}
+
+void InputLog::record() {
+	if (!ready) {
+		return;
+	}
+	Record r;
+	memset(&r, 0, sizeof(r));
+	r.time_us = GetFPGATime();
+
+	DriverStation* ds = DriverStation::GetInstance();
+	for (int s = 0; s < kSticks; s++) {
+		for (int a = 0; a < kAxes; a++) {
+			r.axes[s][a] = ds->GetStickAxis(s + 1, a + 1);
+		}
+		r.buttons[s] = ds->GetStickButtons(s + 1);
+	}
+	r.battery = ds->GetBatteryVoltage();
+	if (ds->IsDisabled()) {
+		r.mode = kDisabled;
+	} else if (ds->IsAutonomous()) {
+		r.mode = kAutonomous;
+	} else if (ds->IsTest()) {
+		r.mode = kTest;
+	} else {
+		r.mode = kTeleop;
+	}
+
+	AnalogModule* analog = AnalogModule::GetInstance(
+			AnalogModule::kDefaultModule);
+	for (int i = 0; i < kAnalogChannels; i++) {
+		r.analog[i] = analog->GetAverageValue(i + 1);
+	}
+	// GetDIO() has channel n on bit 16 - n
+	uint16_t dio = DigitalModule::GetInstance(1)->GetDIO();
+	for (int i = 0; i < kDigitalChannels; i++) {
+		if (dio & (1 << (15 - i))) {
+			r.digital |= 1 << i;
+		}
+	}
+
+	for (int i = 0; i < num_counts; i++) {
+		if (count_sources[i].kind == kEncoder) {
+			r.counts[i] = ((Encoder*) count_sources[i].sensor)->Get();
+		} else {
+			r.counts[i] = ((Counter*) count_sources[i].sensor)->Get();
+		}
+	}
+	for (int i = 0; i < num_accumulators; i++) {
+		INT64 value;
+		uint32_t count;
+		accumulators[i]->GetAccumulatorOutput(&value, &count);
+		r.accumulator_values[i] = value;
+		r.accumulator_counts[i] = count;
+	}
+	for (int i = 0; i < num_limits; i++) {
+		double limits;
+		r.limits[i] = limit_jags[i]->GetCachedStatus(SafeCANJag::kStatusLimits,
+				&limits) ? (uint8_t) limits : kLimitsUnknown;
+	}
+	// a live reload or a profile switch, in the middle of a mode
+	if (Constants::getEpoch() != snapshot_epoch) {
+		snapshotConstants();
+	}
+	r.snapshot = snapshot_count - 1;
+
+	if (!ring.push(r)) {
+		drops++;
+	}
+}
+
+unsigned int InputLog::dropped() {
+	return drops;
+}
@@ -0,0 +1,144 @@
+#ifndef UTIL_INPUTLOG_H_
+#define UTIL_INPUTLOG_H_
+
+#include <stdint.h>
+
+class Counter;
+class Encoder;
+class AnalogChannel;
+class SafeCANJag;
+
+/**
+ * Records everything the robot reads, once per main loop, so a
+ * match can be played back through the code in the simulation
+ * (yolosim replay <log>; see sim/simreplay.h).
+ *
+ * Each record holds the driver station (mode, joysticks, battery),
+ * every analog input and the digital inputs, and the sensors that
+ * were registered: counters, encoders, gyro accumulators, and the
+ * limit inputs of Jaguars. The DoubleConstants are stored whenever
+ * snapshotConstants() finds them changed, and each record names the
+ * snapshot it ran with.
+ *
+ * record() only copies the readings into a RAM ring; a low priority
+ * writer task moves them to a file that was allocated up front, so
+ * the loop never waits on the disk. The file keeps the newest
+ * `capacity` records, overwriting the oldest; its header says how
+ * many have been written, and is rewritten after each flush, so a
+ * log cut short by a power loss is still good up to the last flush.
+ * The log of the previous boot is kept as <path>.1.
+ *
+ * File layout, in the robot's byte order (see kByteOrder):
+ *   Header
+ *   num_constants names, kNameLength bytes each
+ *   kMaxSnapshots snapshots, num_constants doubles each
+ *   capacity Records; record n is at n % capacity
+ */
+namespace InputLog {
+const char kMagic[8] = "YOLOINP";
+const uint32_t kVersion = 1;
+// reads back as 0x04030201 if the byte order differs
+const uint32_t kByteOrder = 0x01020304;
+const int kSticks = 4;
+const int kAxes = 6;
+const int kAnalogChannels = 8;
+const int kDigitalChannels = 14;
+const int kMaxCounts = 6;
+const int kMaxAccumulators = 2;
+const int kMaxLimits = 4;
+const int kMaxSnapshots = 64;
+const int kNameLength = 32;
+
+typedef enum {
+	kDisabled, kAutonomous, kTeleop, kTest
+} Mode;
+
+typedef enum {
+	kNone, kCounter, kEncoder
+} CountKind;
+
+// a limits entry that could not be read
+const uint8_t kLimitsUnknown = 0xFF;
+
+typedef struct {
+	char magic[8];
+	uint32_t byte_order;
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t capacity;
+	// records written since the start; the newest capacity are kept
+	uint32_t count;
+	// records lost because the ring was full
+	uint32_t dropped;
+	uint32_t num_constants;
+	uint32_t snapshots;
+	// what each slot of Record::counts is, and its digital channel
+	uint8_t count_kinds[kMaxCounts];
+	uint8_t count_channels[kMaxCounts];
+	// analog channel of each accumulator, and CAN ID of each limits
+	uint8_t accumulator_channels[kMaxAccumulators];
+	uint8_t limit_devices[kMaxLimits];
+	uint8_t reserved[6];
+} Header;
+
+/**
+ * One main loop's inputs; int64s first, so the layout is the
+ * same on every compiler.
+ */
+typedef struct {
+	int64_t accumulator_values[kMaxAccumulators];
+	// FPGA clock
+	uint32_t time_us;
+	uint32_t accumulator_counts[kMaxAccumulators];
+	// Counter::Get() or Encoder::Get()
+	int32_t counts[kMaxCounts];
+	float axes[kSticks][kAxes];
+	float battery;
+	uint16_t buttons[kSticks];
+	// averaged ADC values
+	int16_t analog[kAnalogChannels];
+	// bit n - 1 is digital input n
+	uint16_t digital;
+	// SafeCANJag::Limits, or kLimitsUnknown
+	uint8_t limits[kMaxLimits];
+	uint8_t mode;
+	uint8_t snapshot;
+} Record;
+
+/**
+ * Register a sensor to record. Call before start(); `channel` is the
+ * digital channel of the counter, or of the encoder's A phase.
+ */
+void addCounter(uint32_t channel, Counter* counter);
+void addEncoder(uint32_t channel, Encoder* encoder);
+void addAccumulator(AnalogChannel* channel);
+void addLimits(uint8_t device, SafeCANJag* jag);
+
+/**
+ * Create the log at `path`, with room for `capacity` records, and
+ * start the writer. Returns false (and record() does nothing) if the
+ * file could not be made.
+ */
+bool start(const char* path, uint32_t capacity);
+void stop();
+
+/**
+ * Store the constants, if they changed since the last snapshot.
+ * Call after Constants::load() and reload().
+ */
+void snapshotConstants();
+
+/**
+ * Read and queue this loop's inputs, and store the constants if the
+ * loop's snapshot of them is new. Call first thing in the loop, just
+ * after Constants::beginCycle().
+ */
+void record();
+
+/**
+ * Number of records dropped because the ring was full.
+ */
+unsigned int dropped();
+}
+
+#endif
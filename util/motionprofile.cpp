@@ -0,0 +1,163 @@
+#include "motionprofile.h"
+#include <math.h>
+
+MotionProfile::MotionProfile() {
+	plan(kTrapezoidal, 0.0, 1.0, 1.0);
+}
+
+double MotionProfile::position(const Trapezoid& tz, double t) {
+	if (t <= 0.0) {
+		return 0.0;
+	}
+	if (t < tz.t_accel) {
+		return 0.5 * tz.accel * t * t;
+	}
+	if (t < tz.t_accel + tz.t_cruise) {
+		return 0.5 * tz.accel * tz.t_accel * tz.t_accel + tz.peak * (t
+				- tz.t_accel);
+	}
+	if (t < tz.t_total) {
+		double left = tz.t_total - t;
+		return tz.distance - 0.5 * tz.accel * left * left;
+	}
+	return tz.distance;
+}
+
+double MotionProfile::velocity(const Trapezoid& tz, double t) {
+	if (t <= 0.0 || t >= tz.t_total) {
+		return 0.0;
+	}
+	if (t < tz.t_accel) {
+		return tz.accel * t;
+	}
+	if (t < tz.t_accel + tz.t_cruise) {
+		return tz.peak;
+	}
+	return tz.accel * (tz.t_total - t);
+}
+
+/**
+ * Integral of position() from 0 to t.
+ */
+double MotionProfile::integral(const Trapezoid& tz, double t) {
+	if (t <= 0.0) {
+		return 0.0;
+	}
+	const double a = tz.accel;
+	const double t1 = tz.t_accel;
+	const double t2 = tz.t_accel + tz.t_cruise;
+	const double T = tz.t_total;
+	if (t < t1) {
+		return a * t * t * t / 6.0;
+	}
+	double i1 = a * t1 * t1 * t1 / 6.0;
+	if (t < t2) {
+		double dt = t - t1;
+		return i1 + 0.5 * a * t1 * t1 * dt + 0.5 * tz.peak * dt * dt;
+	}
+	double c = t2 - t1;
+	double i2 = i1 + 0.5 * a * t1 * t1 * c + 0.5 * tz.peak * c * c;
+	double end = t < T ? t : T;
+	double gone = T - t2;
+	double left = T - end;
+	double i3 = i2 + tz.distance * (end - t2) - a / 6.0 * (gone * gone * gone
+			- left * left * left);
+	return i3 + tz.distance * (t - end);
+}
+
+void MotionProfile::plan(Shape shape, double dist, double max_velocity,
+		double max_acceleration, double max_jerk) {
+	if (max_velocity <= 0.0 || max_acceleration <= 0.0) {
+		// no move fits in these limits: at rest where it starts
+		dist = 0.0;
+		max_velocity = 1.0;
+		max_acceleration = 1.0;
+		max_jerk = 0.0;
+	}
+	distance = dist;
+	const double sign = dist < 0.0 ? -1.0 : 1.0;
+
+	Trapezoid tz;
+	tz.distance = fabs(dist);
+	tz.accel = max_acceleration;
+	tz.t_accel = max_velocity / max_acceleration;
+	if (tz.distance < max_velocity * tz.t_accel) {
+		// never reaches full speed
+		tz.t_accel = sqrt(tz.distance / max_acceleration);
+		tz.t_cruise = 0.0;
+	} else {
+		tz.t_cruise = (tz.distance - max_velocity * tz.t_accel) / max_velocity;
+	}
+	tz.peak = tz.accel * tz.t_accel;
+	tz.t_total = 2 * tz.t_accel + tz.t_cruise;
+
+	// averaging window; none for the plain trapezoid
+	double window = 0.0;
+	if (shape == kSCurve && max_jerk > 0.0) {
+		window = max_acceleration / max_jerk;
+	}
+	duration = tz.t_total + window;
+
+	step = kStep;
+	if (duration / step > kMaxPoints - 1) {
+		step = duration / (kMaxPoints - 1);
+	}
+	points = (int) ceil(duration / step) + 1;
+	if (points > kMaxPoints) {
+		points = kMaxPoints;
+	}
+
+	for (int i = 0; i < points; i++) {
+		double t = i * step;
+		Point& p = table[i];
+		if (window > 0.0) {
+			double before = t - window;
+			p.position = (integral(tz, t) - integral(tz, before)) / window;
+			p.velocity = (position(tz, t) - position(tz, before)) / window;
+			p.acceleration = (velocity(tz, t) - velocity(tz, before)) / window;
+		} else {
+			p.position = position(tz, t);
+			p.velocity = velocity(tz, t);
+			p.acceleration = t < tz.t_accel ? tz.accel : 0.0;
+			if (t >= tz.t_accel + tz.t_cruise && t < tz.t_total) {
+				p.acceleration = -tz.accel;
+			}
+		}
+		p.position *= sign;
+		p.velocity *= sign;
+		p.acceleration *= sign;
+	}
+	// at rest, exactly there
+	Point& last = table[points - 1];
+	last.position = dist;
+	last.velocity = 0.0;
+	last.acceleration = 0.0;
+}
+
+void MotionProfile::sample(double time, Point* point) {
+	if (time <= 0.0) {
+		*point = table[0];
+		return;
+	}
+	double x = time / step;
+	int i = (int) x;
+	if (i >= points - 1) {
+		*point = table[points - 1];
+		return;
+	}
+	double f = x - i;
+	const Point& a = table[i];
+	const Point& b = table[i + 1];
+	point->position = a.position + f * (b.position - a.position);
+	point->velocity = a.velocity + f * (b.velocity - a.velocity);
+	point->acceleration = a.acceleration + f * (b.acceleration
+			- a.acceleration);
+}
+
+double MotionProfile::getDuration() {
+	return duration;
+}
+
+double MotionProfile::getDistance() {
+	return distance;
+}
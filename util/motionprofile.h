@@ -0,0 +1,79 @@
+#ifndef MOTION_PROFILE_H_
+#define MOTION_PROFILE_H_
+
+/**
+ * A move from rest to rest, planned once and tabulated by time,
+ * so that following it costs a table lookup per step and does
+ * not depend on how regularly the steps come.
+ *
+ * Trapezoidal profiles limit velocity and acceleration. S-curve
+ * profiles also limit jerk: they are the trapezoid averaged over
+ * the time it takes to reach full acceleration (max_acceleration
+ * / max_jerk), which makes them that much longer.
+ *
+ * Planning is not threadsafe with sampling; plan on the thread
+ * that samples.
+ */
+class MotionProfile {
+public:
+	// enough for 5 s at kStep
+	static const int kMaxPoints = 512;
+	// seconds between points, unless the move needs them farther apart
+	static const double kStep = 0.01;
+
+	typedef enum {
+		kTrapezoidal, kSCurve
+	} Shape;
+
+	typedef struct {
+		// units, units per second, units per second per second
+		double position;
+		double velocity;
+		double acceleration;
+	} Point;
+
+	MotionProfile();
+
+	/**
+	 * Plan a move of `distance` (signed) from position 0; the
+	 * limits are positive. With a velocity or acceleration limit
+	 * of 0 or less, the move is planned with no length.
+	 */
+	void plan(Shape shape, double distance, double max_velocity,
+			double max_acceleration, double max_jerk = 0.0);
+
+	/**
+	 * Where the profile is `time` seconds after it starts;
+	 * at rest before and after the move.
+	 */
+	void sample(double time, Point* point);
+
+	/**
+	 * Seconds the move takes.
+	 */
+	double getDuration();
+	double getDistance();
+private:
+	// the trapezoid, for a distance of at least 0
+	typedef struct {
+		double distance;
+		double accel;
+		double peak;
+		// time accelerating (= decelerating), cruising, in total
+		double t_accel;
+		double t_cruise;
+		double t_total;
+	} Trapezoid;
+
+	static double position(const Trapezoid& tz, double t);
+	static double velocity(const Trapezoid& tz, double t);
+	static double integral(const Trapezoid& tz, double t);
+
+	Point table[kMaxPoints];
+	int points;
+	double step;
+	double duration;
+	double distance;
+};
+
+#endif // MOTION_PROFILE_H_
@@ -1,4 +1,5 @@
 #include "multimotor.h"
+#include "CAN/can_proto.h"
 #include <stdio.h>
 
 //
@@ -10,42 +11,67 @@
 
 
 std::set<MultiMotor*> MultiMotor::mms = std::set<MultiMotor*>();
+CANPipeline MultiMotor::pipe;
 // 'cause we type it to much
 typedef std::vector<SafeCANJag*>::iterator j_t;
 
+/**
+ * Decode a pipelined 8.8 fixed point read; 0.0 if it failed.
+ */
+static double readFXP8_8(CANTransaction* t) {
+	if (t == NULL || !t->succeeded() || t->getDataSize() != sizeof(int16_t)) {
+		return 0.0;
+	}
+	return SafeCANJag::unpackFXP8_8(t->getData());
+}
+
+/**
+ * A Jaguar that waits for BringUpAll().
+ */
+static SafeCANJag* deferred(uint8_t id) {
+	return new SafeCANJag(id, SafeCANJag::kPercentVbus, true);
+}
+
 MultiMotor::MultiMotor(uint8_t a, bool is_break) {
-	jags.push_back(new SafeCANJag(a));
+	jags.push_back(deferred(a));
 	init(is_break);
 }
 MultiMotor::MultiMotor(uint8_t a, uint8_t b, bool is_break) {
-	jags.push_back(new SafeCANJag(a));
-	jags.push_back(new SafeCANJag(b));
+	jags.push_back(deferred(a));
+	jags.push_back(deferred(b));
 	init(is_break);
 }
 MultiMotor::MultiMotor(uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint8_t e,
 		uint8_t f, bool is_break) {
-	jags.push_back(new SafeCANJag(a));
-	jags.push_back(new SafeCANJag(b));
-	jags.push_back(new SafeCANJag(c));
-	jags.push_back(new SafeCANJag(d));
-	jags.push_back(new SafeCANJag(e));
-	jags.push_back(new SafeCANJag(f));
+	jags.push_back(deferred(a));
+	jags.push_back(deferred(b));
+	jags.push_back(deferred(c));
+	jags.push_back(deferred(d));
+	jags.push_back(deferred(e));
+	jags.push_back(deferred(f));
 	init(is_break);
 }
 void MultiMotor::init(bool is_break) {
-	SetBreakMode(is_break);
+	// sent by BringUpAll()
+	break_mode = is_break;
+	brought_up = false;
+	staged = false;
 	last_set = 0.0;
 	mms.insert(this);
 }
 MultiMotor::~MultiMotor() {
 	mms.erase(this);
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
+		CANStatusPoller::GetInstance()->Remove(*i);
 		delete *i;
 	}
 }
 
 void MultiMotor::SetBreakMode(bool is_break) {
 	break_mode = is_break;
+	if (!brought_up) {
+		return;
+	}
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
 		(*i)->ConfigNeutralMode(break_mode ? SafeCANJag::kNeutralMode_Brake : SafeCANJag::kNeutralMode_Coast);
 		
@@ -75,6 +101,12 @@ void MultiMotor::Reflash() {
 	}
 }
 
+void MultiMotor::PollStatus(uint16_t fields) {
+	for (j_t i = jags.begin(); i != jags.end(); i++) {
+		CANStatusPoller::GetInstance()->Add(*i, fields);
+	}
+}
+
 SafeCANJag* MultiMotor::GetByID(uint8_t can_id) {
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
 		SafeCANJag* m = *i;
@@ -95,6 +127,11 @@ SafeCANJag* MultiMotor::GetIdx(int idx) {
 }
 
 void MultiMotor::Set(double setpoint) {
+	if (!brought_up) {
+		// the Jaguars start stopped
+		last_set = setpoint;
+		return;
+	}
 	if (jags.size() == 1) {
 		jags[0]->Set(setpoint);
 		return;
@@ -102,24 +139,89 @@ void MultiMotor::Set(double setpoint) {
 
 	const uint8_t sync = 0x01;
 	last_set = setpoint;
-	for (std::vector<SafeCANJag*>::iterator i = jags.begin(); i != jags.end(); i++) {
-		(*i)->Set(setpoint, sync);
+	pipe.clear();
+	for (j_t i = jags.begin(); i != jags.end(); i++) {
+		(*i)->SetAsync(pipe, setpoint, sync);
 	}
+	if (pipe.pending() == 0) {
+		// every Jaguar already has this setpoint
+		return;
+	}
+	// the sync frame queues up right behind the setpoints,
+	// so the acks are all collected in one round trip
+	pipe.send();
 	SafeCANJag::UpdateSyncGroup(sync);
-
+	pipe.flush();
 }
 void MultiMotor::SetUnsynced(double setpoint) {
 	last_set = setpoint;
+	if (!brought_up) {
+		return;
+	}
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
 		(*i)->Set(setpoint);
 	}
 }
 
+void MultiMotor::Stage(double setpoint) {
+	last_set = setpoint;
+	staged = true;
+}
+
+void MultiMotor::CommitAll() {
+	const uint8_t sync = 0x01;
+	pipe.clear();
+	for (std::set<MultiMotor*>::iterator m = mms.begin(); m != mms.end(); m++) {
+		MultiMotor* mm = *m;
+		if (!mm->staged || !mm->brought_up) {
+			// the Jaguars start stopped; last_set waits for them
+			continue;
+		}
+		mm->staged = false;
+		for (j_t i = mm->jags.begin(); i != mm->jags.end(); i++) {
+			(*i)->SetAsync(pipe, mm->last_set, sync);
+		}
+	}
+	if (pipe.pending() == 0) {
+		// every Jaguar already has its setpoint
+		return;
+	}
+	pipe.send();
+	SafeCANJag::UpdateSyncGroup(sync);
+	pipe.flush();
+}
+
+void MultiMotor::SetKeepalive(double seconds) {
+	for (j_t i = jags.begin(); i != jags.end(); i++) {
+		(*i)->SetKeepalive(seconds);
+	}
+}
+
+void MultiMotor::GetWriteCounts(uint32_t* sent, uint32_t* suppressed) {
+	*sent = 0;
+	*suppressed = 0;
+	for (j_t i = jags.begin(); i != jags.end(); i++) {
+		*sent += (*i)->GetSetsSent();
+		*suppressed += (*i)->GetSetsSuppressed();
+	}
+}
+
 void MultiMotor::PrintFaults() {
+	pipe.clear();
+	std::vector<CANTransaction*> reads;
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
-		SafeCANJag* x = *i;
-		uint16_t code = x->GetFaults();
-		int id = x->getID();
+		reads.push_back((*i)->getTransactionAsync(pipe, LM_API_STATUS_FAULT));
+	}
+	pipe.flush();
+
+	for (size_t k = 0; k < jags.size(); k++) {
+		CANTransaction* t = reads[k];
+		if (t == NULL || !t->succeeded() || t->getDataSize()
+				!= sizeof(uint16_t)) {
+			continue;
+		}
+		uint16_t code = SafeCANJag::unpackint16_t(t->getData());
+		int id = jags[k]->getID();
 
 		if (code & SafeCANJag::kCurrentFault) {
 			printf("Jaguar Current Fault: %d\n", id);
@@ -137,13 +239,67 @@ void MultiMotor::PrintFaults() {
 }
 
 void MultiMotor::LogState() {
+	static const uint32_t kStatus[] = { LM_API_STATUS_VOLTBUS,
+			LM_API_STATUS_CURRENT, LM_API_STATUS_TEMP, LM_API_STATUS_VOUT };
+	const int n = sizeof(kStatus) / sizeof(kStatus[0]);
+
+	pipe.clear();
+	std::vector<CANTransaction*> reads;
 	for (j_t i = jags.begin(); i != jags.end(); i++) {
-		SafeCANJag* x = *i;
+		for (int s = 0; s < n; s++) {
+			reads.push_back((*i)->getTransactionAsync(pipe, kStatus[s]));
+		}
+	}
+	pipe.flush();
 
+	for (size_t k = 0; k < jags.size(); k++) {
 		printf("id: %d; ivolt %2.6f, curr %2.6f, temp %2.6f, ovolt %2.6f\n",
-				x->getID(), x->GetBusVoltage(), x->GetOutputCurrent(),
-				x->GetTemperature(), x->GetOutputVoltage());
+				jags[k]->getID(), readFXP8_8(reads[k * n]),
+				readFXP8_8(reads[k * n + 1]), readFXP8_8(reads[k * n + 2]),
+				readFXP8_8(reads[k * n + 3]));
+	}
+	uint32_t sent, suppressed;
+	GetWriteCounts(&sent, &suppressed);
+	printf("setpoint writes: %u sent, %u suppressed\n", sent, suppressed);
+}
+
+int MultiMotor::BringUpAll() {
+	// the versions must outlive the enables' round trip
+	static CANPipeline enables;
+	std::vector<SafeCANJag*> all;
+	std::vector<CANTransaction*> versions;
+
+	// the version read and the neutral mode write expect different
+	// replies, so both go out in the same round trip
+	pipe.clear();
+	for (std::set<MultiMotor*>::iterator m = mms.begin(); m != mms.end(); m++) {
+		MultiMotor* mm = *m;
+		if (mm->brought_up) {
+			continue;
+		}
+		mm->brought_up = true;
+		uint8_t mode = mm->break_mode ? SafeCANJag::kNeutralMode_Brake
+				: SafeCANJag::kNeutralMode_Coast;
+		for (j_t i = mm->jags.begin(); i != mm->jags.end(); i++) {
+			all.push_back(*i);
+			versions.push_back((*i)->InitAsync(pipe));
+			(*i)->setTransactionAsync(pipe, LM_API_CFG_BRAKE_COAST, &mode,
+					sizeof(mode));
+		}
+	}
+	pipe.flush();
+
+	int missing = 0;
+	enables.clear();
+	for (size_t i = 0; i < all.size(); i++) {
+		if (versions[i] == NULL || !versions[i]->succeeded()) {
+			printf("Jaguar %d did not answer\n", all[i]->getID());
+			missing++;
+		}
+		all[i]->FinishInitAsync(versions[i], enables);
 	}
+	enables.flush();
+	return missing;
 }
 
 void MultiMotor::ReflashAll() {
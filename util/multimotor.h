@@ -2,6 +2,7 @@
 #define UTIL_MULTIMOTOR_H_
 
 #include "safecanjag.h"
+#include "canstatus.h"
 #include <vector>
 #include <set>
 
@@ -15,6 +16,11 @@
  * on Jaguars take 0.25 ms, while read operations need
  * 2.5 ms.
  * 
+ * Constructing a MultiMotor sends nothing: its Jaguars are
+ * brought up, together with every other MultiMotor's, by
+ * BringUpAll(), and do not run until then (Set() before
+ * then is ignored).
+ * 
  * This class is NOT threadsafe.
  */
 class MultiMotor {
@@ -39,7 +45,7 @@ public:
 	 * Printf any faults occuring to the constituent motor
 	 * controllers.
 	 * 
-	 * Cost: N READS
+	 * Cost: N READS, pipelined (about 1 READ of latency)
 	 */
 	void PrintFaults();
 	
@@ -47,7 +53,7 @@ public:
 	 * Printf log input voltage, current, temperature, and 
 	 * output voltage.
 	 * 
-	 * Cost: 4*N READS
+	 * Cost: 4*N READS, pipelined (about 1 READ of latency)
 	 */
 	void LogState();
 	
@@ -67,6 +73,15 @@ public:
 	 */
 	void Reflash();
 	
+	/**
+	 * Have the CANStatusPoller keep the given status fields
+	 * (a bit-mask of 1 << SafeCANJag::StatusField) of all
+	 * motor controllers cached.
+	 * 
+	 * Cost: none here; N*K READS per poll, in the background
+	 */
+	void PollStatus(uint16_t fields);
+
 	/**
 	 * Get a specific motor controller instance.
 	 * 
@@ -78,9 +93,15 @@ public:
 	
 	/**
 	 * Set the output of all motors to a given value.
+	 * The setpoints and the sync group update are sent back
+	 * to back, and the acks collected together.
+	 * 
+	 * Writes of a setpoint the motors already hold are
+	 * dropped, except every keepalive interval.
 	 * 
-	 * Cost: / N > 1 => (N+1) WRITES \
-	 *       \ N = 1 => 1 WRITE      /
+	 * Cost: / N > 1 => (N+1) WRITES, about 1 WRITE of latency \
+	 *       \ N = 1 => 1 WRITE                                /
+	 *       (none if the setpoint is unchanged)
 	 */
 	void Set(double setpoint);
 	/**
@@ -90,7 +111,53 @@ public:
 	 * Cost: N WRITES
 	 */
 	void SetUnsynced(double setpoint);
+	/**
+	 * Record the output all motors should have; nothing is sent
+	 * until CommitAll(). Staging again before then replaces it.
+	 * 
+	 * Cost: none
+	 */
+	void Stage(double setpoint);
 	
+	/**
+	 * Set the keepalive interval of all motors: how long an
+	 * unchanged setpoint may go without being re-sent.
+	 * 0 sends every write.
+	 * 
+	 * Cost: none
+	 */
+	void SetKeepalive(double seconds);
+	/**
+	 * Total setpoint frames sent, and writes dropped as
+	 * duplicates, over all motors.
+	 * 
+	 * Cost: none
+	 */
+	void GetWriteCounts(uint32_t* sent, uint32_t* suppressed);
+	
+	/**
+	 * Bring up the Jaguars of every MultiMotor not yet brought up:
+	 * check their firmware, set their neutral modes and enable
+	 * them, all at once rather than one Jaguar at a time.
+	 * 
+	 * Returns the number of Jaguars that did not answer.
+	 * 
+	 * Cost: J READS and 2*J WRITES, pipelined
+	 *       (about 2 READS of latency)
+	 */
+	static int BringUpAll();
+
+	/**
+	 * Send the setpoints Stage()d on every MultiMotor since the
+	 * last commit, with one sync group update, so that all of
+	 * them change output together. Call once, at the end of
+	 * the loop that staged them.
+	 * 
+	 * Cost: K WRITES + 1, pipelined (about 1 WRITE of latency)
+	 *       (K is the number of changed setpoints; none if 0)
+	 */
+	static void CommitAll();
+
 	/**
 	 * Reflash() all MultiMotors in existence.
 	 * 
@@ -102,10 +169,14 @@ private:
 	void init(bool);
 	void reflashIndividual(SafeCANJag*);
 	bool break_mode;
+	bool brought_up;
+	// Stage()d since the last CommitAll()
+	bool staged;
 	double last_set;
 	std::vector<SafeCANJag*> jags;
 
 	static std::set<MultiMotor*> mms;
+	static CANPipeline pipe;
 };
 
 
@@ -0,0 +1,189 @@
+#include "odometry.h"
+#include "Timer.h"
+#include <math.h>
+
+// reads torn by the poller before giving up on the history
+const int READ_ATTEMPTS = 4;
+// velocity is taken over this many periods, to smooth the
+// counters' one-edge steps
+const unsigned int VELOCITY_SPAN = 4;
+
+static void interpolate(const Odometry::Pose& a, const Odometry::Pose& b,
+		double f, Odometry::Pose* out) {
+	out->time = a.time + f * (b.time - a.time);
+	out->x = a.x + f * (b.x - a.x);
+	out->y = a.y + f * (b.y - a.y);
+	out->heading = a.heading + f * (b.heading - a.heading);
+	out->distance = a.distance + f * (b.distance - a.distance);
+	out->velocity = a.velocity + f * (b.velocity - a.velocity);
+	out->turn_rate = a.turn_rate + f * (b.turn_rate - a.turn_rate);
+}
+
+Odometry::Odometry(Counter& l, Counter& r, RollingGyro& g, double ipt) :
+	left(l), right(r), gyro(g), inches_per_tick(ipt),
+			poller(Odometry::callPoll, this) {
+	left_dir = 1;
+	right_dir = 1;
+	written = 0;
+	first = 0;
+	for (int i = 0; i < kHistory; i++) {
+		history[i].seq = 0;
+		history[i].index = ~0u;
+	}
+	Reset();
+	poller.StartPeriodic(kPeriod);
+}
+
+Odometry::~Odometry() {
+	poller.Stop();
+}
+
+void Odometry::Reset() {
+	reset_left = left.Get();
+	reset_right = right.Get();
+	reset_heading = gyro.GetAngle();
+	__sync_synchronize();
+	restart = true;
+}
+
+void Odometry::SetDirection(double l, double r) {
+	if (l != 0.0) {
+		left_dir = l > 0.0 ? 1 : -1;
+	}
+	if (r != 0.0) {
+		right_dir = r > 0.0 ? 1 : -1;
+	}
+}
+
+void Odometry::origin(Pose* pose) {
+	pose->time = GetTime();
+	pose->x = 0.0;
+	pose->y = 0.0;
+	pose->heading = 0.0;
+	pose->distance = 0.0;
+	pose->velocity = 0.0;
+	pose->turn_rate = 0.0;
+}
+
+bool Odometry::readSlot(unsigned int index, Pose* pose) {
+	const Slot& slot = history[index & (kHistory - 1)];
+	unsigned int seq = slot.seq;
+	__sync_synchronize();
+	*pose = slot.pose;
+	unsigned int found = slot.index;
+	__sync_synchronize();
+	return (seq & 1) == 0 && slot.seq == seq && found == index;
+}
+
+void Odometry::GetPose(Pose* pose) {
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		unsigned int end = written;
+		if (restart || end == first) {
+			break;
+		}
+		if (readSlot(end - 1, pose)) {
+			return;
+		}
+	}
+	origin(pose);
+}
+
+void Odometry::GetPoseAt(double time, Pose* pose) {
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		unsigned int end = written;
+		__sync_synchronize();
+		unsigned int begin = first;
+		if (restart || end == begin) {
+			break;
+		}
+		// the oldest slot may be overwritten as we read it
+		if (end - begin > (unsigned int) kHistory - 1) {
+			begin = end - (kHistory - 1);
+		}
+		unsigned int i = end - 1;
+		Pose newer, older;
+		if (!readSlot(i, &newer)) {
+			continue;
+		}
+		bool torn = false;
+		while (!torn && newer.time > time && i != begin) {
+			i--;
+			if (!readSlot(i, &older)) {
+				torn = true;
+			} else if (older.time <= time) {
+				double f = (time - older.time) / (newer.time - older.time);
+				interpolate(older, newer, f, pose);
+				return;
+			} else {
+				newer = older;
+			}
+		}
+		if (!torn) {
+			*pose = newer;
+			return;
+		}
+	}
+	GetPose(pose);
+}
+
+/**
+ * Integrate the counters and gyro since the last poll into a
+ * new pose; on the poller notifier.
+ */
+void Odometry::Poll() {
+	uint32_t l = left.Get();
+	uint32_t r = right.Get();
+	double heading = gyro.GetAngle();
+	double now = GetTime();
+	if (restart) {
+		__sync_synchronize();
+		last_left = reset_left;
+		last_right = reset_right;
+		heading_zero = reset_heading;
+		origin(&last);
+		first = written;
+		__sync_synchronize();
+		restart = false;
+	}
+
+	Pose p;
+	p.time = now;
+	p.heading = heading - heading_zero;
+	double d_left = (int32_t) (l - last_left) * left_dir * inches_per_tick;
+	double d_right = (int32_t) (r - last_right) * right_dir
+			* inches_per_tick;
+	double d = (d_left + d_right) / 2;
+	// along the heading halfway through the period
+	double mid = (last.heading + p.heading) / 2 * M_PI / 180.0;
+	p.x = last.x + d * cos(mid);
+	p.y = last.y + d * sin(mid);
+	p.distance = last.distance + d;
+	p.turn_rate = gyro.GetRate();
+
+	unsigned int n = written;
+	if (n - first >= VELOCITY_SPAN) {
+		const Pose& old = history[(n - VELOCITY_SPAN) & (kHistory - 1)].pose;
+		p.velocity = (p.distance - old.distance) / (now - old.time);
+	} else if (now > last.time) {
+		p.velocity = d / (now - last.time);
+	} else {
+		p.velocity = 0.0;
+	}
+	last_left = l;
+	last_right = r;
+	last = p;
+
+	Slot& slot = history[n & (kHistory - 1)];
+	slot.seq++;
+	__sync_synchronize();
+	slot.pose = p;
+	slot.index = n;
+	__sync_synchronize();
+	slot.seq++;
+	__sync_synchronize();
+	written = n + 1;
+}
+
+void Odometry::callPoll(void* x) {
+	((Odometry*) x)->Poll();
+}
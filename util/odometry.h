@@ -0,0 +1,102 @@
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include "Counter.h"
+#include "Notifier.h"
+#include "rollinggyro.h"
+
+/**
+ * Dead reckoning for a tank drive: a notifier reads both drive
+ * counters and the gyro every kPeriod, and integrates them into
+ * a pose on the field, which it keeps for the last kHistory
+ * periods. Like RollingGyro, reads never lock; GetPose() is the
+ * newest pose and GetPoseAt() interpolates.
+ *
+ * The counters see edges whichever way the wheels turn, so the
+ * direction of each side is taken from the power last applied
+ * to it (SetDirection()); after a reversal, the few edges before
+ * the wheels stop count the wrong way.
+ */
+class Odometry {
+public:
+	// a power of two; 0.64 s of poses
+	static const int kHistory = 128;
+	static const double kPeriod = 0.005;
+
+	typedef struct {
+		// GetTime() seconds
+		double time;
+		// inches from where Reset() was called, x along the
+		// heading then, y toward positive heading
+		double x;
+		double y;
+		// degrees, in the gyro's sense; 0 at Reset()
+		double heading;
+		// inches travelled (by the middle of the robot), signed
+		double distance;
+		// inches per second forward, and degrees per second
+		double velocity;
+		double turn_rate;
+	} Pose;
+
+	Odometry(Counter& left, Counter& right, RollingGyro& gyro,
+			double inches_per_tick);
+	virtual ~Odometry();
+
+	/**
+	 * Make the robot's current position the origin, facing
+	 * heading 0. Reads see the new origin at once.
+	 */
+	void Reset();
+	/**
+	 * Which way each side is driven; only the signs count,
+	 * and 0 keeps the previous direction.
+	 */
+	void SetDirection(double left, double right);
+
+	void GetPose(Pose* pose);
+	/**
+	 * The pose at `time` (GetTime() seconds), between the two
+	 * around it; clamped to the oldest and newest kept.
+	 */
+	void GetPoseAt(double time, Pose* pose);
+private:
+	void Poll();
+	static void callPoll(void*);
+	void origin(Pose* pose);
+	bool readSlot(unsigned int index, Pose* pose);
+	// a pose, behind a sequence count that is odd while it is written
+	typedef struct {
+		volatile unsigned int seq;
+		unsigned int index;
+		Pose pose;
+	} Slot;
+
+	Counter& left;
+	Counter& right;
+	RollingGyro& gyro;
+	double inches_per_tick;
+	Notifier poller;
+
+	// +1 or -1, by SetDirection()
+	volatile int left_dir;
+	volatile int right_dir;
+
+	// by Reset(): the readings that make the origin
+	volatile bool restart;
+	uint32_t reset_left;
+	uint32_t reset_right;
+	double reset_heading;
+
+	// written by the poller only
+	Slot history[kHistory];
+	volatile unsigned int written;
+	// the first pose since the last Reset()
+	volatile unsigned int first;
+	uint32_t last_left;
+	uint32_t last_right;
+	double heading_zero;
+	Pose last;
+};
+
+#endif // ODOMETRY_H_
@@ -0,0 +1,212 @@
+#include "path.h"
+#include <math.h>
+#include <stdio.h>
+
+#define RAD_PER_DEG (M_PI / 180.0)
+
+Path::Path() {
+	clear();
+}
+
+void Path::clear() {
+	points = 1;
+	step = kStep;
+	length = 0.0;
+	accel = 0.0;
+	legs = 0;
+	reversal_count = 0;
+	Point& p = table[0];
+	p.x = 0.0;
+	p.y = 0.0;
+	p.heading = 0.0;
+	p.curvature = 0.0;
+	p.speed = 0.0;
+	p.acceleration = 0.0;
+	p.direction = 1.0;
+}
+
+/**
+ * Where `along` inches of `leg` takes a robot at `from`.
+ */
+void Path::advance(const Leg& leg, double along, const Point& from,
+		Point* to) {
+	double dir = leg.length < 0.0 ? -1.0 : 1.0;
+	double run = fabs(leg.length);
+	double turn = run > 0.0 ? leg.turn * along / run : 0.0;
+	double h0 = from.heading * RAD_PER_DEG;
+	if (turn == 0.0) {
+		to->x = from.x + dir * along * cos(h0);
+		to->y = from.y + dir * along * sin(h0);
+	} else {
+		// along an arc of radius along / turn
+		double r = along / (turn * RAD_PER_DEG);
+		double h1 = h0 + turn * RAD_PER_DEG;
+		to->x = from.x + dir * r * (sin(h1) - sin(h0));
+		to->y = from.y + dir * r * (cos(h0) - cos(h1));
+	}
+	to->heading = from.heading + turn;
+	to->curvature = run > 0.0 ? leg.turn / run : 0.0;
+	to->direction = dir;
+}
+
+bool Path::build(const Leg* list, int count, double max_speed,
+		double max_acceleration) {
+	clear();
+	if (count > kMaxLegs) {
+		printf("Path: %d legs, more than %d\n", count, kMaxLegs);
+		return false;
+	}
+	if (count == 0) {
+		return true;
+	}
+	legs = count;
+	accel = max_acceleration;
+	for (int i = 0; i < count; i++) {
+		length += fabs(list[i].length);
+		leg_ends[i] = length;
+	}
+
+	if (length / step > kMaxPoints - 1) {
+		step = length / (kMaxPoints - 1);
+	}
+	points = (int) ceil(length / step) + 1;
+	if (points > kMaxPoints) {
+		points = kMaxPoints;
+	}
+
+	// where the current leg starts
+	Point start = table[0];
+	double start_at = 0.0;
+	int leg = 0;
+	for (int i = 0; i < points; i++) {
+		double s = i * step;
+		if (s > length) {
+			s = length;
+		}
+		// legs cover [start, end); the last point is on the last leg
+		while (leg < count - 1 && s >= leg_ends[leg]) {
+			advance(list[leg], fabs(list[leg].length), start, &start);
+			start_at = leg_ends[leg];
+			leg++;
+		}
+		advance(list[leg], s - start_at, start, &table[i]);
+		table[i].speed = max_speed;
+	}
+
+	// stopped at the start, the end, and wherever direction changes
+	table[0].speed = 0.0;
+	table[points - 1].speed = 0.0;
+	for (int i = 0; i + 1 < count; i++) {
+		if ((list[i].length < 0.0) != (list[i + 1].length < 0.0)) {
+			reversals[reversal_count++] = leg_ends[i];
+			int at = (int) floor(leg_ends[i] / step + 0.5);
+			if (at < points) {
+				table[at].speed = 0.0;
+			}
+		}
+	}
+	// no faster than it can speed up from, or slow down for, a stop
+	double dv = 2 * max_acceleration * step;
+	for (int i = 1; i < points; i++) {
+		double v = sqrt(table[i - 1].speed * table[i - 1].speed + dv);
+		if (table[i].speed > v) {
+			table[i].speed = v;
+		}
+	}
+	for (int i = points - 2; i >= 0; i--) {
+		double v = sqrt(table[i + 1].speed * table[i + 1].speed + dv);
+		if (table[i].speed > v) {
+			table[i].speed = v;
+		}
+	}
+	// dv/dt = v dv/ds
+	for (int i = 0; i < points; i++) {
+		double next = i + 1 < points ? table[i + 1].speed : 0.0;
+		table[i].acceleration = (next * next - table[i].speed
+				* table[i].speed) / (2 * step);
+	}
+	return true;
+}
+
+void Path::sample(double distance, Point* point) const {
+	if (distance <= 0.0) {
+		*point = table[0];
+		return;
+	}
+	// a rounding error short of a point (say, a leg's end) is on it
+	double x = distance / step;
+	int i = (int) (x + 1e-9);
+	if (i >= points - 1) {
+		*point = table[points - 1];
+		return;
+	}
+	double f = x - i;
+	const Point& a = table[i];
+	const Point& b = table[i + 1];
+	point->x = a.x + f * (b.x - a.x);
+	point->y = a.y + f * (b.y - a.y);
+	point->heading = a.heading + f * (b.heading - a.heading);
+	point->speed = a.speed + f * (b.speed - a.speed);
+	point->acceleration = a.acceleration;
+	point->curvature = a.curvature;
+	point->direction = a.direction;
+}
+
+double Path::getLength() const {
+	return length;
+}
+
+double Path::getLegEnd(int leg) const {
+	if (leg < 0 || leg >= legs) {
+		return length;
+	}
+	return leg_ends[leg];
+}
+
+double Path::getNextReversal(double distance) const {
+	for (int i = 0; i < reversal_count; i++) {
+		if (reversals[i] > distance) {
+			return reversals[i];
+		}
+	}
+	return length;
+}
+
+double Path::getTime(double from, double to) const {
+	if (from < 0.0) {
+		from = 0.0;
+	}
+	if (to > length) {
+		to = length;
+	}
+	double time = 0.0;
+	double last = 0.0;
+	for (double s = from; s < to;) {
+		double next = s + step < to ? s + step : to;
+		// the table's speed, or less to start and stop at the ends
+		Point p;
+		sample(next, &p);
+		double v = p.speed;
+		double start = sqrt(2 * accel * (next - from));
+		double stop = sqrt(2 * accel * (to - next));
+		if (start < v) {
+			v = start;
+		}
+		if (stop < v) {
+			v = stop;
+		}
+		// constant acceleration between points; at least as fast
+		// as from rest to rest
+		double ds = next - s;
+		double average = 0.5 * (last + v);
+		if (average < 0.5 * sqrt(accel * ds)) {
+			average = 0.5 * sqrt(accel * ds);
+		}
+		if (average > 0.0) {
+			time += ds / average;
+		}
+		last = v;
+		s = next;
+	}
+	return time;
+}
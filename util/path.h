@@ -0,0 +1,94 @@
+#ifndef PATH_H_
+#define PATH_H_
+
+/**
+ * A drive path, as a table indexed by distance travelled along it
+ * (arc length, in inches, counting reverse travel as positive), so
+ * that following it costs a table lookup per step.
+ *
+ * Paths are made of legs: straight lines or circular arcs, driven
+ * forward or in reverse, starting at the origin heading 0. The
+ * table holds where the robot should be and how fast it may go
+ * there: full speed, less what it needs to accelerate from the
+ * start, and to stop at each change of direction and at the end.
+ *
+ * Building is cheap enough for the main loop, but is meant to be
+ * done ahead of time (say, while disabled).
+ */
+class Path {
+public:
+	static const int kMaxPoints = 512;
+	static const int kMaxLegs = 8;
+	// inches between points, unless the path needs them farther apart
+	static const double kStep = 1.0;
+
+	typedef struct {
+		// inches; negative to drive it in reverse
+		double length;
+		// degrees of heading change over the leg (positive is the
+		// gyro's positive); 0 for a straight leg
+		double turn;
+	} Leg;
+
+	typedef struct {
+		// inches and degrees, from where the path starts
+		double x;
+		double y;
+		double heading;
+		// degrees of heading per inch travelled
+		double curvature;
+		// inches per second, at least 0; and its rate of change
+		double speed;
+		double acceleration;
+		// +1 forward, -1 reverse
+		double direction;
+	} Point;
+
+	Path();
+
+	/**
+	 * Tabulate the legs; returns false (leaving an empty path)
+	 * if there are too many.
+	 */
+	bool build(const Leg* legs, int count, double max_speed,
+			double max_acceleration);
+
+	/**
+	 * The point `distance` inches along the path; clamped to
+	 * its ends.
+	 */
+	void sample(double distance, Point* point) const;
+
+	double getLength() const;
+	/**
+	 * Distance along the path where leg `leg` ends.
+	 */
+	double getLegEnd(int leg) const;
+	/**
+	 * Distance along the path of the first change of direction
+	 * after `distance`; the path's length if there is none.
+	 */
+	double getNextReversal(double distance) const;
+	/**
+	 * Seconds the plan takes from `from` to `to` inches along the
+	 * path, starting and stopping at rest.
+	 */
+	double getTime(double from, double to) const;
+private:
+	void clear();
+	static void advance(const Leg& leg, double along, const Point& from,
+			Point* to);
+
+	Point table[kMaxPoints];
+	int points;
+	double step;
+	double length;
+	// inches per second per second
+	double accel;
+	double leg_ends[kMaxLegs];
+	int legs;
+	double reversals[kMaxLegs];
+	int reversal_count;
+};
+
+#endif // PATH_H_
@@ -1,54 +1,152 @@
 #include "profiler.h"
 #include "Timer.h"
-#include "udplog.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
 
-Profiler::Profiler(const char* out, bool udp) :
-	stream() {
-	key = out;
+const int ProfileScope::kMaxSections;
+constexpr double ProfileScope::kSummaryPeriod;
+const int ProfileScope::kBins;
+
+ProfileScope::ProfileScope(const char* n, bool udp) {
+	name = n;
 	use_udp = udp;
-	config();
+	last_summary = -1.0;
+	num_sections = 0;
+	for (int i = 0; i < kMaxSections; i++) {
+		sections[i].channel = -1;
+	}
+	reset();
 }
-void Profiler::config() {
-	stream.clear();
-	stream << key << ":";
-	first = true;
-	last_time = GetTime();
+
+void ProfileScope::reset() {
+	for (int i = 0; i < kMaxSections; i++) {
+		Section& s = sections[i];
+		memset(s.bins, 0, sizeof(s.bins));
+		s.count = 0;
+		s.sum = 0.0;
+		s.min = 0.0;
+		s.max = 0.0;
+	}
 }
 
-void Profiler::finish() {
-	// don't send empties
-	if (first) {
-		return;
+int ProfileScope::bin(double seconds) {
+	double us = seconds * 1e6;
+	if (us < 1.0) {
+		return 0;
 	}
-	stream << std::endl;
-	if (use_udp) {
-		UDPLog::log(stream.str().c_str());
-	} else {
-		printf(stream.str().c_str());
+	if (us >= 4294967295.0) {
+		return kBins - 1;
 	}
+	uint32_t v = (uint32_t) us;
+	int octave = 31 - __builtin_clz(v);
+	// the two bits below the leading one pick the quarter
+	int quarter = (octave >= 2) ? (v >> (octave - 2)) & 3 : (v << (2
+			- octave)) & 3;
+	return 4 * octave + quarter;
 }
 
-Profiler::~Profiler() {
-	finish();
+double ProfileScope::binTop(int b) {
+	int octave = b / 4;
+	int quarter = b % 4;
+	return (double) (1ULL << octave) * (5 + quarter) / 4.0 * 1e-6;
 }
 
-void Profiler::next() {
-	finish();
-	config();
+void ProfileScope::record(int section, double seconds) {
+	double now = Timer::GetPPCTimestamp();
+	if (last_summary < 0.0) {
+		last_summary = now;
+	} else if (now - last_summary >= kSummaryPeriod) {
+		summarize(now);
+	}
+
+	if (section < 0) {
+		section = 0;
+	} else if (section >= kMaxSections) {
+		section = kMaxSections - 1;
+	}
+	if (section >= num_sections) {
+		num_sections = section + 1;
+	}
+
+	Section& s = sections[section];
+	if (s.count == 0 || seconds < s.min) {
+		s.min = seconds;
+	}
+	if (s.count == 0 || seconds > s.max) {
+		s.max = seconds;
+	}
+	s.count++;
+	s.sum += seconds;
+	s.bins[bin(seconds)]++;
+}
+
+void ProfileScope::summarize(double now) {
+	for (int i = 0; i < num_sections; i++) {
+		Section& s = sections[i];
+		if (s.count == 0) {
+			continue;
+		}
+
+		// p99: top of the bin holding the 99th percentile sample
+		uint32_t rank = s.count - s.count / 100;
+		uint32_t seen = 0;
+		double p99 = s.max;
+		for (int b = 0; b < kBins; b++) {
+			seen += s.bins[b];
+			if (seen >= rank) {
+				p99 = binTop(b);
+				break;
+			}
+		}
+		if (p99 > s.max) {
+			p99 = s.max;
+		}
+		double mean = s.sum / s.count;
+
+		if (use_udp) {
+			if (s.channel < 0) {
+				char label[48];
+				if (i == 0) {
+					snprintf(label, sizeof(label), "%s", name);
+				} else {
+					snprintf(label, sizeof(label), "%s#%d", name, i);
+				}
+				s.channel = Telemetry::channel(label, "count,min,mean,p99,max");
+			}
+			float values[5];
+			values[0] = s.count;
+			values[1] = s.min;
+			values[2] = mean;
+			values[3] = p99;
+			values[4] = s.max;
+			Telemetry::send(s.channel, values);
+		} else {
+			printf("%s#%d: n %u min %f mean %f p99 %f max %f\n", name, i,
+					s.count, s.min, mean, p99, s.max);
+		}
+	}
+	reset();
+	last_summary = now;
+}
+
+Profiler::Profiler(ProfileScope& s) :
+	scope(s) {
+	section = 0;
+	last_time = Timer::GetPPCTimestamp();
+}
+
+Profiler::~Profiler() {
+	stamp();
 }
 
 void Profiler::stamp(int) {
-	double newtime = GetTime();
+	double newtime = Timer::GetPPCTimestamp();
 	double delta = newtime - last_time;
 	last_time = newtime;
 
-	if (first) {
-		first = false;
-	} else {
-		stream << ",";
-	}
-
-	stream << delta;
+	scope.record(section, delta);
+	section++;
 }
 
 double InitTimer::ltime = 0.0;
@@ -1,26 +1,86 @@
 #ifndef UTIL_PROFILER_H_
 #define UTIL_PROFILER_H_
 
-#include <sstream> 
+#include <stddef.h>
+#include <stdint.h>
 
 /**
- * Create stack based profiler object.
- * Writes a set of time deltas to UDP port 1140
- * with printf format "%s:%f,%f,%f\n".
+ * A named piece of code to profile, declared once at file scope:
+ * 
+ * > ProfileScope INTAKE_PROCESS_SCOPE("Intake::process");
+ * 
+ * Holds a histogram of durations for each section of the scope
+ * (see Profiler::stamp) in fixed arrays, so recording never
+ * allocates. Once a second, the count, min, mean, p99 and max of
+ * each section (in seconds) are sent to the Telemetry channel
+ * "<name>" ("<name>#<section>" past the first) and the histograms
+ * are reset.
+ * 
+ * A scope must only be recorded from one thread.
+ */
+class ProfileScope {
+public:
+	static const int kMaxSections = 8;
+	static constexpr double kSummaryPeriod = 1.0;
+
+	/**
+	 * If `udp` is false, summaries are printf'ed instead.
+	 */
+	ProfileScope(const char* name, bool udp = true);
+
+	/**
+	 * Add a duration (seconds) to a section's histogram.
+	 */
+	void record(int section, double seconds);
+private:
+	// quarter-octave bins of microseconds, 1 us to over an hour
+	static const int kBins = 4 * 32;
+
+	typedef struct {
+		uint32_t bins[kBins];
+		uint32_t count;
+		double sum;
+		double min;
+		double max;
+		int channel;
+	} Section;
+
+	static int bin(double seconds);
+	static double binTop(int bin);
+	void summarize(double now);
+	void reset();
+
+	const char* name;
+	bool use_udp;
+	double last_summary;
+	int num_sections;
+	Section sections[kMaxSections];
+};
+
+/**
+ * Create stack based profiler object, which times
+ * itself into a ProfileScope:
+ * 
+ * > void Intake::process() {
+ * > 	Profiler p(INTAKE_PROCESS_SCOPE);
+ * > 	...
+ * > }
+ * 
+ * Only reads the clock and bins a value; nothing is allocated
+ * or sent until the scope's next once-a-second summary.
  */
 class Profiler {
 public:
+	Profiler(ProfileScope& scope);
 	/**
-	 * Create a Profiler with specified key.
-	 * On destruction, the Profiler will
-	 * send the data.
+	 * Records the time since the last stamp (or
+	 * construction) as the final section.
 	 */
-	Profiler(const char* key, bool udp = true);
 	~Profiler();
 
 	/**
-	 * Mark the current time and append the last time
-	 * delta to the output string.
+	 * Mark the current time and record the last time
+	 * delta as the next section.
 	 * 
 	 * Optional argument is in case you want to:
 	 * >
@@ -31,20 +91,10 @@ public:
 	 * >  stamp(3);
 	 */
 	void stamp(int whatever = 0);
-
-	/**
-	 * Send built up time deltas to UDP port 1140,
-	 * and prepare to send another set of time deltas.
-	 */
-	void next();
 private:
-	void config();
-	void finish();
-	std::stringstream stream;
+	ProfileScope& scope;
 	double last_time;
-	bool first;
-	bool use_udp;
-	const char* key;
+	int section;
 };
 
 /**
@@ -1,5 +1,7 @@
 #include "rollinggyro.h"
+#include "inputlog.h"
 #include "AnalogModule.h"
+#include "Timer.h"
 
 #define LOUD_GYRO 0
 
@@ -9,12 +11,27 @@
 
 const double PERIOD = 0.5;
 const int BUFFER_SIZE = 12;
+// the accumulator fills every 20 ms
+const double SAMPLE_PERIOD = 0.005;
+// reads torn by the sampler before giving up on the history
+const int READ_ATTEMPTS = 4;
 
 RollingGyro::RollingGyro(uint8_t chan, double sens) :
-	notifier(RollingGyro::callCalibrate, this), channel(chan),
-			buffer(BUFFER_SIZE) {
+	notifier(RollingGyro::callCalibrate, this),
+			sampler(RollingGyro::callPoll, this), channel(chan) {
 
 	sensitivity = sens;
+	offset = 0.0;
+	zero = 0.0;
+	written = 0;
+	first = 0;
+	restart = false;
+	anchored = false;
+	calibrating = false;
+	for (int i = 0; i < kHistory; i++) {
+		history[i].seq = 0;
+		history[i].index = ~0u;
+	}
 
 	if (!channel.IsAccumulatorChannel()) {
 		printf("ERROR: Gyro not on accumulator channel");
@@ -24,18 +41,29 @@ RollingGyro::RollingGyro(uint8_t chan, double sens) :
 	channel.SetAverageBits(0);
 	channel.SetOversampleBits(10);
 	channel.InitAccumulator();
-
-	offset = 0.0;
+	InputLog::addAccumulator(&channel);
+	updateScale();
 
 	semaphore = semMCreate(SEM_Q_PRIORITY);
-	calibrating = false;
+	sampler.StartPeriodic(SAMPLE_PERIOD);
 }
 
 RollingGyro::~RollingGyro() {
+	sampler.Stop();
 	notifier.Stop();
 	semFlush(semaphore);
 }
 
+void RollingGyro::updateScale() {
+	// Copied from WPILib implementation
+	scale = 1e-9 * (double) channel.GetLSBWeight()
+			* (double) (1 << channel.GetAverageBits())
+			/ (channel.GetModule()->GetSampleRate() * sensitivity);
+	value_period = (double) (1 << (channel.GetAverageBits()
+			+ channel.GetOversampleBits()))
+			/ channel.GetModule()->GetSampleRate();
+}
+
 void RollingGyro::BeginMeasurement() {
 #if LOUD_GYRO
 	printf("[Gyro] Begin\n");
@@ -47,6 +75,7 @@ void RollingGyro::BeginMeasurement() {
 		return;
 	}
 	calibrating = true;
+	__sync_synchronize();
 
 	channel.SetAccumulatorCenter(0);
 	channel.ResetAccumulator();
@@ -65,7 +94,6 @@ void RollingGyro::FinishMeasurement() {
 		printf("[Gyro] Calibration has not yet been started.");
 		return;
 	}
-	calibrating = false;
 
 	notifier.Stop();
 
@@ -76,7 +104,7 @@ void RollingGyro::FinishMeasurement() {
 
 	Reading total = { 0, 0 };
 	for (int i = 0; i < buffer.size(); i++) {
-		Reading n = buffer[i];
+		const Reading& n = buffer[i];
 		total.count += n.count;
 		total.value += n.value;
 	}
@@ -89,38 +117,164 @@ void RollingGyro::FinishMeasurement() {
 	channel.SetAccumulatorDeadband(0);
 	channel.ResetAccumulator();
 
+	// the history so far was of the old center
+	zero = 0.0;
+	restart = true;
+	// readers see the gyro calibrating until the new center is in
+	__sync_synchronize();
+	calibrating = false;
 }
-double RollingGyro::GetAngle() {
-	double angle;
-	{
-		Synchronized sync(semaphore);
-		angle = 0;
 
-		// Copied from WPILib implementation
+double RollingGyro::readDirect() {
+	INT64 rawValue;
+	uint32_t count;
+	channel.GetAccumulatorOutput(&rawValue, &count);
+	INT64 value = rawValue - (INT64) ((float) count * offset);
+	return value * scale;
+}
 
-		INT64 rawValue;
-		uint32_t count;
-		channel.GetAccumulatorOutput(&rawValue, &count);
+bool RollingGyro::readSlot(unsigned int index, Sample* sample) {
+	const Slot& slot = history[index & (kHistory - 1)];
+	unsigned int seq = slot.seq;
+	__sync_synchronize();
+	*sample = slot.sample;
+	unsigned int found = slot.index;
+	__sync_synchronize();
+	return (seq & 1) == 0 && slot.seq == seq && found == index;
+}
 
-		INT64 value = rawValue - (INT64) ((float) count * offset);
+bool RollingGyro::newest(Sample* sample) {
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		unsigned int end = written;
+		if (restart || end == first) {
+			return false;
+		}
+		if (readSlot(end - 1, sample)) {
+			return true;
+		}
+	}
+	return false;
+}
 
-		double scaledValue = value * 1e-9 * (double) channel.GetLSBWeight()
-				* (double) (1 << channel.GetAverageBits())
-				/ (channel.GetModule()->GetSampleRate() * sensitivity);
+double RollingGyro::GetAngle() {
+	Sample s;
+	if (!newest(&s)) {
+		return readDirect() - zero;
+	}
+	return s.heading - zero;
+}
 
-		return (float) scaledValue;
+double RollingGyro::GetAngleAt(double time) {
+	for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+		unsigned int end = written;
+		__sync_synchronize();
+		unsigned int begin = first;
+		if (restart || end == begin) {
+			break;
+		}
+		// the oldest slot may be overwritten as we read it
+		if (end - begin > (unsigned int) kHistory - 1) {
+			begin = end - (kHistory - 1);
+		}
+		unsigned int i = end - 1;
+		Sample newer, older;
+		if (!readSlot(i, &newer)) {
+			continue;
+		}
+		bool torn = false;
+		while (!torn && newer.time > time && i != begin) {
+			i--;
+			if (!readSlot(i, &older)) {
+				torn = true;
+			} else if (older.time <= time) {
+				double f = (time - older.time) / (newer.time - older.time);
+				return older.heading + f * (newer.heading - older.heading)
+						- zero;
+			} else {
+				newer = older;
+			}
+		}
+		if (!torn) {
+			return newer.heading - zero;
+		}
 	}
-	return angle;
+	return GetAngle();
+}
+
+double RollingGyro::GetRate() {
+	Sample s;
+	return newest(&s) ? s.rate : 0.0;
 }
+
 void RollingGyro::Reset() {
-	Synchronized sync(semaphore);
-	channel.ResetAccumulator();
+	Sample s;
+	zero = newest(&s) ? s.heading : readDirect();
 }
 
 void RollingGyro::SetSensitivity(double val) {
 	Synchronized sync(semaphore);
 
 	sensitivity = val;
+	updateScale();
+}
+
+/**
+ * Publish the accumulator's newest value, if it has a new one;
+ * on the sampler notifier.
+ */
+void RollingGyro::Poll() {
+	if (calibrating) {
+		return;
+	}
+	INT64 rawValue;
+	uint32_t count;
+	channel.GetAccumulatorOutput(&rawValue, &count);
+	double now = GetTime();
+	// calibration may have reset the accumulator meanwhile
+	__sync_synchronize();
+	if (calibrating) {
+		return;
+	}
+	if (restart) {
+		restart = false;
+		anchored = false;
+		first = written;
+	}
+	if (anchored && count == last_count) {
+		return;
+	}
+	last_count = count;
+
+	// each value was accumulated no later than it is seen; the
+	// earliest such reset time is the closest to the truth
+	double start = now - count * value_period;
+	if (!anchored || start < anchor) {
+		anchor = start;
+	}
+	Sample s;
+	s.time = anchor + count * value_period;
+	s.heading = (rawValue - (INT64) ((float) count * offset)) * scale;
+	s.rate = 0.0;
+	if (anchored && written != first && s.time > last.time) {
+		s.rate = (s.heading - last.heading) / (s.time - last.time);
+	}
+	anchored = true;
+	last = s;
+
+	unsigned int n = written;
+	Slot& slot = history[n & (kHistory - 1)];
+	slot.seq++;
+	__sync_synchronize();
+	slot.sample = s;
+	slot.index = n;
+	__sync_synchronize();
+	slot.seq++;
+	__sync_synchronize();
+	written = n + 1;
+}
+
+void RollingGyro::callPoll(void* x) {
+	((RollingGyro*) x)->Poll();
 }
 
 void RollingGyro::Calibrate() {
@@ -132,6 +286,10 @@ void RollingGyro::Calibrate() {
 #endif
 	Reading r;
 	channel.GetAccumulatorOutput(&r.value, &r.count);
+	// keep the last BUFFER_SIZE
+	if (buffer.size() == BUFFER_SIZE) {
+		buffer.drop();
+	}
 	buffer.next(r);
 	channel.ResetAccumulator();
 }
@@ -6,37 +6,96 @@
 #include "controllers.h"
 
 /**
- * Alternate 
+ * Alternate gyro, calibrated while the robot sits disabled
+ * (BeginMeasurement() ... FinishMeasurement()).
+ *
+ * Once calibrated, a notifier polls the accumulator well faster
+ * than it fills, and keeps its last kHistory values as heading
+ * and turn rate, each stamped with the time the value was
+ * accumulated. Reads never lock: GetAngle() is the newest value,
+ * and GetAngleAt() interpolates, so a controller can use the
+ * heading from when its other sensors were read.
  */
 class RollingGyro {
 public:
+	// a power of two; about 2.6 s of accumulator values
+	static const int kHistory = 128;
+
+	typedef struct {
+		// GetTime() seconds
+		double time;
+		// degrees
+		double heading;
+		// degrees per second
+		double rate;
+	} Sample;
+
 	RollingGyro(uint8_t channel, double sensitivity = 0.007);
 	virtual ~RollingGyro();
 
 	void BeginMeasurement();
 	void FinishMeasurement();
-	
+
 	bool IsDisconnected(); // only call this at assumed rest.
 
 	double GetRawLevel();
-	
+
 	double GetAngle(); // value not to be trusted while calibrating
+	/**
+	 * The heading at `time` (GetTime() seconds), between the two
+	 * values around it; clamped to the oldest and newest kept.
+	 */
+	double GetAngleAt(double time);
+	double GetRate();
 	void Reset();
+	// applies to values accumulated from now on
 	void SetSensitivity(double sensitivity);
 private:
 	void Calibrate();
 	static void callCalibrate(void*);
+	void Poll();
+	static void callPoll(void*);
+	void updateScale();
+	double readDirect();
+	bool readSlot(unsigned int index, Sample* sample);
+	bool newest(Sample* sample);
 	typedef struct {
 		INT64 value;
 		uint32_t count;
 	} Reading;
+	// a sample, behind a sequence count that is odd while it is written
+	typedef struct {
+		volatile unsigned int seq;
+		unsigned int index;
+		Sample sample;
+	} Slot;
 	SEM_ID semaphore;
 	Notifier notifier;
+	Notifier sampler;
 	AnalogChannel channel;
 	double sensitivity;
-	RingBuffer<Reading> buffer;
+	RingBuffer<Reading, 16> buffer;
 	double offset;
-	bool calibrating;
+	volatile bool calibrating;
+
+	// degrees per accumulator unit, and seconds per accumulated value
+	double scale;
+	double value_period;
+	// the heading Reset() made zero
+	double zero;
+	// set by FinishMeasurement(): drop the history
+	volatile bool restart;
+
+	// written by the sampler only
+	Slot history[kHistory];
+	volatile unsigned int written;
+	// the first sample since calibration
+	volatile unsigned int first;
+	uint32_t last_count;
+	Sample last;
+	// GetTime() when the accumulator was last reset
+	double anchor;
+	bool anchored;
 };
 
 #endif // ROLLING_GYRO_H_
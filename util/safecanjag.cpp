@@ -5,34 +5,50 @@
 /*----------------------------------------------------------------------------*/
 
 #include "../util/safecanjag.h"
-#define tNIRIO_i32 int
-#include "ChipObject/NiFpga.h"
-#include "CAN/JaguarCANDriver.h"
+#include "candriver.h"
 #include "CAN/can_proto.h"
 #include "NetworkCommunication/UsageReporting.h"
 #include "WPIErrors.h"
 #include <stdio.h>
 #include "LiveWindow/LiveWindow.h"
-
+#include "Timer.h"
+#include "Synchronized.h"
+
+// the CAN wire format is little-endian; the cRIO is not
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define swap16(x) (x)
+#define swap32(x) (x)
+#else
 #define swap16(x) ( (((x)>>8) &0x00FF) \
                   | (((x)<<8) &0xFF00) )
 #define swap32(x) ( (((x)>>24)&0x000000FF) \
                   | (((x)>>8) &0x0000FF00) \
                   | (((x)<<8) &0x00FF0000) \
                   | (((x)<<24)&0xFF000000) )
-
-#define kFullMessageIDMask (CAN_MSGID_API_M | CAN_MSGID_MFR_M | CAN_MSGID_DTYPE_M)
+#endif
 
 const int32_t SafeCANJag::kControllerRate;
 constexpr double SafeCANJag::kApproxBusVoltage;
+constexpr double SafeCANJag::kDefaultKeepalive;
 
 /**
  * Common initialization code called by all constructors.
  */
-void SafeCANJag::InitCANJaguar() {
+void SafeCANJag::InitCANJaguar(bool deferInit) {
 	m_table = NULL;
 	m_transactionSemaphore = semMCreate(
 			SEM_Q_PRIORITY | SEM_INVERSION_SAFE | SEM_DELETE_SAFE);
+	m_statusSemaphore = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+	for (int i = 0; i < kNumStatusFields; i++) {
+		m_status[i] = 0.0;
+		m_statusTime[i] = -1.0;
+	}
+	m_statusPolled = 0;
+	m_statusMaxAge = 0.0;
+	m_lastSetTime = -1.0;
+	m_keepalive = kDefaultKeepalive;
+	m_setsSent = 0;
+	m_setsSuppressed = 0;
 	if (m_deviceNumber < 1 || m_deviceNumber > 63) {
 		char buf[256];
 		snprintf(buf, 256, "device number \"%d\" must be between 1 and 63",
@@ -40,9 +56,30 @@ void SafeCANJag::InitCANJaguar() {
 		wpi_setWPIErrorWithContext(ParameterOutOfRange, buf);
 		return;
 	}
+	if (deferInit) {
+		return;
+	}
 	uint32_t fwVer = GetFirmwareVersion();
 	if (StatusIsFatal())
 		return;
+	if (!checkFirmware(fwVer))
+		return;
+	switch (m_controlMode) {
+	case kPercentVbus:
+	case kVoltage:
+		// No additional configuration required... start enabled.
+		EnableControl();
+		break;
+	default:
+		break;
+	}
+	finishInit();
+}
+
+/**
+ * @return True if the firmware version is one FIRST allows.
+ */
+bool SafeCANJag::checkFirmware(uint32_t fwVer) {
 	// 3330 was the first shipping RDK firmware version for the Jaguar
 	if (fwVer >= 3330 || fwVer < 101) {
 		char buf[256];
@@ -60,17 +97,12 @@ void SafeCANJag::InitCANJaguar() {
 					m_deviceNumber, fwVer);
 		}
 		wpi_setWPIErrorWithContext(JaguarVersionError, buf);
-		return;
-	}
-	switch (m_controlMode) {
-	case kPercentVbus:
-	case kVoltage:
-		// No additional configuration required... start enabled.
-		EnableControl();
-		break;
-	default:
-		break;
+		return false;
 	}
+	return true;
+}
+
+void SafeCANJag::finishInit() {
 	m_safetyHelper = new MotorSafetyHelper(this);
 
 	nUsageReporting::report(nUsageReporting::kResourceType_CANJaguar,
@@ -82,12 +114,14 @@ void SafeCANJag::InitCANJaguar() {
  * Constructor
  * 
  * @param deviceNumber The the address of the Jaguar on the CAN bus.
+ * @param deferInit If true, send nothing until InitAsync().
  */
-SafeCANJag::SafeCANJag(uint8_t deviceNumber, ControlMode controlMode) :
+SafeCANJag::SafeCANJag(uint8_t deviceNumber, ControlMode controlMode,
+		bool deferInit) :
 	m_deviceNumber(deviceNumber), m_controlMode(controlMode),
 			m_transactionSemaphore(NULL),
 			m_maxOutputVoltage(kApproxBusVoltage), m_safetyHelper(NULL) {
-	InitCANJaguar();
+	InitCANJaguar(deferInit);
 }
 
 SafeCANJag::~SafeCANJag() {
@@ -95,6 +129,56 @@ SafeCANJag::~SafeCANJag() {
 	m_safetyHelper = NULL;
 	semDelete(m_transactionSemaphore);
 	m_transactionSemaphore = NULL;
+	semDelete(m_statusSemaphore);
+	m_statusSemaphore = NULL;
+}
+
+/**
+ * Queue the read of the firmware version that starts a deferred
+ * bring-up.
+ * 
+ * @return The pending read, for FinishInitAsync(); NULL if it could not be queued
+ */
+CANTransaction* SafeCANJag::InitAsync(CANPipeline& pipe) {
+	// Set the MSB to tell the 2CAN that this is a remote message.
+	return getTransactionAsync(pipe, 0x80000000 | CAN_MSGID_API_FIRMVER);
+}
+
+/**
+ * Check the firmware version read by InitAsync(), and queue
+ * the enable that the constructor would have sent.
+ * 
+ * @param version The flushed read from InitAsync()
+ * @param pipe The pipeline to queue the enable on
+ */
+void SafeCANJag::FinishInitAsync(CANTransaction* version, CANPipeline& pipe) {
+	if (version == NULL)
+		return;
+	if (!version->succeeded()) {
+		wpi_setErrorWithContext(version->getStatus(), "receiveMessage");
+		commStatusComment(version->getStatus());
+		return;
+	}
+	uint32_t fwVer = 0;
+	if (version->getDataSize() == sizeof(uint32_t)) {
+		fwVer = unpackint32_t(version->getData());
+	}
+	if (!checkFirmware(fwVer))
+		return;
+	uint8_t dataBuffer[8];
+	switch (m_controlMode) {
+	case kPercentVbus:
+		ResetCoalescing();
+		setTransactionAsync(pipe, LM_API_VOLT_T_EN, dataBuffer, 0);
+		break;
+	case kVoltage:
+		ResetCoalescing();
+		setTransactionAsync(pipe, LM_API_VCOMP_T_EN, dataBuffer, 0);
+		break;
+	default:
+		break;
+	}
+	finishInit();
 }
 
 /**
@@ -119,46 +203,191 @@ void SafeCANJag::Set(float outputValue, uint8_t syncGroup) {
 		EnableControl();
 	}
 
+	if (coalesceSet(outputValue, syncGroup)) {
+		if (m_safetyHelper)
+			m_safetyHelper->Feed();
+		return;
+	}
+
+	if (!packSetpoint(outputValue, syncGroup, &messageID, dataBuffer,
+			&dataSize))
+		return;
+	int32_t status = setTransaction(messageID, dataBuffer, dataSize);
+	m_setsSent++;
+	if (status == 0) {
+		ackSet(outputValue, syncGroup);
+	}
+	if (m_safetyHelper)
+		m_safetyHelper->Feed();
+}
+
+/**
+ * Queue a set-point write, without waiting for the Jaguar to ack it.
+ * 
+ * Units are as for Set(). The write is complete when pipe.flush() returns.
+ * 
+ * @param pipe The pipeline to queue the write on.
+ * @param outputValue The set-point to sent to the motor controller.
+ * @param syncGroup The update group to add this Set() to, pending UpdateSyncGroup().  If 0, update immediately.
+ * @return The pending transaction, or NULL if the write was coalesced or could not be queued
+ */
+CANTransaction* SafeCANJag::SetAsync(CANPipeline& pipe, float outputValue,
+		uint8_t syncGroup) {
+	uint32_t messageID;
+	uint8_t dataBuffer[8];
+	uint8_t dataSize;
+
+	if (m_safetyHelper && !m_safetyHelper->IsAlive()) {
+		EnableControl();
+	}
+
+	if (coalesceSet(outputValue, syncGroup)) {
+		if (m_safetyHelper)
+			m_safetyHelper->Feed();
+		return NULL;
+	}
+
+	if (!packSetpoint(outputValue, syncGroup, &messageID, dataBuffer,
+			&dataSize))
+		return NULL;
+	m_pendingSet = outputValue;
+	m_pendingSync = syncGroup;
+	CANTransaction* t = setTransactionAsync(pipe, messageID, dataBuffer,
+			dataSize, setAcked, this);
+	if (t != NULL) {
+		m_setsSent++;
+	}
+	if (m_safetyHelper)
+		m_safetyHelper->Feed();
+	return t;
+}
+
+/**
+ * Decide whether a set-point write can be dropped: it must match the
+ * last one the Jaguar acknowledged, and that must be more recent than
+ * the keepalive interval.
+ * 
+ * @return True if the write was counted as suppressed.
+ */
+bool SafeCANJag::coalesceSet(float outputValue, uint8_t syncGroup) {
+	double keepalive = m_keepalive;
+	// while the safety helper is armed, the Jaguar must hear from
+	// us well within its expiration
+	if (m_safetyHelper && m_safetyHelper->IsSafetyEnabled()) {
+		double limit = 0.5 * m_safetyHelper->GetExpiration();
+		if (limit < keepalive)
+			keepalive = limit;
+	}
+	if (m_lastSetTime < 0.0 || outputValue != m_lastSet || syncGroup
+			!= m_lastSetSync) {
+		return false;
+	}
+	if (CANDriver::get()->now() - m_lastSetTime >= keepalive) {
+		return false;
+	}
+	m_setsSuppressed++;
+	return true;
+}
+
+/**
+ * Record a set-point the Jaguar acknowledged.
+ */
+void SafeCANJag::ackSet(float outputValue, uint8_t syncGroup) {
+	m_lastSet = outputValue;
+	m_lastSetSync = syncGroup;
+	m_lastSetTime = CANDriver::get()->now();
+}
+
+void SafeCANJag::setAcked(CANTransaction* t, void* arg) {
+	SafeCANJag* jag = (SafeCANJag*) arg;
+	if (t->succeeded()) {
+		jag->ackSet(jag->m_pendingSet, jag->m_pendingSync);
+	} else {
+		jag->m_lastSetTime = -1.0;
+	}
+}
+
+/**
+ * Forget the last acknowledged set-point, so the next Set() goes to
+ * the bus whatever its value. Needed whenever the Jaguar may have
+ * lost its set-point (mode changes, power cycles).
+ */
+void SafeCANJag::ResetCoalescing() {
+	m_lastSetTime = -1.0;
+}
+
+/**
+ * Set how long an unchanged set-point may go without being re-sent.
+ * 0 turns write coalescing off. If motor safety is enabled, the
+ * interval is also capped at half the safety expiration.
+ */
+void SafeCANJag::SetKeepalive(double seconds) {
+	m_keepalive = seconds;
+}
+
+double SafeCANJag::GetKeepalive() {
+	return m_keepalive;
+}
+
+/**
+ * Number of set-point frames put on the bus.
+ */
+uint32_t SafeCANJag::GetSetsSent() {
+	return m_setsSent;
+}
+
+/**
+ * Number of Set() calls dropped because the Jaguar already had the value.
+ */
+uint32_t SafeCANJag::GetSetsSuppressed() {
+	return m_setsSuppressed;
+}
+
+/**
+ * Encode a set-point message for the current control mode.
+ * 
+ * @return False if the control mode has no set-point.
+ */
+bool SafeCANJag::packSetpoint(float outputValue, uint8_t syncGroup,
+		uint32_t *messageID, uint8_t *dataBuffer, uint8_t *dataSize) {
 	switch (m_controlMode) {
 	case kPercentVbus: {
-		messageID = LM_API_VOLT_T_SET;
+		*messageID = LM_API_VOLT_T_SET;
 		if (outputValue > 1.0)
 			outputValue = 1.0;
 		if (outputValue < -1.0)
 			outputValue = -1.0;
-		dataSize = packPercentage(dataBuffer, outputValue);
+		*dataSize = packPercentage(dataBuffer, outputValue);
 	}
 		break;
 	case kSpeed: {
-		messageID = LM_API_SPD_T_SET;
-		dataSize = packFXP16_16(dataBuffer, outputValue);
+		*messageID = LM_API_SPD_T_SET;
+		*dataSize = packFXP16_16(dataBuffer, outputValue);
 	}
 		break;
 	case kPosition: {
-		messageID = LM_API_POS_T_SET;
-		dataSize = packFXP16_16(dataBuffer, outputValue);
+		*messageID = LM_API_POS_T_SET;
+		*dataSize = packFXP16_16(dataBuffer, outputValue);
 	}
 		break;
 	case kCurrent: {
-		messageID = LM_API_ICTRL_T_SET;
-		dataSize = packFXP8_8(dataBuffer, outputValue);
+		*messageID = LM_API_ICTRL_T_SET;
+		*dataSize = packFXP8_8(dataBuffer, outputValue);
 	}
 		break;
 	case kVoltage: {
-		messageID = LM_API_VCOMP_T_SET;
-		dataSize = packFXP8_8(dataBuffer, outputValue);
+		*messageID = LM_API_VCOMP_T_SET;
+		*dataSize = packFXP8_8(dataBuffer, outputValue);
 	}
 		break;
 	default:
-		return;
+		return false;
 	}
 	if (syncGroup != 0) {
-		dataBuffer[dataSize] = syncGroup;
-		dataSize++;
+		dataBuffer[*dataSize] = syncGroup;
+		(*dataSize)++;
 	}
-	setTransaction(messageID, dataBuffer, dataSize);
-	if (m_safetyHelper)
-		m_safetyHelper->Feed();
+	return true;
 }
 
 /**
@@ -293,7 +522,8 @@ int32_t SafeCANJag::unpackint32_t(uint8_t *buffer) {
 }
 
 /**
- * Send a message on the CAN bus through the CAN driver in FRC_NetworkCommunication
+ * Send a message on the CAN bus through the installed CANDriver
+ * (by default, the CAN driver in FRC_NetworkCommunication)
  * 
  * Trusted messages require a 2-byte token at the beginning of the data payload.
  * If the message being sent is trusted, make space for the token.
@@ -305,39 +535,27 @@ int32_t SafeCANJag::unpackint32_t(uint8_t *buffer) {
  */
 int32_t SafeCANJag::sendMessage(uint32_t messageID, const uint8_t *data,
 		uint8_t dataSize) {
-	static const uint32_t kTrustedMessages[] = { LM_API_VOLT_T_EN,
-			LM_API_VOLT_T_SET, LM_API_SPD_T_EN, LM_API_SPD_T_SET,
-			LM_API_VCOMP_T_EN, LM_API_VCOMP_T_SET, LM_API_POS_T_EN,
-			LM_API_POS_T_SET, LM_API_ICTRL_T_EN, LM_API_ICTRL_T_SET };
-	int32_t status = 0;
-
-	for (uint8_t i = 0; i < (sizeof(kTrustedMessages)
-			/ sizeof(kTrustedMessages[0])); i++) {
-		if ((kFullMessageIDMask & messageID) == kTrustedMessages[i]) {
-			uint8_t dataBuffer[8];
-			dataBuffer[0] = 0;
-			dataBuffer[1] = 0;
-			// Make sure the data will still fit after adjusting for the token.
-			if (dataSize > 6) {
-				// TODO: I would rather this not have to set the global error
-				wpi_setGlobalWPIErrorWithContext(ParameterOutOfRange, "dataSize > 6");
-				return 0;
-			}
-			for (uint8_t j = 0; j < dataSize; j++) {
-				dataBuffer[j + 2] = data[j];
-			}
-			FRC_NetworkCommunication_JaguarCANDriver_sendMessage(messageID,
-					dataBuffer, dataSize + 2, &status);
-			return status;
+	if (CANDriver::isTrusted(messageID)) {
+		uint8_t dataBuffer[8];
+		dataBuffer[0] = 0;
+		dataBuffer[1] = 0;
+		// Make sure the data will still fit after adjusting for the token.
+		if (dataSize > 6) {
+			// TODO: I would rather this not have to set the global error
+			wpi_setGlobalWPIErrorWithContext(ParameterOutOfRange, "dataSize > 6");
+			return 0;
 		}
+		for (uint8_t j = 0; j < dataSize; j++) {
+			dataBuffer[j + 2] = data[j];
+		}
+		return CANDriver::get()->sendMessage(messageID, dataBuffer,
+				dataSize + 2);
 	}
-	FRC_NetworkCommunication_JaguarCANDriver_sendMessage(messageID, data,
-			dataSize, &status);
-	return status;
+	return CANDriver::get()->sendMessage(messageID, data, dataSize);
 }
 
 /**
- * Receive a message from the CAN bus through the CAN driver in FRC_NetworkCommunication
+ * Receive a message from the CAN bus through the installed CANDriver
  * 
  * @param messageID The messageID to read from the CAN bus
  * @param data The up to 8 bytes of data that was received with the message
@@ -347,10 +565,8 @@ int32_t SafeCANJag::sendMessage(uint32_t messageID, const uint8_t *data,
  */
 int32_t SafeCANJag::receiveMessage(uint32_t *messageID, uint8_t *data,
 		uint8_t *dataSize, float timeout) {
-	int32_t status = 0;
-	FRC_NetworkCommunication_JaguarCANDriver_receiveMessage(messageID, data,
-			dataSize, (uint32_t) (timeout * 1000), &status);
-	return status;
+	return CANDriver::get()->receiveMessage(messageID, data, dataSize,
+			(uint32_t) (timeout * 1000));
 }
 
 /**
@@ -363,15 +579,15 @@ int32_t SafeCANJag::receiveMessage(uint32_t *messageID, uint8_t *data,
  * @param data The up to 8 bytes of data to be sent with the message
  * @param dataSize Specify how much of the data in "data" to send
  */
-void SafeCANJag::setTransaction(uint32_t messageID, const uint8_t *data,
+int32_t SafeCANJag::setTransaction(uint32_t messageID, const uint8_t *data,
 		uint8_t dataSize) {
 	uint32_t ackMessageID = LM_API_ACK | m_deviceNumber;
 	int32_t localStatus = 0;
 
 	// If there was an error on this object and it wasn't a timeout, refuse to talk to the device
 	// Call ClearError() on the object to try again
-	if (StatusIsFatal() && GetError().GetCode() != -44087)
-		return;
+	if (StatusIsFatal() && GetError().GetCode() != CANDriver::kTimeout)
+		return GetError().GetCode();
 
 	// Make sure we don't have more than one transaction with the same Jaguar outstanding.
 	semTake(m_transactionSemaphore, WAIT_FOREVER);
@@ -389,6 +605,7 @@ void SafeCANJag::setTransaction(uint32_t messageID, const uint8_t *data,
 
 	// Transaction complete.
 	semGive(m_transactionSemaphore);
+	return localStatus;
 }
 
 /**
@@ -407,7 +624,7 @@ void SafeCANJag::getTransaction(uint32_t messageID, uint8_t *data,
 
 	// If there was an error on this object and it wasn't a timeout, refuse to talk to the device
 	// Call ClearError() on the object to try again
-	if (StatusIsFatal() && GetError().GetCode() != -44087) {
+	if (StatusIsFatal() && GetError().GetCode() != CANDriver::kTimeout) {
 		if (dataSize != NULL)
 			*dataSize = 0;
 		return;
@@ -433,6 +650,39 @@ void SafeCANJag::getTransaction(uint32_t messageID, uint8_t *data,
 	semGive(m_transactionSemaphore);
 }
 
+/**
+ * Queue a transaction that sets some property, without waiting for the ack.
+ * 
+ * @param pipe The pipeline to queue on; the ack is collected by pipe.flush()
+ * @param messageID The messageID to be used on the CAN bus (device number is added internally)
+ * @param data The up to 8 bytes of data to be sent with the message
+ * @param dataSize Specify how much of the data in "data" to send
+ * @return The pending transaction, or NULL if it could not be queued
+ */
+CANTransaction* SafeCANJag::setTransactionAsync(CANPipeline& pipe,
+		uint32_t messageID, const uint8_t *data, uint8_t dataSize,
+		CANCallback callback, void* arg) {
+	if (StatusIsFatal() && GetError().GetCode() != CANDriver::kTimeout)
+		return NULL;
+	return pipe.queueSet(m_deviceNumber, messageID, data, dataSize,
+			m_transactionSemaphore, callback, arg);
+}
+
+/**
+ * Queue a transaction that gets some property, without waiting for the reply.
+ * 
+ * @param pipe The pipeline to queue on; the reply is collected by pipe.flush()
+ * @param messageID The messageID to read from the CAN bus (device number is added internally)
+ * @return The pending transaction, or NULL if it could not be queued
+ */
+CANTransaction* SafeCANJag::getTransactionAsync(CANPipeline& pipe,
+		uint32_t messageID, CANCallback callback, void* arg) {
+	if (StatusIsFatal() && GetError().GetCode() != CANDriver::kTimeout)
+		return NULL;
+	return pipe.queueGet(m_deviceNumber, messageID, m_transactionSemaphore,
+			callback, arg);
+}
+
 /**
  * Set the reference source device for speed controller mode.
  * 
@@ -659,6 +909,9 @@ void SafeCANJag::EnableControl(double encoderInitialPosition) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize = 0;
 
+	// enabling a mode zeroes the set-point
+	ResetCoalescing();
+
 	switch (m_controlMode) {
 	case kPercentVbus:
 		setTransaction(LM_API_VOLT_T_EN, dataBuffer, dataSize);
@@ -688,6 +941,8 @@ void SafeCANJag::DisableControl() {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize = 0;
 
+	ResetCoalescing();
+
 	switch (m_controlMode) {
 	case kPercentVbus:
 		setTransaction(LM_API_VOLT_DIS, dataBuffer, dataSize);
@@ -749,13 +1004,20 @@ SafeCANJag::ControlMode SafeCANJag::GetControlMode() {
  * 
  * @return The bus voltage in Volts.
  */
-float SafeCANJag::GetBusVoltage() {
+float SafeCANJag::GetBusVoltage(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusBusVoltage, &cached)) {
+		return cached;
+	}
 
 	getTransaction(LM_API_STATUS_VOLTBUS, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int16_t)) {
-		return unpackFXP8_8(dataBuffer);
+		double value = unpackFXP8_8(dataBuffer);
+		storeStatus(kStatusBusVoltage, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -765,14 +1027,21 @@ float SafeCANJag::GetBusVoltage() {
  * 
  * @return The output voltage in Volts.
  */
-float SafeCANJag::GetOutputVoltage() {
+float SafeCANJag::GetOutputVoltage(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusOutputVoltage, &cached)) {
+		return cached;
+	}
 
 	// Read the volt out which is in Volts units.
 	getTransaction(LM_API_STATUS_VOUT, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int16_t)) {
-		return unpackFXP8_8(dataBuffer);
+		double value = unpackFXP8_8(dataBuffer);
+		storeStatus(kStatusOutputVoltage, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -782,13 +1051,20 @@ float SafeCANJag::GetOutputVoltage() {
  * 
  * @return The output current in Amps.
  */
-float SafeCANJag::GetOutputCurrent() {
+float SafeCANJag::GetOutputCurrent(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusCurrent, &cached)) {
+		return cached;
+	}
 
 	getTransaction(LM_API_STATUS_CURRENT, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int16_t)) {
-		return unpackFXP8_8(dataBuffer);
+		double value = unpackFXP8_8(dataBuffer);
+		storeStatus(kStatusCurrent, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -798,13 +1074,20 @@ float SafeCANJag::GetOutputCurrent() {
  * 
  * @return The temperature of the Jaguar in degrees Celsius.
  */
-float SafeCANJag::GetTemperature() {
+float SafeCANJag::GetTemperature(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusTemperature, &cached)) {
+		return cached;
+	}
 
 	getTransaction(LM_API_STATUS_TEMP, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int16_t)) {
-		return unpackFXP8_8(dataBuffer);
+		double value = unpackFXP8_8(dataBuffer);
+		storeStatus(kStatusTemperature, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -814,13 +1097,20 @@ float SafeCANJag::GetTemperature() {
  * 
  * @return The position of the motor in rotations based on the configured feedback.
  */
-double SafeCANJag::GetPosition() {
+double SafeCANJag::GetPosition(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusPosition, &cached)) {
+		return cached;
+	}
 
 	getTransaction(LM_API_STATUS_POS, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int32_t)) {
-		return unpackFXP16_16(dataBuffer);
+		double value = unpackFXP16_16(dataBuffer);
+		storeStatus(kStatusPosition, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -830,13 +1120,20 @@ double SafeCANJag::GetPosition() {
  * 
  * @return The speed of the motor in RPM based on the configured feedback.
  */
-double SafeCANJag::GetSpeed() {
+double SafeCANJag::GetSpeed(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusSpeed, &cached)) {
+		return cached;
+	}
 
 	getTransaction(LM_API_STATUS_SPD, dataBuffer, &dataSize);
 	if (dataSize == sizeof(int32_t)) {
-		return unpackFXP16_16(dataBuffer);
+		double value = unpackFXP16_16(dataBuffer);
+		storeStatus(kStatusSpeed, value);
+		return value;
 	}
 	return 0.0;
 }
@@ -846,12 +1143,18 @@ double SafeCANJag::GetSpeed() {
  * 
  * @return The motor is allowed to turn in the forward direction when true.
  */
-bool SafeCANJag::GetForwardLimitOK() {
+bool SafeCANJag::GetForwardLimitOK(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusLimits, &cached)) {
+		return ((uint8_t) cached & kForwardLimit) != 0;
+	}
 
 	getTransaction(LM_API_STATUS_LIMIT, dataBuffer, &dataSize);
 	if (dataSize == sizeof(uint8_t)) {
+		storeStatus(kStatusLimits, *dataBuffer);
 		return (*dataBuffer & kForwardLimit) != 0;
 	}
 	return 0;
@@ -862,12 +1165,18 @@ bool SafeCANJag::GetForwardLimitOK() {
  * 
  * @return The motor is allowed to turn in the reverse direction when true.
  */
-bool SafeCANJag::GetReverseLimitOK() {
+bool SafeCANJag::GetReverseLimitOK(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusLimits, &cached)) {
+		return ((uint8_t) cached & kReverseLimit) != 0;
+	}
 
 	getTransaction(LM_API_STATUS_LIMIT, dataBuffer, &dataSize);
 	if (dataSize == sizeof(uint8_t)) {
+		storeStatus(kStatusLimits, *dataBuffer);
 		return (*dataBuffer & kReverseLimit) != 0;
 	}
 	return 0;
@@ -878,17 +1187,60 @@ bool SafeCANJag::GetReverseLimitOK() {
  * 
  * @return A bit-mask of faults defined by the "Faults" enum.
  */
-uint16_t SafeCANJag::GetFaults() {
+uint16_t SafeCANJag::GetFaults(bool fresh) {
 	uint8_t dataBuffer[8];
 	uint8_t dataSize;
+	double cached;
+
+	if (!fresh && GetCachedStatus(kStatusFaults, &cached)) {
+		return (uint16_t) cached;
+	}
 
 	getTransaction(LM_API_STATUS_FAULT, dataBuffer, &dataSize);
 	if (dataSize == sizeof(uint16_t)) {
-		return unpackint16_t(dataBuffer);
+		uint16_t faults = unpackint16_t(dataBuffer);
+		storeStatus(kStatusFaults, faults);
+		return faults;
 	}
 	return 0;
 }
 
+/**
+ * Read a status field from the cache filled by the CANStatusPoller.
+ * 
+ * @param field The status field to read.
+ * @param value Set to the last known value, if there is one.
+ * @param age If not NULL, set to the seconds since the value was read (negative if never).
+ * @return True iff the field is being polled and the value is current.
+ */
+bool SafeCANJag::GetCachedStatus(StatusField field, double *value,
+		double *age) {
+	double time;
+	bool polled;
+	{
+		Synchronized sync(m_statusSemaphore);
+		*value = m_status[field];
+		time = m_statusTime[field];
+		polled = (m_statusPolled & (1 << field)) != 0;
+	}
+	if (time < 0.0) {
+		if (age != NULL)
+			*age = -1.0;
+		return false;
+	}
+	double elapsed = GetTime() - time;
+	if (age != NULL)
+		*age = elapsed;
+	return polled && elapsed <= m_statusMaxAge;
+}
+
+void SafeCANJag::storeStatus(StatusField field, double value) {
+	double time = GetTime();
+	Synchronized sync(m_statusSemaphore);
+	m_status[field] = value;
+	m_statusTime[field] = time;
+}
+
 /**
  * Check if the Jaguar's power has been cycled since this was last called.
  * 
@@ -907,6 +1259,8 @@ bool SafeCANJag::GetPowerCycled() {
 
 		// Clear the power cycled bit now that we've accessed it
 		if (powerCycled) {
+			// a rebooted Jaguar has forgotten its set-point
+			ResetCoalescing();
 			dataBuffer[0] = 1;
 			setTransaction(LM_API_STATUS_POWER, dataBuffer, sizeof(uint8_t));
 		}
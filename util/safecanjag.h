@@ -16,11 +16,15 @@
 #include <vxWorks.h>
 #include "LiveWindow/LiveWindowSendable.h"
 #include "tables/ITable.h"
+#include "canpipeline.h"
 
 /**
  * Luminary Micro Jaguar Speed Control
  * Modifed by 1511 to:
  *  * Print which motor is erroring when sending/getting transactions
+ *  * Talk through the installed CANDriver, so it can be simulated
+ *  * Queue transactions on a CANPipeline instead of blocking
+ *  * Answer status getters from the CANStatusPoller's cache
  * 
  */
 class SafeCANJag: public MotorSafety,
@@ -32,6 +36,8 @@ public:
 	// The internal PID control loop in the Jaguar runs at 1kHz.
 	static const int32_t kControllerRate = 1000;
 	static constexpr double kApproxBusVoltage = 12.0;
+	// Longest an unchanged set-point goes without being re-sent.
+	static constexpr double kDefaultKeepalive = 0.25;
 
 	typedef enum {
 		kPercentVbus, kCurrent, kSpeed, kPosition, kVoltage
@@ -60,16 +66,52 @@ public:
 	typedef enum {
 		kLimitMode_SwitchInputsOnly = 0, kLimitMode_SoftPositionLimits = 1
 	} LimitMode;
+	typedef enum {
+		kStatusBusVoltage,
+		kStatusOutputVoltage,
+		kStatusCurrent,
+		kStatusTemperature,
+		kStatusPosition,
+		kStatusSpeed,
+		kStatusLimits,
+		kStatusFaults,
+		kNumStatusFields
+	} StatusField;
 
+	/**
+	 * With `deferInit`, the constructor sends nothing; the Jaguar
+	 * is brought up later by InitAsync() and FinishInitAsync(), so
+	 * that many can be brought up at once.
+	 */
 	explicit SafeCANJag(uint8_t deviceNumber,
-			ControlMode controlMode = kPercentVbus);
+			ControlMode controlMode = kPercentVbus, bool deferInit = false);
 	virtual ~SafeCANJag();
 
+	/**
+	 * Deferred bring-up, in two rounds: InitAsync() queues the
+	 * firmware version read; once that is flushed, FinishInitAsync()
+	 * checks the version and queues the enable, as the constructor
+	 * would have done.
+	 */
+	CANTransaction* InitAsync(CANPipeline& pipe);
+	void FinishInitAsync(CANTransaction* version, CANPipeline& pipe);
+
 	// SpeedController interface
 	virtual float Get();
 	virtual void Set(float value, uint8_t syncGroup = 0);
 	virtual void Disable();
 
+	CANTransaction* SetAsync(CANPipeline& pipe, float value,
+			uint8_t syncGroup = 0);
+
+	// Write coalescing: Set() with the value the Jaguar last acked
+	// is dropped, unless the keepalive interval has passed.
+	void ResetCoalescing();
+	void SetKeepalive(double seconds);
+	double GetKeepalive();
+	uint32_t GetSetsSent();
+	uint32_t GetSetsSuppressed();
+
 	// PIDOutput interface
 	virtual void PIDWrite(float output);
 
@@ -86,15 +128,25 @@ public:
 	void DisableControl();
 	void ChangeControlMode(ControlMode controlMode);
 	ControlMode GetControlMode();
-	float GetBusVoltage();
-	float GetOutputVoltage();
-	float GetOutputCurrent();
-	float GetTemperature();
-	double GetPosition();
-	double GetSpeed();
-	bool GetForwardLimitOK();
-	bool GetReverseLimitOK();
-	uint16_t GetFaults();
+	// Status getters return the polled value when the CANStatusPoller
+	// is keeping it fresh; `fresh` forces a read from the bus.
+	float GetBusVoltage(bool fresh = false);
+	float GetOutputVoltage(bool fresh = false);
+	float GetOutputCurrent(bool fresh = false);
+	float GetTemperature(bool fresh = false);
+	double GetPosition(bool fresh = false);
+	double GetSpeed(bool fresh = false);
+	bool GetForwardLimitOK(bool fresh = false);
+	bool GetReverseLimitOK(bool fresh = false);
+	uint16_t GetFaults(bool fresh = false);
+	/**
+	 * Reads the last known value of a status field without touching
+	 * the bus; `age` is set to seconds since it was read. Limits and
+	 * faults are the raw bit-masks.
+	 * 
+	 * Returns true iff the field is polled and the value is current.
+	 */
+	bool GetCachedStatus(StatusField field, double *value, double *age = NULL);
 	bool GetPowerCycled();
 	void SetVoltageRampRate(double rampRate);
 	virtual uint32_t GetFirmwareVersion();
@@ -119,18 +171,33 @@ public:
 	void GetDescription(char *desc);
 
 	uint8_t getID();
+
+	/**
+	 * Non-blocking variants of setTransaction and getTransaction:
+	 * the transaction is queued on `pipe`, and is complete once
+	 * pipe.flush() returns. Returns NULL if the Jaguar is in a
+	 * fatal error state or the pipeline is full.
+	 */
+	CANTransaction* setTransactionAsync(CANPipeline& pipe,
+			uint32_t messageID, const uint8_t *data, uint8_t dataSize,
+			CANCallback callback = NULL, void* arg = NULL);
+	CANTransaction* getTransactionAsync(CANPipeline& pipe,
+			uint32_t messageID, CANCallback callback = NULL, void* arg = NULL);
+
+	static uint8_t packPercentage(uint8_t *buffer, double value);
+	static uint8_t packFXP8_8(uint8_t *buffer, double value);
+	static uint8_t packFXP16_16(uint8_t *buffer, double value);
+	static uint8_t packint16_t(uint8_t *buffer, int16_t value);
+	static uint8_t packint32_t(uint8_t *buffer, int32_t value);
+	static double unpackPercentage(uint8_t *buffer);
+	static double unpackFXP8_8(uint8_t *buffer);
+	static double unpackFXP16_16(uint8_t *buffer);
+	static int16_t unpackint16_t(uint8_t *buffer);
+	static int32_t unpackint32_t(uint8_t *buffer);
 protected:
-	uint8_t packPercentage(uint8_t *buffer, double value);
-	uint8_t packFXP8_8(uint8_t *buffer, double value);
-	uint8_t packFXP16_16(uint8_t *buffer, double value);
-	uint8_t packint16_t(uint8_t *buffer, int16_t value);
-	uint8_t packint32_t(uint8_t *buffer, int32_t value);
-	double unpackPercentage(uint8_t *buffer);
-	double unpackFXP8_8(uint8_t *buffer);
-	double unpackFXP16_16(uint8_t *buffer);
-	int16_t unpackint16_t(uint8_t *buffer);
-	int32_t unpackint32_t(uint8_t *buffer);
-	virtual void setTransaction(uint32_t messageID, const uint8_t *data,
+	friend class CANPipeline;
+
+	virtual int32_t setTransaction(uint32_t messageID, const uint8_t *data,
 			uint8_t dataSize);
 	virtual void getTransaction(uint32_t messageID, uint8_t *data,
 			uint8_t *dataSize);
@@ -161,7 +228,35 @@ protected:
 	void commStatusComment(int32_t status);
 
 private:
-	void InitCANJaguar();
+	friend class CANStatusPoller;
+
+	void InitCANJaguar(bool deferInit);
+	bool checkFirmware(uint32_t fwVer);
+	void finishInit();
+	bool packSetpoint(float outputValue, uint8_t syncGroup,
+			uint32_t *messageID, uint8_t *dataBuffer, uint8_t *dataSize);
+	void storeStatus(StatusField field, double value);
+	bool coalesceSet(float outputValue, uint8_t syncGroup);
+	void ackSet(float outputValue, uint8_t syncGroup);
+	static void setAcked(CANTransaction* t, void* jag);
+
+	SEM_ID m_statusSemaphore;
+	double m_status[kNumStatusFields];
+	double m_statusTime[kNumStatusFields];
+	// set by the CANStatusPoller
+	uint16_t m_statusPolled;
+	double m_statusMaxAge;
+
+	// last acknowledged set-point; m_lastSetTime < 0 if unknown
+	float m_lastSet;
+	uint8_t m_lastSetSync;
+	double m_lastSetTime;
+	// set-point of the write queued by SetAsync
+	float m_pendingSet;
+	uint8_t m_pendingSync;
+	double m_keepalive;
+	uint32_t m_setsSent;
+	uint32_t m_setsSuppressed;
 };
 #endif
 
@@ -0,0 +1,204 @@
+#include "scheduler.h"
+#include "telemetry.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * GetTime() and Wait(), for the robot.
+ */
+class WPILibLoopClock: public LoopClock {
+public:
+	virtual double now() {
+		return GetTime();
+	}
+	virtual void sleepUntil(double time) {
+		double left = time - GetTime();
+		if (left > 0) {
+			Wait(left);
+		}
+	}
+};
+
+LoopClock::~LoopClock() {
+}
+
+SimLoopClock::SimLoopClock(double start) :
+	clock(start) {
+}
+
+double SimLoopClock::now() {
+	return clock;
+}
+
+void SimLoopClock::sleepUntil(double time) {
+	if (time > clock) {
+		clock = time;
+	}
+}
+
+void SimLoopClock::advance(double seconds) {
+	clock += seconds;
+}
+
+const int LoopScheduler::kMaxRates;
+const int LoopScheduler::kOverrunBins;
+
+LoopScheduler::LoopScheduler(double p, LoopClock* c, const char* n) {
+	own_clock = (c == 0);
+	clock = own_clock ? new WPILibLoopClock() : c;
+	period = p;
+	name = n;
+	num_rates = 0;
+	channel = -1;
+	start();
+}
+
+LoopScheduler::~LoopScheduler() {
+	if (own_clock) {
+		delete clock;
+	}
+}
+
+int LoopScheduler::addRate(const char* name, double p) {
+	if (num_rates >= kMaxRates) {
+		printf("LoopScheduler: too many rates; dropped %s\n", name);
+		return -1;
+	}
+	Rate& r = rates[num_rates];
+	r.name = name;
+	r.divisor = (int) floor(p / period + 0.5);
+	if (r.divisor < 1) {
+		r.divisor = 1;
+	}
+	r.next = tick_time;
+	r.due = true;
+	num_rates++;
+	return num_rates - 1;
+}
+
+void LoopScheduler::start() {
+	tick_time = clock->now();
+	tick_start = tick_time;
+	deadline = tick_time + period;
+
+	ticks = 0;
+	overruns = 0;
+	skipped = 0;
+	for (int i = 0; i < kOverrunBins; i++) {
+		histogram[i] = 0;
+	}
+	max_work = 0.0;
+
+	for (int i = 0; i < num_rates; i++) {
+		rates[i].next = tick_time;
+	}
+	updateRates();
+}
+
+void LoopScheduler::waitForNextTick() {
+	double now = clock->now();
+	double work = now - tick_start;
+	if (work > max_work) {
+		max_work = work;
+	}
+
+	double late = now - deadline;
+	if (late > 0) {
+		overruns++;
+		double periods = late / period;
+		int bin;
+		if (periods < 0.25) {
+			bin = 0;
+		} else if (periods < 0.5) {
+			bin = 1;
+		} else if (periods < 1) {
+			bin = 2;
+		} else if (periods < 2) {
+			bin = 3;
+		} else if (periods < 4) {
+			bin = 4;
+		} else {
+			bin = 5;
+		}
+		histogram[bin]++;
+
+		// run the late tick now, but drop whole periods we missed
+		double behind = floor(periods);
+		deadline += behind * period;
+		skipped += (uint32_t) behind;
+	} else {
+		clock->sleepUntil(deadline);
+	}
+
+	if (channel < 0) {
+		channel = Telemetry::channel(name, "work,late");
+	}
+	Telemetry::send(channel, work, (late > 0) ? late : 0.0);
+
+	tick_time = deadline;
+	deadline += period;
+	ticks++;
+	tick_start = clock->now();
+	updateRates();
+}
+
+void LoopScheduler::updateRates() {
+	// half a tick of slack, so rounding never makes a rate skip
+	double slack = 0.5 * period;
+	for (int i = 0; i < num_rates; i++) {
+		Rate& r = rates[i];
+		r.due = (tick_time + slack >= r.next);
+		if (r.due) {
+			double rp = r.divisor * period;
+			while (r.next <= tick_time + slack) {
+				r.next += rp;
+			}
+		}
+	}
+}
+
+bool LoopScheduler::isDue(int id) {
+	if (id < 0 || id >= num_rates) {
+		return false;
+	}
+	return rates[id].due;
+}
+
+double LoopScheduler::getPeriod() {
+	return period;
+}
+
+double LoopScheduler::getTickTime() {
+	return tick_time;
+}
+
+uint32_t LoopScheduler::getTicks() {
+	return ticks;
+}
+
+uint32_t LoopScheduler::getOverruns() {
+	return overruns;
+}
+
+uint32_t LoopScheduler::getSkipped() {
+	return skipped;
+}
+
+const uint32_t* LoopScheduler::getOverrunHistogram() {
+	return histogram;
+}
+
+double LoopScheduler::getMaxWork() {
+	return max_work;
+}
+
+void LoopScheduler::printStats(const char* name) {
+	printf("%s: %u ticks, %u overruns, %u skipped, max work %f s\n", name,
+			ticks, overruns, skipped, max_work);
+	if (overruns > 0) {
+		printf("  late by <1/4: %u <1/2: %u <1: %u <2: %u <4: %u more: %u"
+			" periods\n", histogram[0], histogram[1], histogram[2],
+				histogram[3], histogram[4], histogram[5]);
+	}
+}
@@ -0,0 +1,153 @@
+#ifndef UTIL_SCHEDULER_H_
+#define UTIL_SCHEDULER_H_
+
+#include <stdint.h>
+
+/**
+ * The time source of a LoopScheduler. The default clock reads
+ * GetTime() and sleeps with Wait(); a SimLoopClock can be passed
+ * in its place so scheduling runs (and can be checked) off-robot.
+ */
+class LoopClock {
+public:
+	virtual ~LoopClock();
+	/**
+	 * Seconds, monotonic.
+	 */
+	virtual double now() = 0;
+	/**
+	 * Block until now() >= time; returns at once if it already is.
+	 */
+	virtual void sleepUntil(double time) = 0;
+};
+
+/**
+ * Virtual clock: sleepUntil() jumps straight to the deadline,
+ * and work is simulated by advance().
+ */
+class SimLoopClock: public LoopClock {
+public:
+	SimLoopClock(double start = 0.0);
+	virtual double now();
+	virtual void sleepUntil(double time);
+	void advance(double seconds);
+private:
+	double clock;
+};
+
+/**
+ * Periodic loop on absolute deadlines.
+ * 
+ * Tick k is due at start + k * period, so the time spent working
+ * never shifts later ticks (no drift). A tick whose deadline has
+ * already passed counts as an overrun and runs at once; whole
+ * periods that were missed are skipped to get back on the grid.
+ * 
+ * Subsystems that should run slower than the base tick register a
+ * rate, and check isDue() each tick:
+ * 
+ * > LoopScheduler loop(0.010);
+ * > int lights_rate = loop.addRate("lights", 0.100);
+ * > loop.start();
+ * > while (enabled) {
+ * > 	drive.process();
+ * > 	if (loop.isDue(lights_rate))
+ * > 		lights.process();
+ * > 	loop.waitForNextTick();
+ * > }
+ * 
+ * This class is NOT threadsafe.
+ */
+class LoopScheduler {
+public:
+	static const int kMaxRates = 8;
+	/**
+	 * Overrun histogram bins, by lateness in periods:
+	 * < 1/4, < 1/2, < 1, < 2, < 4, and 4 or more.
+	 */
+	static const int kOverrunBins = 6;
+
+	/**
+	 * `clock` defaults to the robot clock, and must
+	 * outlive the scheduler. Per-tick timing goes to the
+	 * Telemetry channel `name`.
+	 */
+	LoopScheduler(double period, LoopClock* clock = 0, const char* name =
+			"Loop");
+	~LoopScheduler();
+
+	/**
+	 * Register a rate; `period` is rounded to a whole number
+	 * of base ticks. Returns the rate's ID, or -1 if there are
+	 * too many.
+	 */
+	int addRate(const char* name, double period);
+
+	/**
+	 * (Re)start the deadlines from now, and reset the statistics.
+	 * Every rate is due on the first tick.
+	 */
+	void start();
+
+	/**
+	 * End the current tick: sleep until the next deadline, or
+	 * record an overrun if it has passed.
+	 */
+	void waitForNextTick();
+
+	/**
+	 * True if rate `id` should run during the current tick.
+	 */
+	bool isDue(int id);
+
+	double getPeriod();
+	/**
+	 * The deadline that started the current tick.
+	 */
+	double getTickTime();
+	uint32_t getTicks();
+	uint32_t getOverruns();
+	/**
+	 * Ticks dropped to catch up after overruns.
+	 */
+	uint32_t getSkipped();
+	const uint32_t* getOverrunHistogram();
+	/**
+	 * Longest time from the start of a tick to waitForNextTick().
+	 */
+	double getMaxWork();
+
+	/**
+	 * Printf the statistics since start().
+	 */
+	void printStats(const char* name);
+private:
+	typedef struct {
+		const char* name;
+		int divisor;
+		double next;
+		bool due;
+	} Rate;
+
+	void updateRates();
+
+	LoopClock* clock;
+	bool own_clock;
+	double period;
+	double deadline;
+	double tick_time;
+	double tick_start;
+
+	Rate rates[kMaxRates];
+	int num_rates;
+
+	uint32_t ticks;
+	uint32_t overruns;
+	uint32_t skipped;
+	uint32_t histogram[kOverrunBins];
+	double max_work;
+	const char* name;
+	int channel;
+};
+
+#endif
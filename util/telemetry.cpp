@@ -0,0 +1,144 @@
+#include "telemetry.h"
+#include "udplog.h"
+#include "Synchronized.h"
+#include "Utility.h"
+#include <stdio.h>
+#include <string.h>
+
+// seconds between re-sending each channel's definition
+const uint32_t ANNOUNCE_PERIOD_US = 1000000;
+
+typedef struct {
+	char name[32];
+	char fields[128];
+	int count;
+	volatile uint32_t announced;
+	volatile bool ever_announced;
+} Channel;
+
+static Channel channels[Telemetry::kMaxChannels];
+static volatile int num_channels = 0;
+static SEM_ID registry = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+
+static int put16(uint8_t* buf, uint16_t v) {
+	buf[0] = (v >> 8) & 0xFF;
+	buf[1] = v & 0xFF;
+	return 2;
+}
+
+static int put32(uint8_t* buf, uint32_t v) {
+	buf[0] = (v >> 24) & 0xFF;
+	buf[1] = (v >> 16) & 0xFF;
+	buf[2] = (v >> 8) & 0xFF;
+	buf[3] = v & 0xFF;
+	return 4;
+}
+
+static void announce(int id, uint32_t now) {
+	Channel& c = channels[id];
+	uint8_t buf[256];
+	int len = 0;
+	buf[len++] = Telemetry::kMarker;
+	buf[len++] = Telemetry::kDefinition;
+	len += put16(buf + len, id);
+	buf[len++] = c.count;
+	size_t n = strlen(c.name) + 1;
+	memcpy(buf + len, c.name, n);
+	len += n;
+	n = strlen(c.fields) + 1;
+	memcpy(buf + len, c.fields, n);
+	len += n;
+	UDPLog::writeRecord(buf, len);
+
+	c.announced = now;
+	c.ever_announced = true;
+}
+
+int Telemetry::channel(const char* name, const char* fields) {
+	Synchronized sync(registry);
+	for (int i = 0; i < num_channels; i++) {
+		if (strcmp(channels[i].name, name) == 0) {
+			return i;
+		}
+	}
+	if (num_channels >= kMaxChannels) {
+		printf("Telemetry: too many channels; dropped %s\n", name);
+		return -1;
+	}
+
+	Channel& c = channels[num_channels];
+	strncpy(c.name, name, sizeof(c.name) - 1);
+	c.name[sizeof(c.name) - 1] = '\0';
+	strncpy(c.fields, fields, sizeof(c.fields) - 1);
+	c.fields[sizeof(c.fields) - 1] = '\0';
+	c.count = 1;
+	for (const char* f = c.fields; *f != '\0'; f++) {
+		if (*f == ',') {
+			c.count++;
+		}
+	}
+	if (c.count > kMaxFields) {
+		printf("Telemetry: %s has more than %d fields\n", name, kMaxFields);
+		c.count = kMaxFields;
+	}
+	c.ever_announced = false;
+	c.announced = 0;
+	// publish the channel only once it is filled in
+	num_channels++;
+	return num_channels - 1;
+}
+
+void Telemetry::send(int id, const float* values) {
+	if (id < 0 || id >= num_channels) {
+		return;
+	}
+	Channel& c = channels[id];
+	uint32_t now = GetFPGATime();
+	if (!c.ever_announced || now - c.announced >= ANNOUNCE_PERIOD_US) {
+		announce(id, now);
+	}
+
+	uint8_t buf[9 + 4 * kMaxFields];
+	int len = 0;
+	buf[len++] = kMarker;
+	buf[len++] = kSample;
+	len += put16(buf + len, id);
+	len += put32(buf + len, now);
+	buf[len++] = c.count;
+	for (int i = 0; i < c.count; i++) {
+		uint32_t bits;
+		memcpy(&bits, &values[i], sizeof(bits));
+		len += put32(buf + len, bits);
+	}
+	UDPLog::writeRecord(buf, len);
+}
+
+void Telemetry::send(int id, double a) {
+	float v[kMaxFields] = { 0.0f };
+	v[0] = a;
+	send(id, v);
+}
+
+void Telemetry::send(int id, double a, double b) {
+	float v[kMaxFields] = { 0.0f };
+	v[0] = a;
+	v[1] = b;
+	send(id, v);
+}
+
+void Telemetry::send(int id, double a, double b, double c) {
+	float v[kMaxFields] = { 0.0f };
+	v[0] = a;
+	v[1] = b;
+	v[2] = c;
+	send(id, v);
+}
+
+void Telemetry::send(int id, double a, double b, double c, double d) {
+	float v[kMaxFields] = { 0.0f };
+	v[0] = a;
+	v[1] = b;
+	v[2] = c;
+	v[3] = d;
+	send(id, v);
+}
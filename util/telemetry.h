@@ -0,0 +1,55 @@
+#ifndef UTIL_TELEMETRY_H_
+#define UTIL_TELEMETRY_H_
+
+#include <stdint.h>
+
+/**
+ * Binary telemetry over the UDPLog stream.
+ * 
+ * A channel is registered once with a name and a list of field
+ * names; each sample is then a fixed-size record of float fields
+ * tagged with the channel ID and the FPGA clock (microseconds),
+ * so nothing is formatted on the robot.
+ * 
+ * Example use:
+ * 
+ * static int lpt = Telemetry::channel("LPT", "loc,power,target");
+ * Telemetry::send(lpt, loc, pw, tg);
+ * 
+ * Channel definitions are re-sent once a second so a decoder that
+ * starts late can still name the columns. Text from UDPLog::log
+ * shares the stream: every binary record starts with kMarker, a
+ * byte which never appears in text. tools/telemetry2csv turns a
+ * capture into one CSV per channel.
+ * 
+ * Record layout (big-endian):
+ *   definition: kMarker kDefinition id:u16 count:u8 name\0 fields\0
+ *   sample:     kMarker kSample     id:u16 time_us:u32 count:u8 count*f32
+ */
+namespace Telemetry {
+const uint8_t kMarker = 0xFF;
+const uint8_t kDefinition = 0xD0;
+const uint8_t kSample = 0x5A;
+const int kMaxChannels = 32;
+const int kMaxFields = 12;
+
+/**
+ * Register a channel, or find the one already registered under
+ * `name`. `fields` is a comma-separated list of column names.
+ * 
+ * Returns the channel ID, or -1 if there are too many channels.
+ */
+int channel(const char* name, const char* fields);
+
+/**
+ * Send one sample; `values` must hold one entry per field.
+ * Ignores invalid channels.
+ */
+void send(int channel, const float* values);
+void send(int channel, double a);
+void send(int channel, double a, double b);
+void send(int channel, double a, double b, double c);
+void send(int channel, double a, double b, double c, double d);
+}
+
+#endif
@@ -1,12 +1,14 @@
 #include "threadless_pid.h"
 #include "Timer.h"
-#include "udplog.h"
+#include "telemetry.h"
 
 ThreadlessPID::ThreadlessPID(double p, double i, double d, double f) {
 	setConstants(p, i, d, f);
 	integral = 0.0;
 	lerror = 0.0;
 	ltime = Timer::GetPPCTimestamp();
+	log_name = 0;
+	log_channel = -1;
 }
 
 void ThreadlessPID::setConstants(double p, double i, double d, double f) {
@@ -40,8 +42,20 @@ double ThreadlessPID::calc(double target, double measure, const char* name) {
 	double output = p_comp + k_comp + i_comp + f_comp;
 
 	if (name != 0) {
-		UDPLog::log("%s:0.0,1.0,%f,%f,%f,%f,%f,%f,%f\n", name, target, measure,
-				output, p_comp, k_comp, i_comp, f_comp);
+		if (name != log_name) {
+			log_name = name;
+			log_channel = Telemetry::channel(name,
+					"target,measure,output,p,d,i,f");
+		}
+		float values[7];
+		values[0] = target;
+		values[1] = measure;
+		values[2] = output;
+		values[3] = p_comp;
+		values[4] = k_comp;
+		values[5] = i_comp;
+		values[6] = f_comp;
+		Telemetry::send(log_channel, values);
 	}
 
 	return output;
@@ -12,7 +12,8 @@ public:
 	void setConstants(double p, double i=0, double d=0, double f=0);
 
 	/**
-	 * if logname is nonzero, logs PID data to UDP 1140 as well.
+	 * if logname is nonzero, logs PID data to the
+	 * Telemetry channel of that name as well.
 	 * 
 	 * Returns output.
 	 */
@@ -28,6 +29,10 @@ private:
 	double integral;
 	double lerror;
 	double ltime;
+
+	// telemetry channel of the last logname used
+	const char* log_name;
+	int log_channel;
 };
 
 #endif /* THREADLESSPID_H_ */
@@ -6,21 +6,128 @@
 #include <netinet/in.h>
 #include <inetLib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
-#include "Synchronized.h"
+#include "Task.h"
+#include "Timer.h"
 
 const int PORT = 1140;// competition legal (see FMS Whitepaper)
 const char* DS_IP = "10.15.11.5";
 const char* CODER_IP = "10.15.11.53";
 const char* TARGET_IP = CODER_IP;
 
+// below the robot's main task (101) and every control notifier
+const int SENDER_PRIORITY = 150;
+const double SEND_PERIOD = 0.010;
+
+// largest UDP payload that fits one Ethernet frame (1500 - IP - UDP headers)
+const int DATAGRAM_LEN = 1472;
+// longest message; anything past this is cut off
+const int SLOT_LEN = 256;
+// must be a power of two
+const unsigned int NUM_SLOTS = 512;
+
+/**
+ * A message in the ring. `seq` says who owns it:
+ *   == position         free, for the producer that claims `position`
+ *   == position + 1     written, waiting for the sender
+ * After sending, it is handed to the position NUM_SLOTS later.
+ */
+typedef struct {
+	volatile unsigned int seq;
+	unsigned int len;
+	char text[SLOT_LEN];
+} Slot;
+
 bool ready = false;
 int sock_fd = 0;
 struct sockaddr_in saddr;
-SEM_ID semaphore = 0;
 
-const int BUFLEN = 1024;
-char buf[BUFLEN];
+static Slot slots[NUM_SLOTS];
+// next position to claim; shared by all producers
+static volatile unsigned int head = 0;
+// next position to send; sender only
+static unsigned int tail = 0;
+static volatile unsigned int drops = 0;
+
+static Task* sender = NULL;
+static volatile bool running = false;
+
+static char datagram[DATAGRAM_LEN];
+
+/**
+ * Claim the next free slot, or return NULL if the ring is full.
+ * Lock-free: producers race on `head` with compare-and-swap.
+ */
+static Slot* claim(unsigned int* position) {
+	unsigned int pos = head;
+	while (true) {
+		Slot* s = &slots[pos & (NUM_SLOTS - 1)];
+		int diff = (int) (s->seq - pos);
+		if (diff == 0) {
+			unsigned int seen = __sync_val_compare_and_swap(&head, pos, pos
+					+ 1);
+			if (seen == pos) {
+				*position = pos;
+				return s;
+			}
+			pos = seen;
+		} else if (diff < 0) {
+			// the sender has not freed it yet
+			__sync_fetch_and_add(&drops, 1);
+			return NULL;
+		} else {
+			pos = head;
+		}
+	}
+}
+
+static void publish(Slot* s, unsigned int position) {
+	// the text must be visible before the sender sees the slot
+	__sync_synchronize();
+	s->seq = position + 1;
+}
+
+static void sendDatagram(unsigned int len) {
+	if (len == 0) {
+		return;
+	}
+	// we don't care if it worked or not (target present)
+	sendto(sock_fd, datagram, len, 0, (sockaddr *) &saddr, sizeof(saddr));
+}
+
+/**
+ * Send everything in the ring, packing consecutive messages
+ * into as few datagrams as possible. Only one thread may drain.
+ */
+static void drain() {
+	unsigned int len = 0;
+	while (true) {
+		Slot* s = &slots[tail & (NUM_SLOTS - 1)];
+		if (s->seq != tail + 1) {
+			break;
+		}
+		__sync_synchronize();
+		if (len + s->len > (unsigned int) DATAGRAM_LEN) {
+			sendDatagram(len);
+			len = 0;
+		}
+		memcpy(datagram + len, s->text, s->len);
+		len += s->len;
+		__sync_synchronize();
+		s->seq = tail + NUM_SLOTS;
+		tail++;
+	}
+	sendDatagram(len);
+}
+
+static int run() {
+	while (running) {
+		drain();
+		Wait(SEND_PERIOD);
+	}
+	return 0;
+}
 
 void UDPLog::log(const char *fmt, ...) {
 #if LOGGING_ENABLED
@@ -29,22 +136,66 @@ void UDPLog::log(const char *fmt, ...) {
 		return;
 	}
 
-	{
-		Synchronized sync(semaphore);
+	unsigned int position;
+	Slot* s = claim(&position);
+	if (s == NULL) {
+		return;
+	}
+
+	va_list args;
+	va_start(args, fmt);
+	int n = vsnprintf(s->text, SLOT_LEN, fmt, args);
+	va_end(args);
+	if (n < 0) {
+		n = 0;
+	} else if (n >= SLOT_LEN) {
+		n = SLOT_LEN - 1;
+	}
+	s->len = n;
+
+	publish(s, position);
+#endif
+}
+
+void UDPLog::write(const char *text) {
+	writeRecord(text, strlen(text));
+}
+
+void UDPLog::writeRecord(const void *data, unsigned int len) {
+#if LOGGING_ENABLED
+	if (!ready) {
+		printf("UDP Logger not initialized\n");
+		return;
+	}
 
-		va_list args;
-		va_start(args, fmt);
-		vsnprintf(buf, BUFLEN, fmt, args);
-		va_end(args);
+	unsigned int position;
+	Slot* s = claim(&position);
+	if (s == NULL) {
+		return;
+	}
 
-		// we don't care if it worked or not (target present)
-		sendto(sock_fd, buf, strlen(buf), 0, (sockaddr *) &saddr, sizeof(saddr));
+	if (len >= (unsigned int) SLOT_LEN) {
+		len = SLOT_LEN - 1;
 	}
+	memcpy(s->text, data, len);
+	s->len = len;
+
+	publish(s, position);
 #endif
 }
 
+unsigned int UDPLog::dropped() {
+	return drops;
+}
+
 void UDPLog::setup() {
-	semaphore = semMCreate(SEM_Q_PRIORITY);
+	for (unsigned int i = 0; i < NUM_SLOTS; i++) {
+		slots[i].seq = i;
+		slots[i].len = 0;
+	}
+	head = 0;
+	tail = 0;
+	drops = 0;
 
 	memset(&saddr, 0, sizeof(saddr));
 	saddr.sin_family = AF_INET;
@@ -57,18 +208,25 @@ void UDPLog::setup() {
 	sock_fd = socket(AF_INET, SOCK_DGRAM, 0);
 	if (sock_fd == ERROR) {
 		printf("UDPLogger: Bad socket\n");
-		// cleanup
-		semFlush(semaphore);
 		return;
 	}
 
 	ready = true;
+	running = true;
+	sender = new Task("UDPLogSender", (FUNCPTR) run, SENDER_PRIORITY);
+	sender->Start();
 }
 
 void UDPLog::destroy() {
-	semFlush(semaphore);
+	ready = false;
+	if (sender != NULL) {
+		// let the sender finish its current pass
+		running = false;
+		Wait(2 * SEND_PERIOD);
+		delete sender;
+		sender = NULL;
+	}
+	drain();
 
 	shutdown(sock_fd, SHUT_RDWR);
-
-	ready = false;
 }
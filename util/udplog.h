@@ -14,12 +14,30 @@
  * 
  * This logger sends information over port 1140 to the driver station laptop. 
  * 
+ * log() only formats the message into a free slot of a lock-free
+ * ring; it never takes a lock or touches the network, so it is safe
+ * to call from control loops and notifiers. A low priority sender
+ * task drains the ring, packing records into datagrams of up to
+ * one MTU. If the ring is full, messages are dropped (and counted).
  */
 
 namespace UDPLog {
 void setup();
 void destroy();
 void log(const char* fmt, ...);
+/**
+ * Log a preformatted message, as is.
+ */
+void write(const char* text);
+/**
+ * Log raw bytes (up to 255), e.g. a Telemetry record.
+ * Never split across datagrams.
+ */
+void writeRecord(const void* data, unsigned int len);
+/**
+ * Number of messages dropped because the ring was full.
+ */
+unsigned int dropped();
 }
 
 #endif